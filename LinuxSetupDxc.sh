@@ -0,0 +1,79 @@
+#!/usr/bin/env bash
+
+# Downloads the DXC library used to compile the shaders in-process to external/DirectXShaderCompiler/Linux
+# then compiles test shaders for the linux target to check that the library is found and works, including
+# a system shader that includes CoreEngine.hlsl from its Lib directory.
+#
+# Usage: ./LinuxSetupDxc.sh           download the library and run the check
+#        ./LinuxSetupDxc.sh --check   only run the check
+
+set -e
+
+dxcVersion="v1.7.2308"
+dxcArchive="linux_dxc_2023_08_14.x86_64.tar.gz"
+
+rootDirectory=$(
+  cd $(dirname "$0")
+  pwd
+)
+
+libraryDirectory="$rootDirectory/external/DirectXShaderCompiler/Linux"
+
+downloadLibrary() {
+    echo [93mDownloading DXC $dxcVersion...[0m
+
+    local tempDirectory=$(mktemp -d)
+
+    curl -fsSL -o "$tempDirectory/$dxcArchive" "https://github.com/microsoft/DirectXShaderCompiler/releases/download/$dxcVersion/$dxcArchive"
+    tar -xzf "$tempDirectory/$dxcArchive" -C "$tempDirectory"
+
+    mkdir -p "$libraryDirectory"
+    cp "$tempDirectory/lib/libdxcompiler.so" "$libraryDirectory/"
+
+    # dxcompiler loads dxil to sign the DXIL shaders
+    if [ -f "$tempDirectory/lib/libdxil.so" ]; then
+        cp "$tempDirectory/lib/libdxil.so" "$libraryDirectory/"
+    fi
+
+    rm -rf "$tempDirectory"
+}
+
+checkLibrary() {
+    echo [93mChecking the in-process shader compilation...[0m
+
+    checkDirectory=$(mktemp -d)
+    trap 'rm -rf "$checkDirectory"' EXIT
+
+    # The build copies the library next to the compiler in the dxc directory where DxcLibrary looks for it
+    dotnet build --nologo -c Debug -v q -o "$checkDirectory/Compiler" "$rootDirectory/src/CoreEngineCompiler"
+
+    # RenderMeshInstance includes CoreEngine.hlsl which is resolved from the Lib directory next to the shader
+    mkdir -p "$checkDirectory/Project"
+    cp "$rootDirectory/TestData/RenderTriangle.hlsl" "$checkDirectory/Project/"
+    cp "$rootDirectory/TestData/System/Shaders/RenderMeshInstance.hlsl" "$checkDirectory/Project/"
+    cp -r "$rootDirectory/TestData/System/Shaders/Lib" "$checkDirectory/Project/"
+    echo 'OutputDirectory: "Output"' > "$checkDirectory/Project/DxcCheck.ceproj"
+
+    COREENGINE_DXC_PATH= dotnet "$checkDirectory/Compiler/CoreEngineCompiler.dll" "$checkDirectory/Project/DxcCheck.ceproj" --rebuild --verbose
+
+    checkShader RenderTriangle
+    checkShader RenderMeshInstance
+}
+
+checkShader() {
+    # The shader resource has a 14 bytes header followed by the compiled data
+    local shaderSize=$(stat -c %s "$checkDirectory/Project/Output/$1.shader" 2>/dev/null || echo 0)
+
+    if [ "$shaderSize" -le 14 ]; then
+        echo [91mError: $1.hlsl was not compiled.[0m
+        return 1
+    fi
+
+    echo [92mSuccess: $1.hlsl compiled in-process \($shaderSize bytes\).[0m
+}
+
+if [ "$1" != "--check" ]; then
+    downloadLibrary
+fi
+
+checkLibrary
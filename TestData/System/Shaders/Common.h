@@ -10,6 +10,14 @@ struct VertexInput
     packed_float2 TextureCoordinates;
 };
 
+// Compact vertex format of the MESH resources, see DecodeCompactVertex
+struct CompactVertexInput
+{
+    ushort4 Position;
+    short2 Normal;
+    half2 TextureCoordinates;
+};
+
 struct BoundingBox
 {
     packed_float3 MinPoint;
@@ -117,6 +125,36 @@ float3 lerp(float3 a, float3 b, float w)
   return a + w*(b-a);
 }
 
+float3 DecodeOctahedralNormal(float2 encodedNormal)
+{
+    float3 normal = float3(encodedNormal.xy, 1.0 - abs(encodedNormal.x) - abs(encodedNormal.y));
+    float t = saturate(-normal.z);
+    normal.xy += select(float2(t), float2(-t), normal.xy >= 0.0);
+    return normalize(normal);
+}
+
+// Positions are quantized relative to the bounding box of the sub object that contains the vertex
+VertexInput DecodeCompactVertex(CompactVertexInput input, BoundingBox boundingBox)
+{
+    float3 minPoint = boundingBox.MinPoint;
+    float3 maxPoint = boundingBox.MaxPoint;
+
+    VertexInput result;
+    result.Position = minPoint + float3(input.Position.xyz) / 65535.0 * (maxPoint - minPoint);
+    result.Normal = DecodeOctahedralNormal(max(float2(input.Normal) / 32767.0, float2(-1.0)));
+    result.TextureCoordinates = float2(input.TextureCoordinates);
+
+    return result;
+}
+
+// Projects the object space error stored with each level of detail of a MESH sub object to pixels,
+// projectionScale is viewportHeight / (2 * tan(fieldOfView / 2)). The least detailed level with a
+// projected error below the pixel threshold can be drawn without visible difference.
+float ComputeLodScreenSpaceError(float lodError, float worldScale, float distance, float projectionScale)
+{
+    return lodError * worldScale * projectionScale / max(distance, 0.0001);
+}
+
 texture2d<float> GetTexture(const device ShaderParameters& shaderParameters, int materialTextureOffset, int materialTextureIndex)
 {
     return shaderParameters.Textures[materialTextureOffset + (materialTextureIndex - 1)];
@@ -39,6 +39,7 @@ struct RectangleSurface
     // float2 TextureMaxPoint;
     // int TextureIndex;
     // bool IsOpaque;
+    // float DistanceRange;
 
     // TODO: Find a common solution for alignment issues
     // int Reserved4;
@@ -64,6 +65,16 @@ float4x4 CreateOrthographicMatrixOffCenter(float minPlaneX, float maxPlaneX, flo
     return result;
 }
 
+// The field is 0.5 on the outline and changes by 1 / (2 * distanceRange) per texel, the edge is smoothed
+// over one screen pixel whatever the scale of the text
+float ComputeDistanceFieldAlpha(float distanceSample, float2 textureCoordinates, float2 textureSize, float distanceRange)
+{
+    float2 texelsPerPixel = fwidth(textureCoordinates * textureSize);
+    float width = 0.5 * length(texelsPerPixel) * 0.70710678 / (2.0 * distanceRange);
+
+    return smoothstep(0.5 - width, 0.5 + width, distanceSample);
+}
+
 float4x4 CreateScale(float scale)
 {
     float4x4 result = (float4x4)0;
@@ -179,6 +190,13 @@ PixelOutput PixelMain(const VertexOutput input)
     // Texture2D diffuseTexture = ResourceDescriptorHeap[NonUniformResourceIndex(textureIndex)];
     // float4 textureColor = diffuseTexture.Sample(TextureSampler, input.TextureCoordinates);
 
+    // if (rectangleSurfaces[input.InstanceId].DistanceRange > 0.0)
+    // {
+    //     float2 textureSize;
+    //     diffuseTexture.GetDimensions(textureSize.x, textureSize.y);
+    //     textureColor = float4(1, 1, 1, ComputeDistanceFieldAlpha(textureColor.r, input.TextureCoordinates, textureSize, rectangleSurfaces[input.InstanceId].DistanceRange));
+    // }
+
     // if (!input.IsOpaque)
     // {
     //     if (textureColor.a == 0)
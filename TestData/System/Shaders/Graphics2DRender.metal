@@ -15,6 +15,7 @@ struct VertexOutput
     float2 TextureCoordinates;
     uint InstanceId [[flat]];
     bool IsOpaque [[flat]];
+    float DistanceRange [[flat]];
 };
 
 struct RenderPassParameters
@@ -29,6 +30,10 @@ struct RectangleSurface
     float2 TextureMaxPoint;
     int TextureIndex;
     bool IsOpaque;
+
+    // Distance range in texels of a single channel SDF texture like the font atlas, 0 for a color texture.
+    // It uses the padding after IsOpaque so the size of the struct doesn't change.
+    float DistanceRange;
 };
 
 struct ShaderParameters
@@ -76,6 +81,7 @@ vertex VertexOutput VertexMain(const uint vertexId [[vertex_id]],
     }
 
     output.IsOpaque = parameters.RectangleSurfaces[instanceId].IsOpaque;
+    output.DistanceRange = parameters.RectangleSurfaces[instanceId].DistanceRange;
     
     return output;
 }
@@ -85,6 +91,16 @@ struct PixelOutput
     float4 Color [[color(0)]];
 };
 
+// The field is 0.5 on the outline and changes by 1 / (2 * distanceRange) per texel, the edge is smoothed
+// over one screen pixel whatever the scale of the text
+float ComputeDistanceFieldAlpha(float distanceSample, float2 textureCoordinates, float2 textureSize, float distanceRange)
+{
+    float2 texelsPerPixel = fwidth(textureCoordinates * textureSize);
+    float width = 0.5 * length(texelsPerPixel) * M_SQRT1_2_F / (2.0 * distanceRange);
+
+    return smoothstep(0.5 - width, 0.5 + width, distanceSample);
+}
+
 float ConvertDepthSampleToLinear(float depthSample, float nearPlane, float farPlane)
 {
     float depthRange = farPlane - nearPlane;
@@ -106,6 +122,13 @@ fragment PixelOutput PixelMain(const VertexOutput input [[stage_in]],
 
     float4 textureColor = diffuseTexture.sample(texture_sampler, input.TextureCoordinates);
 
+    // R8 textures sample with an alpha of 1, the coverage of the glyphs comes from the distance field
+    if (input.DistanceRange > 0.0)
+    {
+        float2 textureSize = float2(diffuseTexture.get_width(), diffuseTexture.get_height());
+        textureColor = float4(1, 1, 1, ComputeDistanceFieldAlpha(textureColor.r, input.TextureCoordinates, textureSize, input.DistanceRange));
+    }
+
     if (!input.IsOpaque)
     {
         if (textureColor.a == 0)
@@ -6,6 +6,44 @@ struct Vertex
     float2 TextureCoordinates;
 };
 
+// Compact vertex format of the MESH resources: 16-bit unorm position relative to the sub object
+// bounding box, 16-bit snorm octahedral normal and half precision texture coordinates
+struct CompactVertex
+{
+    uint2 Position;
+    uint Normal;
+    uint TextureCoordinates;
+};
+
+float3 DecodeOctahedralNormal(float2 encodedNormal)
+{
+    float3 normal = float3(encodedNormal.xy, 1.0 - abs(encodedNormal.x) - abs(encodedNormal.y));
+    float t = saturate(-normal.z);
+    normal.xy += select(normal.xy >= 0.0, -t, t);
+    return normalize(normal);
+}
+
+Vertex DecodeCompactVertex(CompactVertex input, BoundingBox boundingBox)
+{
+    float3 quantizedPosition = float3(input.Position.x & 0xFFFF, input.Position.x >> 16, input.Position.y & 0xFFFF);
+    int2 quantizedNormal = int2(input.Normal << 16, input.Normal) >> 16;
+
+    Vertex result;
+    result.Position = boundingBox.MinPoint + quantizedPosition / 65535.0 * (boundingBox.MaxPoint - boundingBox.MinPoint);
+    result.Normal = DecodeOctahedralNormal(max(float2(quantizedNormal) / 32767.0, -1.0));
+    result.TextureCoordinates = f16tof32(uint2(input.TextureCoordinates, input.TextureCoordinates >> 16));
+
+    return result;
+}
+
+// Projects the object space error stored with each level of detail of a MESH sub object to pixels,
+// projectionScale is viewportHeight / (2 * tan(fieldOfView / 2)). The least detailed level with a
+// projected error below the pixel threshold can be drawn without visible difference.
+float ComputeLodScreenSpaceError(float lodError, float worldScale, float distance, float projectionScale)
+{
+    return lodError * worldScale * projectionScale / max(distance, 0.0001);
+}
+
 struct Mesh
 {
     uint MeshletCount;
@@ -0,0 +1,104 @@
+using System;
+using System.IO;
+using CoreEngine.Tools.ResourceCompilers;
+using TeximpNet;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public static class BenchmarkAssets
+    {
+        private static readonly Lazy<string> testDataDirectory = new Lazy<string>(FindTestDataDirectory);
+
+        // The benchmarks run from a generated project in the output directory so the TestData directory of the
+        // repository is searched from there, COREENGINE_TESTDATA can point to another asset set
+        public static string TestDataDirectory
+        {
+            get
+            {
+                return testDataDirectory.Value;
+            }
+        }
+
+        public static string OutputDirectory
+        {
+            get
+            {
+                return Path.Combine(Path.GetTempPath(), "CoreEngineBenchmarks");
+            }
+        }
+
+        public static string GetPath(string relativePath)
+        {
+            return Path.Combine(TestDataDirectory, relativePath);
+        }
+
+        public static CompilerContext CreateContext(string sourcePath, BuildProfile buildProfile = BuildProfile.Full)
+        {
+            var context = new CompilerContext("windows", Path.GetFileName(sourcePath), Path.GetDirectoryName(sourcePath)!, OutputDirectory, OutputDirectory);
+            context.BuildProfile = buildProfile;
+
+            return context;
+        }
+
+        // Sums the compiled data so the work cannot be optimized away and returns the pooled buffers
+        public static long ReleaseResourceEntries(ReadOnlyMemory<ResourceEntry> resourceEntries)
+        {
+            var result = 0L;
+
+            foreach (var resourceEntry in resourceEntries.Span)
+            {
+                result += resourceEntry.Data.Length;
+                resourceEntry.Dispose();
+            }
+
+            return result;
+        }
+
+        public static long CountObjVertices(string path)
+        {
+            var result = 0L;
+
+            foreach (var line in File.ReadLines(path))
+            {
+                if (line.StartsWith("v ", StringComparison.Ordinal))
+                {
+                    result++;
+                }
+            }
+
+            return result;
+        }
+
+        public static long CountTexels(string path)
+        {
+            using var image = Surface.LoadFromFile(path);
+            return (long)image.Width * image.Height;
+        }
+
+        private static string FindTestDataDirectory()
+        {
+            var environmentDirectory = Environment.GetEnvironmentVariable("COREENGINE_TESTDATA");
+
+            if (!string.IsNullOrEmpty(environmentDirectory))
+            {
+                return Path.GetFullPath(environmentDirectory);
+            }
+
+            var directory = new DirectoryInfo(AppContext.BaseDirectory);
+
+            while (directory != null)
+            {
+                var testDataPath = Path.Combine(directory.FullName, "TestData");
+
+                if (File.Exists(Path.Combine(testDataPath, "TestProject.ceproj")))
+                {
+                    return testDataPath;
+                }
+
+                directory = directory.Parent;
+            }
+
+            throw new DirectoryNotFoundException("The TestData directory was not found, set COREENGINE_TESTDATA to its path.");
+        }
+    }
+}
@@ -0,0 +1,26 @@
+using BenchmarkDotNet.Configs;
+using BenchmarkDotNet.Diagnosers;
+using BenchmarkDotNet.Exporters.Json;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public class BenchmarkConfig : ManualConfig
+    {
+        public BenchmarkConfig()
+        {
+            // The default exporters already write CSV, GitHub markdown and HTML reports
+            Add(DefaultConfig.Instance);
+
+            // Only managed allocations are measured, the memory allocated by the native libraries (Teximp, Assimp, Skia) is not
+            Add(MemoryDiagnoser.Default);
+
+            Add(new ThroughputColumn(ThroughputUnit.Megabytes));
+            Add(new ThroughputColumn(ThroughputUnit.Vertices));
+            Add(new ThroughputColumn(ThroughputUnit.Texels));
+            Add(new PsnrColumn());
+
+            // The full JSON export keeps every measurement so that two runs can be compared afterwards
+            Add(JsonExporter.Full);
+        }
+    }
+}
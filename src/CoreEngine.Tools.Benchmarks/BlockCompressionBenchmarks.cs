@@ -0,0 +1,149 @@
+using System;
+using System.IO;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Textures;
+using TeximpNet;
+using TeximpNet.Compression;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    // Compares the throughput and quality of the block compressor with Teximp on the top mip level of an image
+    public class BlockCompressionBenchmarks
+    {
+        private const string TeximpEncoder = "Teximp";
+
+        private Surface? image;
+        private byte[] rgbaData = Array.Empty<byte>();
+        private BlockCompressionFormat format;
+        private int width;
+        private int height;
+
+        // A color texture (BC3), a normal map (BC5) and a bump map (BC4)
+        [Params("Sponza/textures/sponza_floor_a_diff.png", "Sponza/textures/sponza_floor_a_ddn.png", "Sponza/textures/sponza_floor_a_bump.png")]
+        public string Input { get; set; } = string.Empty;
+
+        [Params(nameof(BlockCompressionQuality.Fast), nameof(BlockCompressionQuality.Normal), nameof(BlockCompressionQuality.High), TeximpEncoder)]
+        public string Encoder { get; set; } = string.Empty;
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var path = BenchmarkAssets.GetPath((string)parameters["Input"]);
+            return new WorkloadSize(new FileInfo(path).Length, texels: BenchmarkAssets.CountTexels(path));
+        }
+
+        // Computed once in the host process for the PSNR column
+        public static double GetPsnr(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var benchmarks = new BlockCompressionBenchmarks();
+            benchmarks.Input = (string)parameters["Input"];
+            benchmarks.Encoder = (string)parameters["Encoder"];
+            benchmarks.Setup();
+
+            try
+            {
+                var decodedData = BlockCompressor.Decompress(benchmarks.Compress(), benchmarks.width, benchmarks.height, benchmarks.format);
+                return ComputePsnr(benchmarks.rgbaData, decodedData, benchmarks.format);
+            }
+
+            finally
+            {
+                benchmarks.Cleanup();
+            }
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            var path = BenchmarkAssets.GetPath(this.Input);
+            this.format = TextureResourceDataCompiler.GetBlockCompressionFormat(Path.GetFileName(path));
+
+            this.image = Surface.LoadFromFile(path);
+            this.image.ConvertTo(ImageConversion.To32Bits);
+
+            this.width = this.image.Width;
+            this.height = this.image.Height;
+            this.rgbaData = TextureResourceDataCompiler.ReadRgbaData(this.image, this.format == BlockCompressionFormat.BC5);
+        }
+
+        [GlobalCleanup]
+        public void Cleanup()
+        {
+            this.image?.Dispose();
+            this.image = null;
+        }
+
+        [Benchmark]
+        public byte[] Compress()
+        {
+            if (this.Encoder == TeximpEncoder)
+            {
+                return CompressWithTeximp();
+            }
+
+            var quality = Enum.Parse<BlockCompressionQuality>(this.Encoder);
+            return BlockCompressor.Compress(this.rgbaData, this.width, this.height, this.format, quality);
+        }
+
+        private unsafe byte[] CompressWithTeximp()
+        {
+            using var compressor = new Compressor();
+            compressor.Input.GenerateMipmaps = false;
+            compressor.Input.SetData(this.image);
+            compressor.Input.IsNormalMap = (this.format == BlockCompressionFormat.BC5);
+            compressor.Compression.Format = this.format == BlockCompressionFormat.BC1 ? CompressionFormat.BC1 : this.format == BlockCompressionFormat.BC4 ? CompressionFormat.BC4 : this.format == BlockCompressionFormat.BC5 ? CompressionFormat.BC5 : CompressionFormat.BC3;
+            compressor.Compression.Quality = CompressionQuality.Normal;
+            compressor.Output.OutputFileFormat = OutputFileFormat.DDS10;
+
+            compressor.Process(out var compressedImage);
+
+            if (compressedImage == null)
+            {
+                throw new InvalidOperationException($"Teximp: {compressor.LastErrorString}");
+            }
+
+            using (compressedImage)
+            {
+                var mipData = compressedImage.MipChains[0][0];
+                return new Span<byte>(mipData.Data.ToPointer(), mipData.SizeInBytes).ToArray();
+            }
+        }
+
+        // Only the channels stored by the format are compared
+        private static double ComputePsnr(byte[] sourceData, byte[] decodedData, BlockCompressionFormat format)
+        {
+            var channelCount = (format == BlockCompressionFormat.BC4) ? 1 : (format == BlockCompressionFormat.BC5) ? 2 : (format == BlockCompressionFormat.BC1) ? 3 : 4;
+            var squaredError = 0.0;
+
+            for (var i = 0; i < sourceData.Length; i += 4)
+            {
+                for (var c = 0; c < channelCount; c++)
+                {
+                    var difference = sourceData[i + c] - decodedData[i + c];
+                    squaredError += difference * difference;
+                }
+            }
+
+            if (squaredError == 0.0)
+            {
+                return double.PositiveInfinity;
+            }
+
+            var meanSquaredError = squaredError / (sourceData.Length / 4 * channelCount);
+            return 10.0 * Math.Log10(255.0 * 255.0 / meanSquaredError);
+        }
+    }
+}
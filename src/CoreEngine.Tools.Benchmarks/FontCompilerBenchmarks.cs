@@ -0,0 +1,41 @@
+using System;
+using System.IO;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Textures;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public class FontCompilerBenchmarks
+    {
+        private const string FontPath = "System/Fonts/SystemFont.ttf";
+
+        private readonly FontResourceDataCompiler compiler = new FontResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            return new WorkloadSize(new FileInfo(BenchmarkAssets.GetPath(FontPath)).Length);
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            var path = BenchmarkAssets.GetPath(FontPath);
+            this.sourceData = File.ReadAllBytes(path);
+            this.context = BenchmarkAssets.CreateContext(path);
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
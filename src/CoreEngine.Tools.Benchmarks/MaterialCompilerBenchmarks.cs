@@ -0,0 +1,47 @@
+using System;
+using System.IO;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Materials;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public class MaterialCompilerBenchmarks
+    {
+        private readonly MaterialResourceDataCompiler compiler = new MaterialResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        [Params("Sponza/sponza.mtl", "TestTextureMaterial.cematerial", "TestWoodMaterial.cematerial", "TestRedMaterial.cematerial")]
+        public string Input { get; set; } = string.Empty;
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            return new WorkloadSize(new FileInfo(BenchmarkAssets.GetPath((string)parameters["Input"])).Length);
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            var path = BenchmarkAssets.GetPath(this.Input);
+            this.sourceData = File.ReadAllBytes(path);
+            this.context = BenchmarkAssets.CreateContext(path);
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
@@ -0,0 +1,55 @@
+using System;
+using System.IO;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Meshes;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public class MeshCompilerBenchmarks
+    {
+        private readonly MeshResourceDataCompiler compiler = new MeshResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        [Params("Sponza/sponza.obj", "Maison3D.obj")]
+        public string Input { get; set; } = string.Empty;
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var path = BenchmarkAssets.GetPath((string)parameters["Input"]);
+            return new WorkloadSize(new FileInfo(path).Length, BenchmarkAssets.CountObjVertices(path));
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            var path = BenchmarkAssets.GetPath(this.Input);
+            this.sourceData = File.ReadAllBytes(path);
+            this.context = BenchmarkAssets.CreateContext(path);
+        }
+
+        [Benchmark]
+        public async Task<long> ReadObj()
+        {
+            var meshData = await new ObjMeshDataReader().ReadAsync(this.sourceData);
+            return meshData?.Vertices.Count ?? 0;
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
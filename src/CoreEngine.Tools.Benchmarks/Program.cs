@@ -0,0 +1,14 @@
+using BenchmarkDotNet.Running;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    class Program
+    {
+        // Runs the benchmarks selected on the command line, for example:
+        // dotnet run -c Release -- --filter *Mesh* --artifacts ./BenchmarkResults
+        static void Main(string[] args)
+        {
+            BenchmarkSwitcher.FromAssembly(typeof(Program).Assembly).Run(args, new BenchmarkConfig());
+        }
+    }
+}
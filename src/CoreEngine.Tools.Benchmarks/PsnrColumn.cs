@@ -0,0 +1,138 @@
+using System;
+using System.Collections.Concurrent;
+using System.Globalization;
+using System.Linq;
+using System.Reflection;
+using BenchmarkDotNet.Columns;
+using BenchmarkDotNet.Parameters;
+using BenchmarkDotNet.Reports;
+using BenchmarkDotNet.Running;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    // Benchmark classes measuring an encoder expose its quality with a static GetPsnr(ParameterInstances) method,
+    // like the workload size of the throughput columns
+    public class PsnrColumn : IColumn
+    {
+        private static readonly ConcurrentDictionary<string, double?> psnrValues = new ConcurrentDictionary<string, double?>();
+
+        public string Id
+        {
+            get
+            {
+                return nameof(PsnrColumn);
+            }
+        }
+
+        public string ColumnName
+        {
+            get
+            {
+                return "PSNR (dB)";
+            }
+        }
+
+        public bool AlwaysShow
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public ColumnCategory Category
+        {
+            get
+            {
+                return ColumnCategory.Custom;
+            }
+        }
+
+        public int PriorityInCategory
+        {
+            get
+            {
+                return 0;
+            }
+        }
+
+        public bool IsNumeric
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public UnitType UnitType
+        {
+            get
+            {
+                return UnitType.Dimensionless;
+            }
+        }
+
+        public string Legend
+        {
+            get
+            {
+                return "Peak signal to noise ratio of the decoded data on the channels stored by the format";
+            }
+        }
+
+        public string GetValue(Summary summary, BenchmarkCase benchmarkCase)
+        {
+            if (benchmarkCase == null)
+            {
+                throw new ArgumentNullException(nameof(benchmarkCase));
+            }
+
+            var psnr = GetPsnr(benchmarkCase.Descriptor.Type, benchmarkCase.Parameters);
+
+            if (psnr == null)
+            {
+                return "-";
+            }
+
+            return psnr.Value.ToString("0.00", CultureInfo.InvariantCulture);
+        }
+
+        public string GetValue(Summary summary, BenchmarkCase benchmarkCase, SummaryStyle style)
+        {
+            return GetValue(summary, benchmarkCase);
+        }
+
+        public bool IsAvailable(Summary summary)
+        {
+            if (summary == null)
+            {
+                throw new ArgumentNullException(nameof(summary));
+            }
+
+            return summary.BenchmarksCases.Any(x => GetPsnrMethod(x.Descriptor.Type) != null);
+        }
+
+        public bool IsDefault(Summary summary, BenchmarkCase benchmarkCase)
+        {
+            return false;
+        }
+
+        public override string ToString()
+        {
+            return this.ColumnName;
+        }
+
+        private static double? GetPsnr(Type benchmarkType, ParameterInstances parameters)
+        {
+            return psnrValues.GetOrAdd($"{benchmarkType.FullName} {parameters.DisplayInfo}", _ =>
+            {
+                return (double?)GetPsnrMethod(benchmarkType)?.Invoke(null, new object[] { parameters });
+            });
+        }
+
+        private static MethodInfo? GetPsnrMethod(Type benchmarkType)
+        {
+            return benchmarkType.GetMethod("GetPsnr", BindingFlags.Public | BindingFlags.Static, null, new Type[] { typeof(ParameterInstances) }, null);
+        }
+    }
+}
@@ -0,0 +1,46 @@
+using System;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Scenes;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    // TestData has no scene so the scenes are generated
+    public class SceneCompilerBenchmarks
+    {
+        private readonly SceneResourceDataCompiler compiler = new SceneResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        [Params(100, 1000, 10000)]
+        public int EntityCount { get; set; }
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            return new WorkloadSize(SyntheticAssetGenerator.GenerateScene((int)parameters["EntityCount"]).Length);
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            this.sourceData = SyntheticAssetGenerator.GenerateScene(this.EntityCount);
+            this.context = BenchmarkAssets.CreateContext($"Synthetic{this.EntityCount}.cescene");
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
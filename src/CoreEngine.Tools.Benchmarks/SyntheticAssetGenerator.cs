@@ -0,0 +1,97 @@
+using System;
+using System.Globalization;
+using System.Text;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    // Generates sources of a given size to measure how the compilers scale beyond the TestData assets
+    public static class SyntheticAssetGenerator
+    {
+        // Height field of gridSize x gridSize vertices split in sub objects of 64 rows, the heights are deterministic
+        // so that every run compiles the same mesh
+        public static byte[] GenerateObjMesh(int gridSize)
+        {
+            if (gridSize < 2)
+            {
+                throw new ArgumentOutOfRangeException(nameof(gridSize));
+            }
+
+            const int RowsPerSubObject = 64;
+
+            var builder = new StringBuilder();
+            var random = new Random(gridSize);
+
+            for (var y = 0; y < gridSize; y++)
+            {
+                for (var x = 0; x < gridSize; x++)
+                {
+                    var height = MathF.Sin(x * 0.1f) * MathF.Cos(y * 0.1f) * 4.0f + (float)random.NextDouble() * 0.1f;
+                    builder.Append(FormattableString.Invariant($"v {x} {height:0.0000} {y}\n"));
+                }
+            }
+
+            for (var y = 0; y < gridSize; y++)
+            {
+                for (var x = 0; x < gridSize; x++)
+                {
+                    builder.Append(FormattableString.Invariant($"vt {(float)x / (gridSize - 1):0.00000} {(float)y / (gridSize - 1):0.00000}\n"));
+                }
+            }
+
+            builder.Append("vn 0 1 0\n");
+
+            for (var y = 0; y < gridSize - 1; y++)
+            {
+                if (y % RowsPerSubObject == 0)
+                {
+                    builder.Append(FormattableString.Invariant($"g Rows{y}\nusemtl Material{y / RowsPerSubObject % 4}\n"));
+                }
+
+                for (var x = 0; x < gridSize - 1; x++)
+                {
+                    // OBJ indices start at 1
+                    var index0 = y * gridSize + x + 1;
+                    var index1 = index0 + 1;
+                    var index2 = index0 + gridSize;
+                    var index3 = index2 + 1;
+
+                    builder.Append(FormattableString.Invariant($"f {index0}/{index0}/1 {index1}/{index1}/1 {index3}/{index3}/1\n"));
+                    builder.Append(FormattableString.Invariant($"f {index0}/{index0}/1 {index3}/{index3}/1 {index2}/{index2}/1\n"));
+                }
+            }
+
+            return Encoding.UTF8.GetBytes(builder.ToString());
+        }
+
+        public static byte[] GenerateScene(int entityCount)
+        {
+            if (entityCount < 0)
+            {
+                throw new ArgumentOutOfRangeException(nameof(entityCount));
+            }
+
+            var builder = new StringBuilder();
+            builder.Append("Entities:\n");
+
+            for (var i = 0; i < entityCount; i++)
+            {
+                builder.Append(FormattableString.Invariant($"  - Entity: Entity{i}\n"));
+                builder.Append("    Components:\n");
+                builder.Append("      - Component: TransformComponent\n");
+                builder.Append(FormattableString.Invariant($"        Position: [{i % 100}, 0, {i / 100}]\n"));
+                builder.Append("        Scale: [1, 1, 1]\n");
+                builder.Append(FormattableString.Invariant($"        RotationY: {i % 360}\n"));
+
+                // Half of the entities have a second layout so that the scene has several entity layouts
+                if (i % 2 == 0)
+                {
+                    builder.Append("      - Component: MeshComponent\n");
+                    builder.Append("        MeshResourcePath: '/sponza.mesh'\n");
+                    builder.Append("        IsStatic: true\n");
+                }
+            }
+
+            return Encoding.UTF8.GetBytes(builder.ToString());
+        }
+    }
+}
@@ -0,0 +1,47 @@
+using System;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Meshes;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    // Compiles generated height fields of increasing size to get the scaling curve of the mesh pipeline
+    public class SyntheticMeshBenchmarks
+    {
+        private readonly MeshResourceDataCompiler compiler = new MeshResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        [Params(64, 256, 1024)]
+        public int GridSize { get; set; }
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var gridSize = (int)parameters["GridSize"];
+            return new WorkloadSize(SyntheticAssetGenerator.GenerateObjMesh(gridSize).Length, (long)gridSize * gridSize);
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            this.sourceData = SyntheticAssetGenerator.GenerateObjMesh(this.GridSize);
+            this.context = BenchmarkAssets.CreateContext($"Synthetic{this.GridSize}.obj");
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
@@ -0,0 +1,52 @@
+using System;
+using System.IO;
+using System.Threading.Tasks;
+using BenchmarkDotNet.Attributes;
+using BenchmarkDotNet.Parameters;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+using CoreEngine.Tools.ResourceCompilers.Graphics.Textures;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public class TextureCompilerBenchmarks
+    {
+        private readonly TextureResourceDataCompiler compiler = new TextureResourceDataCompiler();
+        private ReadOnlyMemory<byte> sourceData;
+        private CompilerContext? context;
+
+        // A color texture (BC3), a normal map (BC5) and a bump map (BC4)
+        [Params("Sponza/textures/sponza_floor_a_diff.png", "Sponza/textures/sponza_floor_a_ddn.png", "Sponza/textures/sponza_floor_a_bump.png")]
+        public string Input { get; set; } = string.Empty;
+
+        [Params(BuildProfile.Full, BuildProfile.Iteration)]
+        public BuildProfile Profile { get; set; }
+
+        public static WorkloadSize GetWorkloadSize(ParameterInstances parameters)
+        {
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var path = BenchmarkAssets.GetPath((string)parameters["Input"]);
+            return new WorkloadSize(new FileInfo(path).Length, texels: BenchmarkAssets.CountTexels(path));
+        }
+
+        [GlobalSetup]
+        public void Setup()
+        {
+            Logger.IsEnabled = false;
+
+            var path = BenchmarkAssets.GetPath(this.Input);
+            this.sourceData = File.ReadAllBytes(path);
+            this.context = BenchmarkAssets.CreateContext(path, this.Profile);
+        }
+
+        [Benchmark]
+        public async Task<long> Compile()
+        {
+            return BenchmarkAssets.ReleaseResourceEntries(await this.compiler.CompileAsync(this.sourceData, this.context!));
+        }
+    }
+}
@@ -0,0 +1,165 @@
+using System;
+using System.Collections.Concurrent;
+using System.Globalization;
+using System.Linq;
+using System.Reflection;
+using BenchmarkDotNet.Columns;
+using BenchmarkDotNet.Parameters;
+using BenchmarkDotNet.Reports;
+using BenchmarkDotNet.Running;
+
+namespace CoreEngine.Tools.Benchmarks
+{
+    public enum ThroughputUnit
+    {
+        Megabytes,
+        Vertices,
+        Texels
+    }
+
+    // Benchmark classes expose their workload with a static GetWorkloadSize(ParameterInstances) method because
+    // the columns are computed in the host process and not in the process that ran the benchmark
+    public class ThroughputColumn : IColumn
+    {
+        private static readonly ConcurrentDictionary<string, WorkloadSize?> workloadSizes = new ConcurrentDictionary<string, WorkloadSize?>();
+
+        private readonly ThroughputUnit unit;
+
+        public ThroughputColumn(ThroughputUnit unit)
+        {
+            this.unit = unit;
+        }
+
+        public string Id
+        {
+            get
+            {
+                return $"{nameof(ThroughputColumn)}.{this.unit}";
+            }
+        }
+
+        public string ColumnName
+        {
+            get
+            {
+                return (this.unit == ThroughputUnit.Megabytes) ? "MB/s" : (this.unit == ThroughputUnit.Vertices) ? "Mvertices/s" : "Mtexels/s";
+            }
+        }
+
+        public bool AlwaysShow
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public ColumnCategory Category
+        {
+            get
+            {
+                return ColumnCategory.Custom;
+            }
+        }
+
+        public int PriorityInCategory
+        {
+            get
+            {
+                return (int)this.unit;
+            }
+        }
+
+        public bool IsNumeric
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public UnitType UnitType
+        {
+            get
+            {
+                return UnitType.Dimensionless;
+            }
+        }
+
+        public string Legend
+        {
+            get
+            {
+                return (this.unit == ThroughputUnit.Megabytes) ? "Source megabytes compiled per second" : (this.unit == ThroughputUnit.Vertices) ? "Millions of source vertices compiled per second" : "Millions of source texels compiled per second";
+            }
+        }
+
+        public string GetValue(Summary summary, BenchmarkCase benchmarkCase)
+        {
+            if (summary == null)
+            {
+                throw new ArgumentNullException(nameof(summary));
+            }
+
+            var statistics = summary[benchmarkCase]?.ResultStatistics;
+            var unitCount = GetUnitCount(benchmarkCase);
+
+            if (statistics == null || unitCount == 0)
+            {
+                return "-";
+            }
+
+            // The mean is in nanoseconds
+            var unitsPerSecond = unitCount / (statistics.Mean / 1000000000.0);
+            var divisor = (this.unit == ThroughputUnit.Megabytes) ? 1024.0 * 1024.0 : 1000000.0;
+
+            return (unitsPerSecond / divisor).ToString("0.00", CultureInfo.InvariantCulture);
+        }
+
+        public string GetValue(Summary summary, BenchmarkCase benchmarkCase, SummaryStyle style)
+        {
+            return GetValue(summary, benchmarkCase);
+        }
+
+        public bool IsAvailable(Summary summary)
+        {
+            if (summary == null)
+            {
+                throw new ArgumentNullException(nameof(summary));
+            }
+
+            return summary.BenchmarksCases.Any(x => GetUnitCount(x) > 0);
+        }
+
+        public bool IsDefault(Summary summary, BenchmarkCase benchmarkCase)
+        {
+            return false;
+        }
+
+        public override string ToString()
+        {
+            return this.ColumnName;
+        }
+
+        private long GetUnitCount(BenchmarkCase benchmarkCase)
+        {
+            var workloadSize = GetWorkloadSize(benchmarkCase.Descriptor.Type, benchmarkCase.Parameters);
+
+            if (workloadSize == null)
+            {
+                return 0;
+            }
+
+            return (this.unit == ThroughputUnit.Megabytes) ? workloadSize.Bytes : (this.unit == ThroughputUnit.Vertices) ? workloadSize.Vertices : workloadSize.Texels;
+        }
+
+        private static WorkloadSize? GetWorkloadSize(Type benchmarkType, ParameterInstances parameters)
+        {
+            return workloadSizes.GetOrAdd($"{benchmarkType.FullName} {parameters.DisplayInfo}", _ =>
+            {
+                var method = benchmarkType.GetMethod("GetWorkloadSize", BindingFlags.Public | BindingFlags.Static, null, new Type[] { typeof(ParameterInstances) }, null);
+                return (WorkloadSize?)method?.Invoke(null, new object[] { parameters });
+            });
+        }
+    }
+}
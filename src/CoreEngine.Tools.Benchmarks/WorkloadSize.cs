@@ -0,0 +1,17 @@
+namespace CoreEngine.Tools.Benchmarks
+{
+    // Amount of work done by one benchmark invocation, used to compute the throughput columns
+    public class WorkloadSize
+    {
+        public WorkloadSize(long bytes, long vertices = 0, long texels = 0)
+        {
+            this.Bytes = bytes;
+            this.Vertices = vertices;
+            this.Texels = texels;
+        }
+
+        public long Bytes { get; }
+        public long Vertices { get; }
+        public long Texels { get; }
+    }
+}
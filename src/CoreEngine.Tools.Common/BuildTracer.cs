@@ -0,0 +1,245 @@
+using System;
+using System.Collections.Concurrent;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.IO;
+using System.Text.Json;
+
+namespace CoreEngine.Tools.Common
+{
+    public class TraceEvent
+    {
+        public TraceEvent(string name, string category, int threadId, long startTimestamp, long endTimestamp, IReadOnlyDictionary<string, object>? arguments)
+        {
+            this.Name = name;
+            this.Category = category;
+            this.ThreadId = threadId;
+            this.StartTimestamp = startTimestamp;
+            this.EndTimestamp = endTimestamp;
+            this.Arguments = arguments;
+        }
+
+        public string Name { get; }
+        public string Category { get; }
+        public int ThreadId { get; }
+        public long StartTimestamp { get; }
+        public long EndTimestamp { get; }
+        public IReadOnlyDictionary<string, object>? Arguments { get; }
+
+        public TimeSpan Duration
+        {
+            get
+            {
+                return TimeSpan.FromSeconds((double)(this.EndTimestamp - this.StartTimestamp) / Stopwatch.Frequency);
+            }
+        }
+
+        public object? GetArgument(string name)
+        {
+            if (this.Arguments != null && this.Arguments.TryGetValue(name, out var value))
+            {
+                return value;
+            }
+
+            return null;
+        }
+    }
+
+    public sealed class TraceSpan : IDisposable
+    {
+        // Returned when tracing is disabled so that instrumented code doesn't need to check
+        internal static readonly TraceSpan Disabled = new TraceSpan(string.Empty, string.Empty, isEnabled: false);
+
+        private readonly bool isEnabled;
+        private readonly int threadId;
+        private readonly long startTimestamp;
+        private readonly long startAllocatedBytes;
+        private Dictionary<string, object>? arguments;
+        private bool isEnded;
+
+        internal TraceSpan(string name, string category, bool isEnabled = true)
+        {
+            this.Name = name;
+            this.Category = category;
+            this.isEnabled = isEnabled;
+
+            if (isEnabled)
+            {
+                this.threadId = Environment.CurrentManagedThreadId;
+                this.startAllocatedBytes = GC.GetAllocatedBytesForCurrentThread();
+                this.startTimestamp = Stopwatch.GetTimestamp();
+            }
+        }
+
+        public string Name { get; }
+        public string Category { get; }
+
+        public void SetArgument(string name, object value)
+        {
+            if (!this.isEnabled)
+            {
+                return;
+            }
+
+            if (this.arguments == null)
+            {
+                this.arguments = new Dictionary<string, object>();
+            }
+
+            this.arguments[name] = value;
+        }
+
+        public void Dispose()
+        {
+            if (!this.isEnabled || this.isEnded)
+            {
+                return;
+            }
+
+            this.isEnded = true;
+            var endTimestamp = Stopwatch.GetTimestamp();
+
+            // The allocation counter is per thread so it is only meaningful when the span didn't resume on another thread
+            if (Environment.CurrentManagedThreadId == this.threadId)
+            {
+                SetArgument("allocatedBytes", GC.GetAllocatedBytesForCurrentThread() - this.startAllocatedBytes);
+            }
+
+            BuildTracer.AddEvent(new TraceEvent(this.Name, this.Category, this.threadId, this.startTimestamp, endTimestamp, this.arguments));
+        }
+    }
+
+    // Records timing spans of the build and writes them in the Chrome trace event format, which can be opened
+    // in chrome://tracing or https://ui.perfetto.dev
+    public static class BuildTracer
+    {
+        private static readonly ConcurrentQueue<TraceEvent> events = new ConcurrentQueue<TraceEvent>();
+        private static long originTimestamp;
+        private static volatile bool isEnabled;
+
+        public static bool IsEnabled
+        {
+            get
+            {
+                return isEnabled;
+            }
+        }
+
+        // Discards the events of the previous trace
+        public static void Start()
+        {
+            events.Clear();
+            originTimestamp = Stopwatch.GetTimestamp();
+            isEnabled = true;
+        }
+
+        public static void Stop()
+        {
+            isEnabled = false;
+        }
+
+        public static TraceSpan BeginSpan(string name, string category)
+        {
+            if (!isEnabled)
+            {
+                return TraceSpan.Disabled;
+            }
+
+            return new TraceSpan(name, category);
+        }
+
+        // Events are ordered by completion time
+        public static IList<TraceEvent> GetEvents()
+        {
+            return new List<TraceEvent>(events);
+        }
+
+        public static void WriteTrace(string path)
+        {
+            if (path == null)
+            {
+                throw new ArgumentNullException(nameof(path));
+            }
+
+            using var stream = new FileStream(path, FileMode.Create, FileAccess.Write);
+            using var writer = new Utf8JsonWriter(stream);
+
+            writer.WriteStartObject();
+            writer.WriteString("displayTimeUnit", "ms");
+            writer.WriteStartArray("traceEvents");
+
+            writer.WriteStartObject();
+            writer.WriteString("name", "process_name");
+            writer.WriteString("ph", "M");
+            writer.WriteNumber("pid", 1);
+            writer.WriteStartObject("args");
+            writer.WriteString("name", "CoreEngineCompiler");
+            writer.WriteEndObject();
+            writer.WriteEndObject();
+
+            foreach (var traceEvent in events)
+            {
+                // Complete events with timestamps in microseconds
+                writer.WriteStartObject();
+                writer.WriteString("name", traceEvent.Name);
+                writer.WriteString("cat", traceEvent.Category);
+                writer.WriteString("ph", "X");
+                writer.WriteNumber("ts", ToMicroseconds(traceEvent.StartTimestamp - originTimestamp));
+                writer.WriteNumber("dur", ToMicroseconds(traceEvent.EndTimestamp - traceEvent.StartTimestamp));
+                writer.WriteNumber("pid", 1);
+                writer.WriteNumber("tid", traceEvent.ThreadId);
+
+                if (traceEvent.Arguments != null)
+                {
+                    writer.WriteStartObject("args");
+
+                    foreach (var argument in traceEvent.Arguments)
+                    {
+                        switch (argument.Value)
+                        {
+                            case bool boolValue:
+                                writer.WriteBoolean(argument.Key, boolValue);
+                                break;
+
+                            case int intValue:
+                                writer.WriteNumber(argument.Key, intValue);
+                                break;
+
+                            case long longValue:
+                                writer.WriteNumber(argument.Key, longValue);
+                                break;
+
+                            case double doubleValue:
+                                writer.WriteNumber(argument.Key, doubleValue);
+                                break;
+
+                            default:
+                                writer.WriteString(argument.Key, argument.Value.ToString());
+                                break;
+                        }
+                    }
+
+                    writer.WriteEndObject();
+                }
+
+                writer.WriteEndObject();
+            }
+
+            writer.WriteEndArray();
+            writer.WriteEndObject();
+        }
+
+        internal static void AddEvent(TraceEvent traceEvent)
+        {
+            if (isEnabled)
+            {
+                events.Enqueue(traceEvent);
+            }
+        }
+
+        private static double ToMicroseconds(long timestampDelta)
+        {
+            return Math.Round(timestampDelta * 1000000.0 / Stopwatch.Frequency, 3);
+        }
+    }
+}
@@ -1,46 +1,134 @@
 using System;
-using System.Diagnostics;
 using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.Threading;
 
 namespace CoreEngine.Tools.Common
 {
+    // Messages are queued in a lock-free ring buffer and written to the console by a background thread so that
+    // compile jobs never wait on the console, Flush waits until the queued messages have been written
     public static class Logger
     {
-        // TODO: This code is not thread-safe!
-        private static Stack<string> messageStack = new Stack<string>();
-        private static int currentLevel = 0;
-        private static Stack<Stopwatch> stopwatchStack = new Stack<Stopwatch>();
+        private class LoggerAction
+        {
+            public LoggerAction(string message, LoggerAction? parent)
+            {
+                this.Message = message;
+                this.Parent = parent;
+                this.Level = (parent != null) ? parent.Level + 1 : 1;
+                this.Stopwatch = Stopwatch.StartNew();
+                this.Messages = (parent != null) ? parent.Messages : new LogMessageBlock();
+            }
 
-        public static void WriteMessage(string message, LogMessageTypes messageType = LogMessageTypes.Normal)
+            public string Message { get; }
+            public LoggerAction? Parent { get; }
+            public int Level { get; }
+            public Stopwatch Stopwatch { get; }
+
+            // Shared by the nested actions of an outermost action
+            public LogMessageBlock Messages { get; }
+        }
+
+        // Messages of an outermost action and of its nested actions, queued as one entry when the action ends so that
+        // the messages of concurrent compile jobs don't interleave
+        private class LogMessageBlock
         {
-            if ((messageType & LogMessageTypes.Success) != 0)
+            public List<LogMessage> Messages { get; } = new List<LogMessage>();
+            public bool IsEnded { get; set; }
+        }
+
+        private struct LogMessage
+        {
+            public LogMessage(string message, LogMessageTypes messageType, int level)
             {
-                Console.ForegroundColor = ConsoleColor.Green;
+                this.Message = message;
+                this.MessageType = messageType;
+                this.Level = level;
             }
 
-            else if ((messageType & LogMessageTypes.Action) != 0)
+            public string Message { get; }
+            public LogMessageTypes MessageType { get; }
+            public int Level { get; }
+        }
+
+        private struct LogEntry
+        {
+            // Equals the enqueue position + 1 once the entry is written and the position + capacity once it is consumed
+            public long Sequence;
+            public string? Message;
+            public LogMessageTypes MessageType;
+            public int Level;
+
+            // Set instead of the message for the messages of an outermost action
+            public LogMessage[]? Block;
+        }
+
+        private const int Capacity = 4096;
+
+        // Flush gives up after this delay so that a blocked console cannot hang the compiler
+        private static readonly TimeSpan flushTimeout = TimeSpan.FromSeconds(10);
+
+        // Actions are tracked per async flow so that concurrent compile jobs keep their own nesting
+        private static readonly AsyncLocal<LoggerAction?> currentAction = new AsyncLocal<LoggerAction?>();
+
+        private static readonly LogEntry[] entries = CreateEntries();
+        private static readonly ManualResetEventSlim wakeEvent = new ManualResetEventSlim(false);
+        private static readonly Thread writerThread = new Thread(RunWriter);
+        private static long enqueuePosition;
+        private static long dequeuePosition;
+        private static int isWriterWaiting;
+
+        private static volatile bool isEnabled = true;
+        private static volatile LogMessageTypes enabledMessageTypes = LogMessageTypes.Minimal;
+
+        static Logger()
+        {
+            writerThread.Name = "Logger";
+            writerThread.IsBackground = true;
+            writerThread.Start();
+
+            AppDomain.CurrentDomain.ProcessExit += (sender, e) => Flush();
+        }
+
+        // Disabled by the benchmarks so that console output is not part of the measurements
+        public static bool IsEnabled
+        {
+            get
             {
-                Console.ForegroundColor = ConsoleColor.Cyan;
+                return isEnabled;
             }
 
-            else if ((messageType & LogMessageTypes.Warning) != 0)
+            set
             {
-                Console.ForegroundColor = ConsoleColor.Yellow;
+                isEnabled = value;
             }
+        }
 
-            else if ((messageType & LogMessageTypes.Error) != 0)
+        // Debug messages are filtered out unless the compiler runs in verbose mode
+        public static LogMessageTypes EnabledMessageTypes
+        {
+            get
             {
-                Console.ForegroundColor = ConsoleColor.Red;
+                return enabledMessageTypes;
             }
 
-            else if ((messageType & LogMessageTypes.Important) != 0)
+            set
             {
-                Console.ForegroundColor = ConsoleColor.White;
+                enabledMessageTypes = value;
             }
+        }
 
-            for (var i = 0; i < currentLevel; i++)
+        public static bool IsEnabledFor(LogMessageTypes messageType)
+        {
+            return isEnabled && (enabledMessageTypes & messageType) != 0;
+        }
+
+        public static void WriteMessage(string message, LogMessageTypes messageType = LogMessageTypes.Normal)
+        {
+            if (!IsEnabledFor(messageType))
             {
-                Console.Write(" ");
+                return;
             }
 
             if (messageType != LogMessageTypes.Normal && messageType != LogMessageTypes.Debug && messageType != LogMessageTypes.Important && messageType != LogMessageTypes.Action && messageType != LogMessageTypes.Success)
@@ -48,52 +136,307 @@ namespace CoreEngine.Tools.Common
                 message = $"{messageType.ToString()}: " + message;
             }
 
-            Console.WriteLine(message);
-            Debug.WriteLine(message);
-            Console.ForegroundColor = ConsoleColor.Gray;
+            var action = currentAction.Value;
+
+            if (action != null)
+            {
+                Write(action.Messages, new LogMessage(message, messageType, action.Level));
+            }
+
+            else
+            {
+                Enqueue(message, messageType, 0, null);
+            }
+        }
+
+        // The message is only formatted when its type is enabled, hot paths use these overloads for debug messages
+        public static void WriteMessage<T0>(LogMessageTypes messageType, string format, T0 argument0)
+        {
+            if (IsEnabledFor(messageType))
+            {
+                WriteMessage(string.Format(CultureInfo.InvariantCulture, format, argument0), messageType);
+            }
+        }
+
+        public static void WriteMessage<T0, T1>(LogMessageTypes messageType, string format, T0 argument0, T1 argument1)
+        {
+            if (IsEnabledFor(messageType))
+            {
+                WriteMessage(string.Format(CultureInfo.InvariantCulture, format, argument0, argument1), messageType);
+            }
+        }
+
+        public static void WriteMessage<T0, T1, T2>(LogMessageTypes messageType, string format, T0 argument0, T1 argument1, T2 argument2)
+        {
+            if (IsEnabledFor(messageType))
+            {
+                WriteMessage(string.Format(CultureInfo.InvariantCulture, format, argument0, argument1, argument2), messageType);
+            }
         }
 
         public static void WriteLine()
         {
-            Console.WriteLine();
+            if (!isEnabled)
+            {
+                return;
+            }
+
+            Enqueue(string.Empty, LogMessageTypes.Normal, 0, null);
         }
 
         public static void BeginAction(string message)
         {
-            messageStack.Push(message);
-            WriteMessage($"{message}...", LogMessageTypes.Action);
-            currentLevel++;
+            var action = new LoggerAction(message, currentAction.Value);
+            currentAction.Value = action;
 
-            var stopwatch = new Stopwatch();
-            stopwatch.Start();
-            stopwatchStack.Push(stopwatch);
+            if (IsEnabledFor(LogMessageTypes.Action))
+            {
+                Write(action.Messages, new LogMessage($"{message}...", LogMessageTypes.Action, action.Level - 1));
+            }
         }
 
         public static void EndAction()
         {
-            currentLevel--;
-            var message = messageStack.Pop();
-            var stopwatch = stopwatchStack.Pop();
-
-            WriteMessage($"{message} done. (Elapsed: {stopwatch.ElapsedMilliseconds} ms)", LogMessageTypes.Success);
+            var action = PopAction();
+            EndAction(action, $"{action.Message} done. (Elapsed: {action.Stopwatch.ElapsedMilliseconds} ms)", LogMessageTypes.Success);
         }
 
         public static void EndActionError()
         {
-            currentLevel--;
-            var message = messageStack.Pop();
-            stopwatchStack.Pop();
-
-            WriteMessage($"{message} failed.", LogMessageTypes.Error);
+            var action = PopAction();
+            EndAction(action, $"{action.Message} failed.", LogMessageTypes.Error);
         }
 
         public static void EndActionWarning(string message)
         {
-            currentLevel--;
-            messageStack.Pop();
-            stopwatchStack.Pop();
+            var action = PopAction();
+            EndAction(action, $"{message}.", LogMessageTypes.Warning);
+        }
+
+        // Waits until the messages queued before the call have been written to the console or until the timeout
+        public static void Flush()
+        {
+            var position = Interlocked.Read(ref enqueuePosition);
+            var spinWait = new SpinWait();
+            var stopwatch = Stopwatch.StartNew();
+
+            while (Interlocked.Read(ref dequeuePosition) < position)
+            {
+                if (!writerThread.IsAlive || stopwatch.Elapsed > flushTimeout)
+                {
+                    return;
+                }
+
+                wakeEvent.Set();
+                spinWait.SpinOnce();
+            }
+        }
+
+        private static LoggerAction PopAction()
+        {
+            var action = currentAction.Value;
+
+            if (action == null)
+            {
+                throw new InvalidOperationException("EndAction was called without a matching BeginAction.");
+            }
+
+            currentAction.Value = action.Parent;
+            return action;
+        }
+
+        private static void EndAction(LoggerAction action, string message, LogMessageTypes messageType)
+        {
+            if (IsEnabledFor(messageType))
+            {
+                if (messageType != LogMessageTypes.Success)
+                {
+                    message = $"{messageType.ToString()}: " + message;
+                }
+
+                Write(action.Messages, new LogMessage(message, messageType, action.Level - 1));
+            }
+
+            if (action.Parent != null)
+            {
+                return;
+            }
+
+            LogMessage[] block;
+
+            lock (action.Messages)
+            {
+                action.Messages.IsEnded = true;
+                block = action.Messages.Messages.ToArray();
+            }
+
+            if (block.Length > 0)
+            {
+                Enqueue(null, LogMessageTypes.Normal, 0, block);
+            }
+        }
+
+        // Tasks started by a compile job inherit its action and can still write once the action has ended
+        private static void Write(LogMessageBlock messages, LogMessage message)
+        {
+            lock (messages)
+            {
+                if (!messages.IsEnded)
+                {
+                    messages.Messages.Add(message);
+                    return;
+                }
+            }
+
+            Enqueue(message.Message, message.MessageType, message.Level, null);
+        }
+
+        private static LogEntry[] CreateEntries()
+        {
+            var result = new LogEntry[Capacity];
+
+            for (var i = 0; i < Capacity; i++)
+            {
+                result[i].Sequence = i;
+            }
+
+            return result;
+        }
+
+        // Multiple producers reserve a position with a compare exchange and publish the entry with its sequence number,
+        // when the buffer is full they wait for the writer instead of dropping messages
+        private static void Enqueue(string? message, LogMessageTypes messageType, int level, LogMessage[]? block)
+        {
+            var spinWait = new SpinWait();
+
+            while (true)
+            {
+                var position = Interlocked.Read(ref enqueuePosition);
+                ref var entry = ref entries[position & (Capacity - 1)];
+                var sequence = Volatile.Read(ref entry.Sequence);
+
+                if (sequence == position)
+                {
+                    if (Interlocked.CompareExchange(ref enqueuePosition, position + 1, position) == position)
+                    {
+                        entry.Message = message;
+                        entry.MessageType = messageType;
+                        entry.Level = level;
+                        entry.Block = block;
+                        Volatile.Write(ref entry.Sequence, position + 1);
+                        break;
+                    }
+                }
+
+                else if (sequence < position)
+                {
+                    // The message is dropped if nothing consumes the full buffer anymore
+                    if (!writerThread.IsAlive)
+                    {
+                        return;
+                    }
+
+                    wakeEvent.Set();
+                    spinWait.SpinOnce();
+                }
+            }
+
+            // The barrier orders the publication of the entry before the read of the flag, the writer does the opposite
+            Interlocked.MemoryBarrier();
+
+            if (Volatile.Read(ref isWriterWaiting) != 0)
+            {
+                wakeEvent.Set();
+            }
+        }
 
-            WriteMessage($"{message}.", LogMessageTypes.Warning);
+        private static bool HasPendingEntries()
+        {
+            var position = Volatile.Read(ref dequeuePosition);
+            return Volatile.Read(ref entries[position & (Capacity - 1)].Sequence) == position + 1;
+        }
+
+        private static void RunWriter()
+        {
+            while (true)
+            {
+                while (HasPendingEntries())
+                {
+                    var position = dequeuePosition;
+                    ref var entry = ref entries[position & (Capacity - 1)];
+
+                    // A message that cannot be written is dropped, the writer keeps consuming the queue so that
+                    // producers and Flush never wait for it
+                    try
+                    {
+                        if (entry.Block != null)
+                        {
+                            foreach (var message in entry.Block)
+                            {
+                                WriteToConsole(message.Message, message.MessageType, message.Level);
+                            }
+                        }
+
+                        else
+                        {
+                            WriteToConsole(entry.Message!, entry.MessageType, entry.Level);
+                        }
+                    }
+
+                    catch (Exception e)
+                    {
+                        Debug.WriteLine($"Logger: cannot write to the console: {e.Message}");
+                    }
+
+                    entry.Message = null;
+                    entry.Block = null;
+                    Volatile.Write(ref entry.Sequence, position + Capacity);
+                    Interlocked.Exchange(ref dequeuePosition, position + 1);
+                }
+
+                wakeEvent.Reset();
+                Interlocked.Exchange(ref isWriterWaiting, 1);
+
+                if (!HasPendingEntries())
+                {
+                    wakeEvent.Wait();
+                }
+
+                Interlocked.Exchange(ref isWriterWaiting, 0);
+            }
+        }
+
+        private static void WriteToConsole(string message, LogMessageTypes messageType, int level)
+        {
+            if ((messageType & LogMessageTypes.Success) != 0)
+            {
+                Console.ForegroundColor = ConsoleColor.Green;
+            }
+
+            else if ((messageType & LogMessageTypes.Action) != 0)
+            {
+                Console.ForegroundColor = ConsoleColor.Cyan;
+            }
+
+            else if ((messageType & LogMessageTypes.Warning) != 0)
+            {
+                Console.ForegroundColor = ConsoleColor.Yellow;
+            }
+
+            else if ((messageType & LogMessageTypes.Error) != 0)
+            {
+                Console.ForegroundColor = ConsoleColor.Red;
+            }
+
+            else if ((messageType & LogMessageTypes.Important) != 0)
+            {
+                Console.ForegroundColor = ConsoleColor.White;
+            }
+
+            Console.Write(new string(' ', level));
+            Console.WriteLine(message);
+            Debug.WriteLine(message);
+            Console.ForegroundColor = ConsoleColor.Gray;
         }
     }
-}
\ No newline at end of file
+}
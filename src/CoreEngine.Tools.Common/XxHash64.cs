@@ -0,0 +1,175 @@
+using System;
+using System.Buffers.Binary;
+using System.IO;
+using System.Numerics;
+
+namespace CoreEngine.Tools.Common
+{
+    // Implementation of the xxHash64 non-cryptographic hash (https://github.com/Cyan4973/xxHash)
+    public class XxHash64
+    {
+        private const ulong Prime1 = 11400714785074694791UL;
+        private const ulong Prime2 = 14029467366897019727UL;
+        private const ulong Prime3 = 1609587929392839161UL;
+        private const ulong Prime4 = 9650029242287828579UL;
+        private const ulong Prime5 = 2870177450012600261UL;
+        private const int StripeSize = 32;
+
+        private readonly ulong seed;
+        private readonly byte[] pendingData;
+        private int pendingLength;
+        private ulong accumulator1;
+        private ulong accumulator2;
+        private ulong accumulator3;
+        private ulong accumulator4;
+        private long totalLength;
+
+        public XxHash64(ulong seed = 0)
+        {
+            this.seed = seed;
+            this.pendingData = new byte[StripeSize];
+            Reset();
+        }
+
+        public static ulong Hash(ReadOnlySpan<byte> data, ulong seed = 0)
+        {
+            var hash = new XxHash64(seed);
+            hash.Append(data);
+            return hash.GetCurrentHash();
+        }
+
+        public static ulong HashFile(string path, ulong seed = 0)
+        {
+            var hash = new XxHash64(seed);
+            var buffer = new byte[81920];
+
+            using var stream = new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite, 1, FileOptions.SequentialScan);
+            int readLength;
+
+            while ((readLength = stream.Read(buffer, 0, buffer.Length)) > 0)
+            {
+                hash.Append(buffer.AsSpan(0, readLength));
+            }
+
+            return hash.GetCurrentHash();
+        }
+
+        public void Reset()
+        {
+            this.accumulator1 = unchecked(this.seed + Prime1 + Prime2);
+            this.accumulator2 = unchecked(this.seed + Prime2);
+            this.accumulator3 = this.seed;
+            this.accumulator4 = unchecked(this.seed - Prime1);
+            this.pendingLength = 0;
+            this.totalLength = 0;
+        }
+
+        public void Append(ReadOnlySpan<byte> data)
+        {
+            this.totalLength += data.Length;
+
+            if (this.pendingLength > 0)
+            {
+                var copyLength = Math.Min(StripeSize - this.pendingLength, data.Length);
+                data.Slice(0, copyLength).CopyTo(this.pendingData.AsSpan(this.pendingLength));
+
+                this.pendingLength += copyLength;
+                data = data.Slice(copyLength);
+
+                if (this.pendingLength < StripeSize)
+                {
+                    return;
+                }
+
+                ProcessStripe(this.pendingData);
+                this.pendingLength = 0;
+            }
+
+            while (data.Length >= StripeSize)
+            {
+                ProcessStripe(data);
+                data = data.Slice(StripeSize);
+            }
+
+            if (data.Length > 0)
+            {
+                data.CopyTo(this.pendingData);
+                this.pendingLength = data.Length;
+            }
+        }
+
+        public ulong GetCurrentHash()
+        {
+            ulong result;
+
+            if (this.totalLength >= StripeSize)
+            {
+                result = BitOperations.RotateLeft(this.accumulator1, 1) + BitOperations.RotateLeft(this.accumulator2, 7) +
+                         BitOperations.RotateLeft(this.accumulator3, 12) + BitOperations.RotateLeft(this.accumulator4, 18);
+
+                result = MergeRound(result, this.accumulator1);
+                result = MergeRound(result, this.accumulator2);
+                result = MergeRound(result, this.accumulator3);
+                result = MergeRound(result, this.accumulator4);
+            }
+
+            else
+            {
+                result = this.seed + Prime5;
+            }
+
+            result += (ulong)this.totalLength;
+
+            var remainingData = new ReadOnlySpan<byte>(this.pendingData, 0, this.pendingLength);
+
+            while (remainingData.Length >= 8)
+            {
+                result ^= Round(0, BinaryPrimitives.ReadUInt64LittleEndian(remainingData));
+                result = BitOperations.RotateLeft(result, 27) * Prime1 + Prime4;
+                remainingData = remainingData.Slice(8);
+            }
+
+            if (remainingData.Length >= 4)
+            {
+                result ^= BinaryPrimitives.ReadUInt32LittleEndian(remainingData) * Prime1;
+                result = BitOperations.RotateLeft(result, 23) * Prime2 + Prime3;
+                remainingData = remainingData.Slice(4);
+            }
+
+            for (var i = 0; i < remainingData.Length; i++)
+            {
+                result ^= remainingData[i] * Prime5;
+                result = BitOperations.RotateLeft(result, 11) * Prime1;
+            }
+
+            result ^= result >> 33;
+            result *= Prime2;
+            result ^= result >> 29;
+            result *= Prime3;
+            result ^= result >> 32;
+
+            return result;
+        }
+
+        private void ProcessStripe(ReadOnlySpan<byte> data)
+        {
+            this.accumulator1 = Round(this.accumulator1, BinaryPrimitives.ReadUInt64LittleEndian(data));
+            this.accumulator2 = Round(this.accumulator2, BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(8)));
+            this.accumulator3 = Round(this.accumulator3, BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(16)));
+            this.accumulator4 = Round(this.accumulator4, BinaryPrimitives.ReadUInt64LittleEndian(data.Slice(24)));
+        }
+
+        private static ulong Round(ulong accumulator, ulong input)
+        {
+            accumulator += input * Prime2;
+            accumulator = BitOperations.RotateLeft(accumulator, 31);
+            return accumulator * Prime1;
+        }
+
+        private static ulong MergeRound(ulong accumulator, ulong value)
+        {
+            accumulator ^= Round(0, value);
+            return accumulator * Prime1 + Prime4;
+        }
+    }
+}
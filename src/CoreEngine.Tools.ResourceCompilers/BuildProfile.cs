@@ -0,0 +1,11 @@
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    public enum BuildProfile
+    {
+        // Shipping quality outputs
+        Full,
+
+        // Faster and lower quality outputs for local iteration and watch mode
+        Iteration
+    }
+}
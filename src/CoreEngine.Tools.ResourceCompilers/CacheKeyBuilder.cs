@@ -0,0 +1,43 @@
+using System;
+using System.Buffers.Binary;
+using System.Text;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    // Two differently seeded 64-bit hashes give a 128-bit key which makes collisions negligible
+    public class CacheKeyBuilder
+    {
+        private readonly XxHash64 hash1 = new XxHash64(0);
+        private readonly XxHash64 hash2 = new XxHash64(0x9E3779B97F4A7C15UL);
+
+        public void AppendString(string value)
+        {
+            if (value == null)
+            {
+                throw new ArgumentNullException(nameof(value));
+            }
+
+            var data = Encoding.UTF8.GetBytes(value + "\0");
+            this.hash1.Append(data);
+            this.hash2.Append(data);
+        }
+
+        // The length is part of the key so that consecutive data cannot be split differently
+        public void AppendData(ReadOnlySpan<byte> data)
+        {
+            Span<byte> length = stackalloc byte[sizeof(long)];
+            BinaryPrimitives.WriteInt64LittleEndian(length, data.Length);
+
+            this.hash1.Append(length);
+            this.hash2.Append(length);
+            this.hash1.Append(data);
+            this.hash2.Append(data);
+        }
+
+        public string GetKey()
+        {
+            return $"{this.hash1.GetCurrentHash():x16}{this.hash2.GetCurrentHash():x16}";
+        }
+    }
+}
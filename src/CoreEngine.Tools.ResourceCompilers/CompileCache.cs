@@ -0,0 +1,368 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using System.Runtime.InteropServices;
+using System.Threading;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    public class CompileCache
+    {
+        private const string ManifestFilename = "entry";
+        private const int ManifestVersion = 1;
+
+        private long hitCount;
+        private long missCount;
+        private long restoredBytes;
+        private long storedBytes;
+
+        public CompileCache(string cacheDirectory, long maxSize, bool useHardLinks)
+        {
+            this.CacheDirectory = Path.GetFullPath(cacheDirectory);
+            this.MaxSize = maxSize;
+            this.UseHardLinks = useHardLinks;
+
+            if (!Directory.Exists(this.CacheDirectory))
+            {
+                Directory.CreateDirectory(this.CacheDirectory);
+            }
+        }
+
+        public string CacheDirectory { get; }
+        public long MaxSize { get; }
+        public bool UseHardLinks { get; }
+
+        // When disabled the cache is only populated, used to force a full rebuild
+        public bool IsRestoreEnabled { get; set; } = true;
+
+        public long HitCount => Interlocked.Read(ref this.hitCount);
+        public long MissCount => Interlocked.Read(ref this.missCount);
+        public long RestoredBytes => Interlocked.Read(ref this.restoredBytes);
+        public long StoredBytes => Interlocked.Read(ref this.storedBytes);
+
+        public string[]? TryRestore(string key, string outputDirectory)
+        {
+            var entryDirectory = GetEntryDirectory(key);
+            var manifestPath = Path.Combine(entryDirectory, ManifestFilename);
+
+            try
+            {
+                if (!this.IsRestoreEnabled || !File.Exists(manifestPath))
+                {
+                    Interlocked.Increment(ref this.missCount);
+                    return null;
+                }
+
+                var filenames = ReadManifest(manifestPath);
+                var result = new string[filenames.Length];
+                var entryBytes = 0L;
+
+                for (var i = 0; i < filenames.Length; i++)
+                {
+                    var outputPath = Path.Combine(outputDirectory, filenames[i]);
+                    var cachedFilePath = Path.Combine(entryDirectory, i.ToString(CultureInfo.InvariantCulture));
+
+                    var outputPathDirectory = Path.GetDirectoryName(outputPath);
+
+                    if (outputPathDirectory != null && !Directory.Exists(outputPathDirectory))
+                    {
+                        Directory.CreateDirectory(outputPathDirectory);
+                    }
+
+                    // The destination is removed first so that a hard link never shares its content with a stale output
+                    if (File.Exists(outputPath))
+                    {
+                        File.Delete(outputPath);
+                    }
+
+                    if (!this.UseHardLinks || !TryCreateHardLink(cachedFilePath, outputPath))
+                    {
+                        File.Copy(cachedFilePath, outputPath);
+                    }
+
+                    entryBytes += new FileInfo(cachedFilePath).Length;
+                    result[i] = outputPath;
+                }
+
+                // The manifest write time is used as the last access time for the LRU eviction
+                File.SetLastWriteTimeUtc(manifestPath, DateTime.UtcNow);
+
+                Interlocked.Increment(ref this.hitCount);
+                Interlocked.Add(ref this.restoredBytes, entryBytes);
+                return result;
+            }
+
+            catch (IOException)
+            {
+                // The entry may have been evicted by another build in the meantime
+                Interlocked.Increment(ref this.missCount);
+                return null;
+            }
+        }
+
+        public void Store(string key, IList<ResourceEntry> resourceEntries)
+        {
+            if (resourceEntries == null)
+            {
+                throw new ArgumentNullException(nameof(resourceEntries));
+            }
+
+            var filenames = new string[resourceEntries.Count];
+            var data = new ReadOnlyMemory<byte>[resourceEntries.Count];
+
+            for (var i = 0; i < resourceEntries.Count; i++)
+            {
+                filenames[i] = resourceEntries[i].Filename;
+                data[i] = resourceEntries[i].Data;
+            }
+
+            StoreEntry(key, filenames, data);
+        }
+
+        // Data entries hold intermediate results of the compilers (compiled shader variants for example), they are
+        // not counted in the hit and miss statistics of the source files
+        public byte[]? TryReadData(string key)
+        {
+            var entryDirectory = GetEntryDirectory(key);
+            var manifestPath = Path.Combine(entryDirectory, ManifestFilename);
+
+            try
+            {
+                if (!this.IsRestoreEnabled || !File.Exists(manifestPath))
+                {
+                    return null;
+                }
+
+                var result = File.ReadAllBytes(Path.Combine(entryDirectory, "0"));
+                File.SetLastWriteTimeUtc(manifestPath, DateTime.UtcNow);
+
+                Interlocked.Add(ref this.restoredBytes, result.Length);
+                return result;
+            }
+
+            catch (IOException)
+            {
+                return null;
+            }
+        }
+
+        public void StoreData(string key, ReadOnlyMemory<byte> data)
+        {
+            StoreEntry(key, new string[] { key }, new ReadOnlyMemory<byte>[] { data });
+        }
+
+        public void Trim()
+        {
+            var entries = new List<(string Path, DateTime LastAccessTime, long Size)>();
+            var totalSize = 0L;
+
+            foreach (var bucketDirectory in Directory.GetDirectories(this.CacheDirectory))
+            {
+                // Temporary directories left behind by interrupted builds
+                if (Path.GetExtension(bucketDirectory) == ".tmp")
+                {
+                    if (Directory.GetCreationTimeUtc(bucketDirectory) < DateTime.UtcNow.AddHours(-1))
+                    {
+                        Directory.Delete(bucketDirectory, true);
+                    }
+
+                    continue;
+                }
+
+                foreach (var entryDirectory in Directory.GetDirectories(bucketDirectory))
+                {
+                    var manifestPath = Path.Combine(entryDirectory, ManifestFilename);
+
+                    if (!File.Exists(manifestPath))
+                    {
+                        continue;
+                    }
+
+                    var size = 0L;
+
+                    foreach (var file in Directory.GetFiles(entryDirectory))
+                    {
+                        size += new FileInfo(file).Length;
+                    }
+
+                    entries.Add((entryDirectory, File.GetLastWriteTimeUtc(manifestPath), size));
+                    totalSize += size;
+                }
+            }
+
+            if (totalSize <= this.MaxSize)
+            {
+                return;
+            }
+
+            entries.Sort((item1, item2) => item1.LastAccessTime.CompareTo(item2.LastAccessTime));
+
+            foreach (var entry in entries)
+            {
+                if (totalSize <= this.MaxSize)
+                {
+                    break;
+                }
+
+                try
+                {
+                    Directory.Delete(entry.Path, true);
+                    totalSize -= entry.Size;
+                }
+
+                catch (IOException)
+                {
+                    Logger.WriteMessage($"Cannot evict cache entry '{entry.Path}'.", LogMessageTypes.Debug);
+                }
+            }
+        }
+
+        public static string ComputeKey(IEnumerable<string> compilerIdentifiers, ReadOnlySpan<byte> sourceData, CompilerContext context)
+        {
+            if (compilerIdentifiers == null)
+            {
+                throw new ArgumentNullException(nameof(compilerIdentifiers));
+            }
+
+            if (context == null)
+            {
+                throw new ArgumentNullException(nameof(context));
+            }
+
+            var keyBuilder = new CacheKeyBuilder();
+
+            foreach (var compilerIdentifier in compilerIdentifiers)
+            {
+                keyBuilder.AppendString(compilerIdentifier);
+            }
+
+            keyBuilder.AppendString(context.TargetPlatform);
+            keyBuilder.AppendString(context.SourceFilename);
+            keyBuilder.AppendString(context.BuildProfile.ToString());
+            keyBuilder.AppendString(context.UseMaterialTables.ToString());
+
+            // Compilers write paths relative to the root output directory (material textures for example)
+            keyBuilder.AppendString(Path.GetRelativePath(context.RootOutputDirectory, context.OutputDirectory ?? context.RootOutputDirectory));
+            keyBuilder.AppendData(sourceData);
+
+            foreach (var dependency in context.Dependencies)
+            {
+                keyBuilder.AppendString(Path.GetFileName(dependency));
+                keyBuilder.AppendData(File.Exists(dependency) ? File.ReadAllBytes(dependency) : Array.Empty<byte>());
+            }
+
+            return keyBuilder.GetKey();
+        }
+
+        private void StoreEntry(string key, IList<string> filenames, IList<ReadOnlyMemory<byte>> data)
+        {
+            var entryDirectory = GetEntryDirectory(key);
+
+            if (Directory.Exists(entryDirectory))
+            {
+                return;
+            }
+
+            // Entries are written to a temporary directory and renamed so readers never see a partial entry
+            var temporaryDirectory = Path.Combine(this.CacheDirectory, $"{key}.{Guid.NewGuid():N}.tmp");
+            var entryBytes = 0L;
+
+            try
+            {
+                Directory.CreateDirectory(temporaryDirectory);
+
+                for (var i = 0; i < data.Count; i++)
+                {
+                    using var stream = new FileStream(Path.Combine(temporaryDirectory, i.ToString(CultureInfo.InvariantCulture)), FileMode.CreateNew);
+                    stream.Write(data[i].Span);
+                    entryBytes += data[i].Length;
+                }
+
+                WriteManifest(Path.Combine(temporaryDirectory, ManifestFilename), filenames);
+
+                Directory.CreateDirectory(Path.GetDirectoryName(entryDirectory));
+                Directory.Move(temporaryDirectory, entryDirectory);
+
+                Interlocked.Add(ref this.storedBytes, entryBytes);
+            }
+
+            catch (Exception e) when (e is IOException || e is UnauthorizedAccessException)
+            {
+                // Another build has stored the same entry first
+                if (Directory.Exists(temporaryDirectory))
+                {
+                    Directory.Delete(temporaryDirectory, true);
+                }
+            }
+        }
+
+        private string GetEntryDirectory(string key)
+        {
+            return Path.Combine(this.CacheDirectory, key.Substring(0, 2), key);
+        }
+
+        private static string[] ReadManifest(string path)
+        {
+            using var reader = new BinaryReader(new FileStream(path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite));
+
+            if (reader.ReadInt32() != ManifestVersion)
+            {
+                throw new IOException("Unsupported cache entry version.");
+            }
+
+            var count = reader.ReadInt32();
+            var result = new string[count];
+
+            for (var i = 0; i < count; i++)
+            {
+                result[i] = reader.ReadString();
+            }
+
+            return result;
+        }
+
+        private static void WriteManifest(string path, IList<string> filenames)
+        {
+            using var writer = new BinaryWriter(new FileStream(path, FileMode.CreateNew));
+
+            writer.Write(ManifestVersion);
+            writer.Write(filenames.Count);
+
+            foreach (var filename in filenames)
+            {
+                writer.Write(filename);
+            }
+        }
+
+        private static bool TryCreateHardLink(string existingPath, string linkPath)
+        {
+            try
+            {
+                if (RuntimeInformation.IsOSPlatform(OSPlatform.Windows))
+                {
+                    return CreateHardLink(linkPath, existingPath, IntPtr.Zero);
+                }
+
+                return link(existingPath, linkPath) == 0;
+            }
+
+            catch (EntryPointNotFoundException)
+            {
+                return false;
+            }
+
+            catch (DllNotFoundException)
+            {
+                return false;
+            }
+        }
+
+        [DllImport("kernel32.dll", CharSet = CharSet.Unicode, SetLastError = true)]
+        private static extern bool CreateHardLink(string lpFileName, string lpExistingFileName, IntPtr lpSecurityAttributes);
+
+        [DllImport("libc", SetLastError = true)]
+        private static extern int link(string oldpath, string newpath);
+    }
+}
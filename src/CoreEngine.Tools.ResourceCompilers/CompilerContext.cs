@@ -1,4 +1,5 @@
 using System;
+using System.Collections.Generic;
 
 namespace CoreEngine.Tools.ResourceCompilers
 {
@@ -11,6 +12,8 @@ namespace CoreEngine.Tools.ResourceCompilers
             this.InputDirectory = inputDirectory;
             this.OutputDirectory = outputDirectory;
             this.RootOutputDirectory = rootOutputDirectory;
+            this.Dependencies = Array.Empty<string>();
+            this.BuildProfile = BuildProfile.Full;
         }
 
         public string TargetPlatform
@@ -37,5 +40,31 @@ namespace CoreEngine.Tools.ResourceCompilers
         {
             get;
         }
+
+        public IList<string> Dependencies
+        {
+            get;
+            set;
+        }
+
+        public BuildProfile BuildProfile
+        {
+            get;
+            set;
+        }
+
+        // Sources with several materials are compiled to one material table instead of one file per material
+        public bool UseMaterialTables
+        {
+            get;
+            set;
+        }
+
+        // Compilers can keep intermediate results in the compile cache (compiled shader variants for example)
+        public CompileCache? Cache
+        {
+            get;
+            set;
+        }
     }
 }
\ No newline at end of file
@@ -23,11 +23,11 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
             this.filename = filename;
         }
    
-        public Span<MaterialDescription> Read(ReadOnlySpan<byte> sourceData, CompilerContext context)
+        public Span<MaterialDescription> Read(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             var materialDescription = new MaterialDescription(this.filename);
             
-            using var reader = new StreamReader(new MemoryStream(sourceData.ToArray()));
+            using var reader = new StreamReader(new ReadOnlyMemoryStream(sourceData));
             var yaml = new YamlStream();
             yaml.Load(reader);
 
@@ -64,13 +64,13 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
                 foreach (var node in children)
                 {
                     var nodeKey = ((YamlScalarNode)node.Key).Value;
-                    Logger.WriteMessage($"{node.Key} - {node.Value} ({node.Value.NodeType})", LogMessageTypes.Debug);
+                    Logger.WriteMessage(LogMessageTypes.Debug, "{0} - {1} ({2})", node.Key, node.Value, node.Value.NodeType);
 
                     if (node.Value.NodeType == YamlNodeType.Scalar)
                     {
                         var scalarNode = (YamlScalarNode)node.Value;
 
-                        Logger.WriteMessage($"Scalar node style: {scalarNode.Style}");
+                        Logger.WriteMessage(LogMessageTypes.Debug, "Scalar node style: {0}", scalarNode.Style);
 
                         if (scalarNode.Style == ScalarStyle.Plain)
                         {
@@ -11,13 +11,13 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
 {
     public class FbxMaterialDataReader : IMaterialDataReader
     {
-        public Span<MaterialDescription> Read(ReadOnlySpan<byte> sourceData, CompilerContext context)
+        public Span<MaterialDescription> Read(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             var materials = new List<MaterialDescription>();
 
-            using var memoryStream = new MemoryStream(sourceData.ToArray());
+            using var sourceStream = new ReadOnlyMemoryStream(sourceData);
             using AssimpContext importer = new AssimpContext();
-            var scene = importer.ImportFileFromStream(memoryStream);
+            var scene = importer.ImportFileFromStream(sourceStream);
 
             foreach (var fbxMaterial in scene.Materials)
             {
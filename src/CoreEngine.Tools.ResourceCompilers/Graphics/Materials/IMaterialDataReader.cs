@@ -4,6 +4,6 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
 {
     public interface IMaterialDataReader
     {
-        Span<MaterialDescription> Read(ReadOnlySpan<byte> sourceData, CompilerContext context);
+        Span<MaterialDescription> Read(ReadOnlyMemory<byte> sourceData, CompilerContext context);
     }
 }
\ No newline at end of file
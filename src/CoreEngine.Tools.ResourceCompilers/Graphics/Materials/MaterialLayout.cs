@@ -0,0 +1,151 @@
+using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
+{
+    public enum MaterialFieldType
+    {
+        Float,
+        Float4,
+
+        // 1-based index in the texture list of the material, 0 when the material has no texture for the slot
+        TextureIndex
+    }
+
+    public readonly struct MaterialField
+    {
+        public MaterialField(string name, MaterialFieldType type, int offset)
+        {
+            this.Name = name;
+            this.Type = type;
+            this.Offset = offset;
+        }
+
+        public string Name { get; }
+        public MaterialFieldType Type { get; }
+        public int Offset { get; }
+
+        public int Size
+        {
+            get
+            {
+                return (this.Type == MaterialFieldType.Float4) ? 4 * sizeof(float) : sizeof(int);
+            }
+        }
+    }
+
+    // Constant layout of a material shader struct. Fields are packed with a 4 byte alignment (packed_float4 in Metal)
+    // so that a compiled material is copied as it is in the material buffers.
+    public class MaterialLayout
+    {
+        private readonly Dictionary<string, MaterialField> fieldsByName = new Dictionary<string, MaterialField>(StringComparer.Ordinal);
+
+        public MaterialLayout(string name, IList<(string Name, MaterialFieldType Type)> fields)
+        {
+            if (fields == null)
+            {
+                throw new ArgumentNullException(nameof(fields));
+            }
+
+            this.Name = name;
+
+            var offset = 0;
+            var result = new MaterialField[fields.Count];
+
+            for (var i = 0; i < fields.Count; i++)
+            {
+                result[i] = new MaterialField(fields[i].Name, fields[i].Type, offset);
+                this.fieldsByName.Add(result[i].Name, result[i]);
+                offset += result[i].Size;
+            }
+
+            this.Fields = result;
+            this.Size = offset;
+        }
+
+        // Must match struct SimpleMaterial in Shaders/Materials/SimpleMaterial.h
+        public static MaterialLayout SimpleMaterial { get; } = new MaterialLayout("SimpleMaterial", new (string, MaterialFieldType)[]
+        {
+            ("DiffuseColor", MaterialFieldType.Float4),
+            ("DiffuseTexture", MaterialFieldType.TextureIndex),
+            ("NormalTexture", MaterialFieldType.TextureIndex),
+            ("BumpTexture", MaterialFieldType.TextureIndex),
+            ("SpecularColor", MaterialFieldType.Float4),
+            ("SpecularTexture", MaterialFieldType.TextureIndex)
+        });
+
+        public string Name { get; }
+        public IList<MaterialField> Fields { get; }
+        public int Size { get; }
+
+        // Properties are matched by name so their order in the source doesn't matter, missing properties are zero.
+        // Texture paths are added to the texture list and the slot gets their 1-based index in the list.
+        public void Write(MaterialDescription material, Span<byte> destination, IList<string> textures)
+        {
+            if (material == null)
+            {
+                throw new ArgumentNullException(nameof(material));
+            }
+
+            if (textures == null)
+            {
+                throw new ArgumentNullException(nameof(textures));
+            }
+
+            if (destination.Length < this.Size)
+            {
+                throw new ArgumentException("The destination is smaller than the material layout.", nameof(destination));
+            }
+
+            destination.Slice(0, this.Size).Clear();
+
+            foreach (var property in material.Properties)
+            {
+                if (!this.fieldsByName.TryGetValue(property.Name, out var field))
+                {
+                    Logger.WriteMessage($"Material {material.Name}: property {property.Name} is not part of {this.Name}, it is ignored.", LogMessageTypes.Warning);
+                    continue;
+                }
+
+                var fieldData = destination.Slice(field.Offset, field.Size);
+
+                if (field.Type == MaterialFieldType.TextureIndex && property.Value is string texturePath)
+                {
+                    if (!string.IsNullOrEmpty(texturePath))
+                    {
+                        var textureIndex = textures.IndexOf(texturePath);
+
+                        if (textureIndex < 0)
+                        {
+                            textureIndex = textures.Count;
+                            textures.Add(texturePath);
+                        }
+
+                        BinaryPrimitives.WriteInt32LittleEndian(fieldData, textureIndex + 1);
+                    }
+                }
+
+                else if (field.Type == MaterialFieldType.Float && property.Value is float floatValue)
+                {
+                    BinaryPrimitives.WriteInt32LittleEndian(fieldData, BitConverter.SingleToInt32Bits(floatValue));
+                }
+
+                else if (field.Type == MaterialFieldType.Float4 && property.Value is float[] floatArray && floatArray.Length <= 4)
+                {
+                    for (var i = 0; i < floatArray.Length; i++)
+                    {
+                        BinaryPrimitives.WriteInt32LittleEndian(fieldData.Slice(i * sizeof(float)), BitConverter.SingleToInt32Bits(floatArray[i]));
+                    }
+                }
+
+                else
+                {
+                    throw new InvalidDataException($"Material {material.Name}: property {property.Name} doesn't match the {field.Type} field of {this.Name}.");
+                }
+            }
+        }
+    }
+}
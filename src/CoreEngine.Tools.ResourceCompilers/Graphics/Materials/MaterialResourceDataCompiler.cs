@@ -1,4 +1,5 @@
 using System;
+using System.Buffers;
 using System.Collections.Generic;
 using System.Globalization;
 using System.IO;
@@ -14,20 +15,11 @@ using YamlDotNet.Serialization.NamingConventions;
 
 namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
 {
-    readonly struct TextureEntry
-    {
-        public TextureEntry(int offset, string resourcePath)
-        {
-            this.Offset = offset;
-            this.ResourcePath = resourcePath;
-        }
-
-        public readonly int Offset { get; }
-        public readonly string ResourcePath { get; }
-    }
-
     public class MaterialResourceDataCompiler : ResourceDataCompiler
     {
+        // Materials are written in the constant layout of the material shader so that the runtime copies them as they are
+        private static readonly MaterialLayout materialLayout = MaterialLayout.SimpleMaterial;
+
         public MaterialResourceDataCompiler()
         {
 
@@ -64,7 +56,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
                 throw new ArgumentNullException(nameof(context));
             }
 
-            var version = 1;
+            var version = 2;
 
             IMaterialDataReader materialDataReader;
 
@@ -83,20 +75,30 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
                 materialDataReader = new CoreEngineMaterialDataReader(Path.GetFileNameWithoutExtension(context.SourceFilename));
             }
 
-            var materials = materialDataReader.Read(sourceData.Span, context);
+            var materials = materialDataReader.Read(sourceData, context);
             Logger.WriteMessage($"Materials Count: {materials.Length}");
 
+            if (context.UseMaterialTables && materials.Length > 1)
+            {
+                var tableEntry = WriteMaterialTable(materials, $"{Path.GetFileNameWithoutExtension(context.SourceFilename)}.materials");
+                return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { tableEntry }));
+            }
+
             var resourceEntries = new ResourceEntry[materials.Length];
 
             for (var i = 0; i < materials.Length; i++)
             {
                 var material = materials[i];
-                
-                Logger.WriteMessage($"Material Property Count: {material.Properties.Count}", LogMessageTypes.Debug);
 
-                var destinationMemoryStream = new MemoryStream();
+                Logger.WriteMessage(LogMessageTypes.Debug, "Material Property Count: {0}", material.Properties.Count);
 
-                using var streamWriter = new BinaryWriter(destinationMemoryStream);
+                var textures = new List<string>();
+                var materialData = new byte[materialLayout.Size];
+                materialLayout.Write(material, materialData, textures);
+
+                var destinationBuffer = new PooledBufferWriter();
+
+                using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
                 streamWriter.Write(new char[] { 'M', 'A', 'T', 'E', 'R', 'I', 'A', 'L'});
                 streamWriter.Write(version);
 
@@ -105,77 +107,101 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
                 Logger.WriteMessage($"Is Transparent: {material.IsTransparent}");
                 streamWriter.Write(material.IsTransparent);
 
-                var textureResourceList = new List<TextureEntry>();
-                
-                var materialDataMemoryStream = new MemoryStream();
-                using var materialDataStreamWriter = new BinaryWriter(materialDataMemoryStream);
-
-                foreach (var property in material.Properties)
-                {
-                    if (property.Value.GetType() == typeof(string))
-                    {
-                        var stringValue = (string)property.Value;
-                        
-                        if (!string.IsNullOrEmpty(stringValue))
-                        {
-                            textureResourceList.Add(new TextureEntry((int)materialDataStreamWriter.BaseStream.Position, stringValue));
-                        }
-
-                        materialDataStreamWriter.Write(-1);
-                    }
-
-                    else if (property.Value.GetType() == typeof(bool))
-                    {
-                        materialDataStreamWriter.Write((bool)property.Value);
-                    }
-
-                    else if (property.Value.GetType() == typeof(float))
-                    {
-                        materialDataStreamWriter.Write((float)property.Value);
-                    }
-
-                    else if (property.Value.GetType() == typeof(float[]))
-                    {
-                        var floatArray = (float[])property.Value;
-
-                        foreach (var floatValue in floatArray)
-                        {
-                            materialDataStreamWriter.Write(floatValue);
-                        }
-                    }
-                }
+                // The texture slots of the material data are 1-based indices in this list
+                streamWriter.Write(textures.Count);
 
-                var materialData = materialDataMemoryStream.ToArray();
-                
-                streamWriter.Write(textureResourceList.Count);
-                
-                for (var j = 0; j < textureResourceList.Count; j++)
+                foreach (var texture in textures)
                 {
-                    var textureResource = textureResourceList[j];
-
-                    streamWriter.Write(textureResource.Offset);
-                    streamWriter.Write(textureResource.ResourcePath);
-
-                    var textureIndex = j + 1;
-
-                    MemoryMarshal.Write(materialData.AsSpan().Slice(textureResource.Offset), ref textureIndex);
+                    streamWriter.Write(texture);
                 }
 
                 streamWriter.Write(materialData.Length);
                 streamWriter.Write(materialData);
 
                 Logger.EndAction();
-                
+
                 streamWriter.Flush();
-                destinationMemoryStream.Flush();
 
-                var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-                var resourceEntry = new ResourceEntry($"{material.Name}{this.DestinationExtension}", resourceData);
+                var resourceEntry = new ResourceEntry($"{material.Name}{this.DestinationExtension}", destinationBuffer);
 
                 resourceEntries[i] = resourceEntry;
             }
 
             return Task.FromResult<ReadOnlyMemory<ResourceEntry>>(resourceEntries);
         }
+
+        // All the materials of a source in one file: the material data is one buffer of fixed size records that is
+        // copied as it is in the material buffers. Identical materials share their record and the texture slots are
+        // 1-based indices in the texture list of the table.
+        private static ResourceEntry WriteMaterialTable(Span<MaterialDescription> materials, string tableName)
+        {
+            var tableVersion = 1;
+            var textures = new List<string>();
+            var recordIndices = new Dictionary<string, int>(StringComparer.Ordinal);
+            var materialRecords = new int[materials.Length];
+            var transparentFlags = new List<bool>();
+
+            using var recordBuffer = new PooledBufferWriter(materials.Length * materialLayout.Size);
+            var materialData = new byte[materialLayout.Size];
+
+            for (var i = 0; i < materials.Length; i++)
+            {
+                materialLayout.Write(materials[i], materialData, textures);
+
+                var keyBuilder = new CacheKeyBuilder();
+                keyBuilder.AppendData(materialData);
+                keyBuilder.AppendString(materials[i].IsTransparent.ToString());
+                var recordKey = keyBuilder.GetKey();
+
+                if (!recordIndices.TryGetValue(recordKey, out var recordIndex))
+                {
+                    recordIndex = transparentFlags.Count;
+                    recordIndices.Add(recordKey, recordIndex);
+                    transparentFlags.Add(materials[i].IsTransparent);
+                    recordBuffer.Write(materialData);
+                }
+
+                materialRecords[i] = recordIndex;
+            }
+
+            Logger.WriteMessage($"Material table {tableName}: {materials.Length} materials, {transparentFlags.Count} unique, {textures.Count} textures");
+
+            var destinationBuffer = new PooledBufferWriter(recordBuffer.WrittenCount + 1024);
+
+            using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
+            streamWriter.Write(new char[] { 'M', 'A', 'T', 'E', 'R', 'I', 'A', 'L', 'S' });
+            streamWriter.Write(tableVersion);
+
+            streamWriter.Write(textures.Count);
+
+            foreach (var texture in textures)
+            {
+                streamWriter.Write(texture);
+            }
+
+            streamWriter.Write(transparentFlags.Count);
+
+            foreach (var isTransparent in transparentFlags)
+            {
+                streamWriter.Write(isTransparent);
+            }
+
+            // Meshes reference the materials by name, each name maps to its record
+            streamWriter.Write(materials.Length);
+
+            for (var i = 0; i < materials.Length; i++)
+            {
+                streamWriter.Write($"{materials[i].Name}.material");
+                streamWriter.Write(materialRecords[i]);
+            }
+
+            streamWriter.Write(materialLayout.Size);
+            streamWriter.Write(recordBuffer.WrittenCount);
+            streamWriter.Write(recordBuffer.WrittenMemory.Span);
+
+            streamWriter.Flush();
+
+            return new ResourceEntry(tableName, destinationBuffer);
+        }
     }
-}
\ No newline at end of file
+}
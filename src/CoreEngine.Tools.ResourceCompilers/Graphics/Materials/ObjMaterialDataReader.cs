@@ -16,7 +16,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
 
         }
    
-        public Span<MaterialDescription> Read(ReadOnlySpan<byte> sourceData, CompilerContext context)
+        public Span<MaterialDescription> Read(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             if (context == null)
             {
@@ -32,7 +32,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
             var currentBumpTexture = string.Empty;
             var currentSpecularTexture = string.Empty;
             
-            using var reader = new StreamReader(new MemoryStream(sourceData.ToArray()));
+            using var reader = new StreamReader(new ReadOnlyMemoryStream(sourceData));
             
             while (!reader.EndOfStream)
             {
@@ -132,9 +132,9 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Materials
 
             var outputTexturePath = $"{inputDirectory.Replace(rootDirectory, string.Empty)}/{Path.GetFileNameWithoutExtension(texturePath)}.texture";
 
-            Logger.WriteMessage(rootDirectory);
-            Logger.WriteMessage(inputDirectory);
-            Logger.WriteMessage(outputTexturePath);
+            Logger.WriteMessage(rootDirectory, LogMessageTypes.Debug);
+            Logger.WriteMessage(inputDirectory, LogMessageTypes.Debug);
+            Logger.WriteMessage(outputTexturePath, LogMessageTypes.Debug);
             return outputTexturePath;
         }
     }
@@ -21,9 +21,9 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
         {
             var result = new MeshData();
 
-            using var memoryStream = new MemoryStream(sourceData.ToArray());
+            using var sourceStream = new ReadOnlyMemoryStream(sourceData);
             using AssimpContext importer = new AssimpContext();
-            var scene = importer.ImportFileFromStream(memoryStream, PostProcessSteps.ImproveCacheLocality | 
+            var scene = importer.ImportFileFromStream(sourceStream, PostProcessSteps.ImproveCacheLocality | 
                                                                     // PostProcessSteps.OptimizeGraph | 
                                                                     // PostProcessSteps.OptimizeMeshes | 
                                                                     //PostProcessSteps.PreTransformVertices | 
@@ -0,0 +1,395 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    // Builds a bounding volume hierarchy over the meshlets of a mesh so that culling can be done hierarchically.
+    // A surface area heuristic tree is built over the meshlets of each sub object and those trees are then
+    // joined by a tree built over the sub objects, so that a leaf never references meshlets of two sub objects.
+    // The trees of the instanced sub objects are stored after the mesh tree without being joined to it because
+    // their geometry is placed by the instance matrices.
+    public static class MeshBvhBuilder
+    {
+        public const int MaxLeafMeshletCount = 4;
+
+        private const int BinCount = 16;
+
+        // Cost of visiting an inner node relative to the cost of testing one meshlet
+        private const float TraversalCost = 1.0f;
+
+        private class BuildNode
+        {
+            public Vector3 MinPoint { get; set; }
+            public Vector3 MaxPoint { get; set; }
+            public BuildNode? Left { get; set; }
+            public BuildNode? Right { get; set; }
+            public int FirstPrimitive { get; set; }
+            public int PrimitiveCount { get; set; }
+        }
+
+        public static void BuildBvh(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            meshData.BvhNodes.Clear();
+            meshData.BvhRootIndex = -1;
+
+            var subObjectRoots = new List<BuildNode>();
+            var instancedSubObjectRoots = new List<BuildNode>();
+            var rootSubObjects = new Dictionary<BuildNode, MeshSubObject>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                subObject.BvhRootIndex = -1;
+
+                if (subObject.MeshletCount > 0)
+                {
+                    var subObjectRoot = BuildSubObjectBvh(meshData, subObject);
+                    rootSubObjects.Add(subObjectRoot, subObject);
+
+                    if (subObject.Instances.Count > 0)
+                    {
+                        instancedSubObjectRoots.Add(subObjectRoot);
+                    }
+
+                    else
+                    {
+                        subObjectRoots.Add(subObjectRoot);
+                    }
+                }
+            }
+
+            if (subObjectRoots.Count > 0)
+            {
+                meshData.BvhRootIndex = meshData.BvhNodes.Count;
+                meshData.BvhNodes.Add(new BvhNode());
+                FlattenNode(meshData.BvhNodes, meshData.BvhRootIndex, BuildMeshTree(subObjectRoots), rootSubObjects);
+            }
+
+            foreach (var subObjectRoot in instancedSubObjectRoots)
+            {
+                var nodeIndex = meshData.BvhNodes.Count;
+                meshData.BvhNodes.Add(new BvhNode());
+                FlattenNode(meshData.BvhNodes, nodeIndex, subObjectRoot, rootSubObjects);
+            }
+        }
+
+        private static BuildNode BuildMeshTree(List<BuildNode> subObjectRoots)
+        {
+            var minPoints = new Vector3[subObjectRoots.Count];
+            var maxPoints = new Vector3[subObjectRoots.Count];
+            var order = new int[subObjectRoots.Count];
+
+            for (var i = 0; i < subObjectRoots.Count; i++)
+            {
+                minPoints[i] = subObjectRoots[i].MinPoint;
+                maxPoints[i] = subObjectRoots[i].MaxPoint;
+                order[i] = i;
+            }
+
+            var rootNode = BuildTree(minPoints, maxPoints, order, 0, order.Length, 1);
+            return ReplaceLeaves(rootNode, subObjectRoots, order);
+        }
+
+        private static BuildNode BuildSubObjectBvh(MeshData meshData, MeshSubObject subObject)
+        {
+            var meshletOffset = (int)subObject.MeshletOffset;
+            var meshletCount = (int)subObject.MeshletCount;
+
+            var minPoints = new Vector3[meshletCount];
+            var maxPoints = new Vector3[meshletCount];
+            var order = new int[meshletCount];
+
+            for (var i = 0; i < meshletCount; i++)
+            {
+                var meshlet = meshData.Meshlets[meshletOffset + i];
+                var minPoint = new Vector3(float.MaxValue);
+                var maxPoint = new Vector3(float.MinValue);
+
+                for (var j = 0; j < meshlet.VertexCount; j++)
+                {
+                    var position = meshData.Vertices[(int)meshData.MeshletVertexIndices[(int)meshlet.VertexOffset + j]].Position;
+
+                    minPoint = Vector3.Min(minPoint, position);
+                    maxPoint = Vector3.Max(maxPoint, position);
+                }
+
+                minPoints[i] = minPoint;
+                maxPoints[i] = maxPoint;
+                order[i] = i;
+            }
+
+            var result = BuildTree(minPoints, maxPoints, order, 0, meshletCount, MaxLeafMeshletCount);
+
+            // Meshlets are reordered so that each leaf references a contiguous range, the index buffer
+            // of the sub object is rewritten to keep it in meshlet order
+            var meshlets = meshData.Meshlets.GetRange(meshletOffset, meshletCount);
+            var outputIndex = (int)subObject.StartIndex;
+
+            for (var i = 0; i < meshletCount; i++)
+            {
+                var meshlet = meshlets[order[i]];
+                meshData.Meshlets[meshletOffset + i] = meshlet;
+
+                for (var j = 0; j < meshlet.TriangleCount; j++)
+                {
+                    var packedTriangle = meshData.MeshletTriangleIndices[(int)meshlet.TriangleOffset + j];
+
+                    for (var k = 0; k < 3; k++)
+                    {
+                        var localIndex = (packedTriangle >> (k * 8)) & 0xFF;
+                        meshData.Indices[outputIndex++] = meshData.MeshletVertexIndices[(int)(meshlet.VertexOffset + localIndex)];
+                    }
+                }
+            }
+
+            OffsetLeaves(result, meshletOffset);
+            return result;
+        }
+
+        private static BuildNode BuildTree(Vector3[] minPoints, Vector3[] maxPoints, int[] order, int start, int count, int maxLeafSize)
+        {
+            var result = new BuildNode();
+
+            var minPoint = new Vector3(float.MaxValue);
+            var maxPoint = new Vector3(float.MinValue);
+            var minCentroid = new Vector3(float.MaxValue);
+            var maxCentroid = new Vector3(float.MinValue);
+
+            for (var i = start; i < start + count; i++)
+            {
+                var primitive = order[i];
+                var centroid = (minPoints[primitive] + maxPoints[primitive]) * 0.5f;
+
+                minPoint = Vector3.Min(minPoint, minPoints[primitive]);
+                maxPoint = Vector3.Max(maxPoint, maxPoints[primitive]);
+                minCentroid = Vector3.Min(minCentroid, centroid);
+                maxCentroid = Vector3.Max(maxCentroid, centroid);
+            }
+
+            result.MinPoint = minPoint;
+            result.MaxPoint = maxPoint;
+            result.FirstPrimitive = start;
+            result.PrimitiveCount = count;
+
+            if (count == 1)
+            {
+                return result;
+            }
+
+            var (splitAxis, splitBin, splitCost) = FindBestSplit(minPoints, maxPoints, order, start, count, minCentroid, maxCentroid);
+            var middle = start + count / 2;
+
+            if (splitAxis >= 0)
+            {
+                var leafCost = (float)count;
+                splitCost = TraversalCost + splitCost / SurfaceArea(minPoint, maxPoint);
+
+                if (count <= maxLeafSize && leafCost <= splitCost)
+                {
+                    return result;
+                }
+
+                middle = Partition(minPoints, maxPoints, order, start, count, splitAxis, splitBin, minCentroid, maxCentroid);
+            }
+
+            // All the centroids are at the same position so the primitives are split in two halves if they don't fit in a leaf
+            else if (count <= maxLeafSize)
+            {
+                return result;
+            }
+
+            result.Left = BuildTree(minPoints, maxPoints, order, start, middle - start, maxLeafSize);
+            result.Right = BuildTree(minPoints, maxPoints, order, middle, start + count - middle, maxLeafSize);
+            result.PrimitiveCount = 0;
+
+            return result;
+        }
+
+        private static (int Axis, int Bin, float Cost) FindBestSplit(Vector3[] minPoints, Vector3[] maxPoints, int[] order, int start, int count, Vector3 minCentroid, Vector3 maxCentroid)
+        {
+            var bestAxis = -1;
+            var bestBin = -1;
+            var bestCost = float.MaxValue;
+
+            var binCounts = new int[BinCount];
+            var binMinPoints = new Vector3[BinCount];
+            var binMaxPoints = new Vector3[BinCount];
+            var rightCosts = new float[BinCount];
+
+            for (var axis = 0; axis < 3; axis++)
+            {
+                var axisMin = GetComponent(minCentroid, axis);
+                var axisExtent = GetComponent(maxCentroid, axis) - axisMin;
+
+                if (axisExtent <= 0.0f)
+                {
+                    continue;
+                }
+
+                Array.Clear(binCounts, 0, BinCount);
+                Array.Fill(binMinPoints, new Vector3(float.MaxValue));
+                Array.Fill(binMaxPoints, new Vector3(float.MinValue));
+
+                for (var i = start; i < start + count; i++)
+                {
+                    var primitive = order[i];
+                    var bin = ComputeBin(minPoints[primitive], maxPoints[primitive], axis, axisMin, axisExtent);
+
+                    binCounts[bin]++;
+                    binMinPoints[bin] = Vector3.Min(binMinPoints[bin], minPoints[primitive]);
+                    binMaxPoints[bin] = Vector3.Max(binMaxPoints[bin], maxPoints[primitive]);
+                }
+
+                // Sweep from the right to store the cost of the primitives above each split plane
+                var rightCount = 0;
+                var rightMinPoint = new Vector3(float.MaxValue);
+                var rightMaxPoint = new Vector3(float.MinValue);
+
+                for (var bin = BinCount - 1; bin > 0; bin--)
+                {
+                    rightCount += binCounts[bin];
+                    rightMinPoint = Vector3.Min(rightMinPoint, binMinPoints[bin]);
+                    rightMaxPoint = Vector3.Max(rightMaxPoint, binMaxPoints[bin]);
+                    rightCosts[bin] = (rightCount > 0) ? rightCount * SurfaceArea(rightMinPoint, rightMaxPoint) : float.MaxValue;
+                }
+
+                var leftCount = 0;
+                var leftMinPoint = new Vector3(float.MaxValue);
+                var leftMaxPoint = new Vector3(float.MinValue);
+
+                for (var bin = 0; bin < BinCount - 1; bin++)
+                {
+                    leftCount += binCounts[bin];
+                    leftMinPoint = Vector3.Min(leftMinPoint, binMinPoints[bin]);
+                    leftMaxPoint = Vector3.Max(leftMaxPoint, binMaxPoints[bin]);
+
+                    if (leftCount == 0 || leftCount == count)
+                    {
+                        continue;
+                    }
+
+                    var cost = leftCount * SurfaceArea(leftMinPoint, leftMaxPoint) + rightCosts[bin + 1];
+
+                    if (cost < bestCost)
+                    {
+                        bestAxis = axis;
+                        bestBin = bin;
+                        bestCost = cost;
+                    }
+                }
+            }
+
+            return (bestAxis, bestBin, bestCost);
+        }
+
+        private static int Partition(Vector3[] minPoints, Vector3[] maxPoints, int[] order, int start, int count, int axis, int splitBin, Vector3 minCentroid, Vector3 maxCentroid)
+        {
+            var axisMin = GetComponent(minCentroid, axis);
+            var axisExtent = GetComponent(maxCentroid, axis) - axisMin;
+
+            var left = start;
+            var right = start + count - 1;
+
+            while (left <= right)
+            {
+                var primitive = order[left];
+
+                if (ComputeBin(minPoints[primitive], maxPoints[primitive], axis, axisMin, axisExtent) <= splitBin)
+                {
+                    left++;
+                }
+
+                else
+                {
+                    order[left] = order[right];
+                    order[right] = primitive;
+                    right--;
+                }
+            }
+
+            return left;
+        }
+
+        private static int ComputeBin(Vector3 minPoint, Vector3 maxPoint, int axis, float axisMin, float axisExtent)
+        {
+            var centroid = (GetComponent(minPoint, axis) + GetComponent(maxPoint, axis)) * 0.5f;
+            var bin = (int)((centroid - axisMin) / axisExtent * BinCount);
+
+            return Math.Clamp(bin, 0, BinCount - 1);
+        }
+
+        private static BuildNode ReplaceLeaves(BuildNode node, List<BuildNode> subObjectRoots, int[] order)
+        {
+            if (node.Left == null || node.Right == null)
+            {
+                return subObjectRoots[order[node.FirstPrimitive]];
+            }
+
+            node.Left = ReplaceLeaves(node.Left, subObjectRoots, order);
+            node.Right = ReplaceLeaves(node.Right, subObjectRoots, order);
+
+            return node;
+        }
+
+        private static void OffsetLeaves(BuildNode node, int offset)
+        {
+            if (node.Left == null || node.Right == null)
+            {
+                node.FirstPrimitive += offset;
+                return;
+            }
+
+            OffsetLeaves(node.Left, offset);
+            OffsetLeaves(node.Right, offset);
+        }
+
+        // Nodes are stored depth first with the two children of a node next to each other so that
+        // a traversal only needs one offset per inner node
+        private static void FlattenNode(List<BvhNode> nodes, int nodeIndex, BuildNode buildNode, Dictionary<BuildNode, MeshSubObject> rootSubObjects)
+        {
+            var node = nodes[nodeIndex];
+
+            if (rootSubObjects.TryGetValue(buildNode, out var subObject))
+            {
+                subObject.BvhRootIndex = nodeIndex;
+            }
+
+            node.MinPoint = buildNode.MinPoint;
+            node.MaxPoint = buildNode.MaxPoint;
+
+            if (buildNode.Left == null || buildNode.Right == null)
+            {
+                node.ChildOrMeshletOffset = (uint)buildNode.FirstPrimitive;
+                node.MeshletCount = (uint)buildNode.PrimitiveCount;
+                return;
+            }
+
+            var childIndex = nodes.Count;
+
+            nodes.Add(new BvhNode());
+            nodes.Add(new BvhNode());
+
+            node.ChildOrMeshletOffset = (uint)childIndex;
+            node.MeshletCount = 0;
+
+            FlattenNode(nodes, childIndex, buildNode.Left, rootSubObjects);
+            FlattenNode(nodes, childIndex + 1, buildNode.Right, rootSubObjects);
+        }
+
+        private static float SurfaceArea(Vector3 minPoint, Vector3 maxPoint)
+        {
+            var extent = maxPoint - minPoint;
+            return 2.0f * (extent.X * extent.Y + extent.Y * extent.Z + extent.Z * extent.X);
+        }
+
+        private static float GetComponent(Vector3 vector, int axis)
+        {
+            return (axis == 0) ? vector.X : (axis == 1) ? vector.Y : vector.Z;
+        }
+    }
+}
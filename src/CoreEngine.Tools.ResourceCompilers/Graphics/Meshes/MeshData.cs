@@ -10,6 +10,13 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
         public List<MeshVertex> Vertices { get; } = new List<MeshVertex>();
         public List<uint> Indices { get; } = new List<uint>();
         public IList<MeshSubObject> MeshSubObjects { get; } = new List<MeshSubObject>();
+        public List<Meshlet> Meshlets { get; } = new List<Meshlet>();
+        public List<uint> MeshletVertexIndices { get; } = new List<uint>();
+        public List<uint> MeshletTriangleIndices { get; } = new List<uint>();
+        public List<BvhNode> BvhNodes { get; } = new List<BvhNode>();
+
+        // Root of the BVH over the sub objects without instances, in mesh space. -1 when every sub object is instanced.
+        public int BvhRootIndex { get; set; } = -1;
     }
 
     public class MeshSubObject
@@ -18,15 +25,89 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
         {
             this.BoundingBox = new BoundingBox();
             this.MaterialPath = string.Empty;
+            this.Lods = new List<MeshSubObjectLod>();
+            this.Instances = new List<MeshInstance>();
         }
 
         public uint StartIndex { get; set; }
         public uint IndexCount { get; set; }
+
+        // In the space of the geometry, instances transform it with their world matrix
         public BoundingBox BoundingBox { get; set; }
         public string MaterialPath { get; set; }
+        public uint MeshletOffset { get; set; }
+        public uint MeshletCount { get; set; }
+
+        // Indices of the sub object are stored relative to this vertex
+        public uint BaseVertex { get; set; }
+
+        // Simplified versions of the sub object, from the most detailed to the least detailed
+        public IList<MeshSubObjectLod> Lods { get; }
+
+        // Placements of the geometry when identical sub objects were merged, the first one is the sub object itself.
+        // Empty when the sub object is drawn once as it is.
+        public IList<MeshInstance> Instances { get; }
+
+        // Root of the BVH over the meshlets of the sub object, -1 when it has no meshlets. Instanced sub objects are not
+        // part of the mesh BVH: their tree is in the space of their geometry and is traversed once per instance, after
+        // the bounding box transformed by the instance matrix passed the culling.
+        public int BvhRootIndex { get; set; } = -1;
+    }
+
+    public class MeshInstance
+    {
+        public MeshInstance(Matrix4x4 worldMatrix, string materialPath)
+        {
+            this.WorldMatrix = worldMatrix;
+            this.MaterialPath = materialPath;
+        }
+
+        // Transforms the sub object geometry to the position of the instance
+        public Matrix4x4 WorldMatrix { get; }
+        public string MaterialPath { get; }
+    }
+
+    public class MeshSubObjectLod
+    {
+        public uint StartIndex { get; set; }
+        public uint IndexCount { get; set; }
+
+        // Maximum distance in object space between the vertices of the level and the planes of the original
+        // triangles they replace, it never decreases from one level to the next
+        public float Error { get; set; }
+    }
+
+    public class Meshlet
+    {
+        // Normal cone packed as signed 8-bit values: axis in xyz and cutoff in w (127 disables the cone culling)
+        public uint PackedCone { get; set; }
+        public Vector3 BoundingSphereCenter { get; set; }
+        public float BoundingSphereRadius { get; set; }
+        public uint VertexCount { get; set; }
+        public uint VertexOffset { get; set; }
+        public uint TriangleCount { get; set; }
+        public uint TriangleOffset { get; set; }
+    }
+
+    public class BvhNode
+    {
+        public Vector3 MinPoint { get; set; }
+        public Vector3 MaxPoint { get; set; }
+
+        // Inner nodes have a meshlet count of 0 and their two children stored next to each other at the offset
+        public uint ChildOrMeshletOffset { get; set; }
+        public uint MeshletCount { get; set; }
+
+        public bool IsLeaf
+        {
+            get
+            {
+                return this.MeshletCount > 0;
+            }
+        }
     }
 
-    public struct MeshVertex
+    public struct MeshVertex : IEquatable<MeshVertex>
     {
         public Vector3 Position { get; set; }
         public Vector3 Normal { get; set; }
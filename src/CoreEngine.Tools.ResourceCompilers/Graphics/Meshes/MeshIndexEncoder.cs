@@ -0,0 +1,203 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    public enum MeshIndexFormat
+    {
+        UInt32 = 0,
+        UInt16 = 1
+    }
+
+    // Stores the index buffer of a mesh with 16-bit indices when every sub object references less than
+    // MaxUInt16VertexCount vertices relative to its base vertex
+    public static class MeshIndexEncoder
+    {
+        // 0xFFFF is never used as an index so that it stays available as the primitive restart value
+        public const int MaxUInt16VertexCount = 65535;
+
+        // Sub objects referencing too many vertices are split into several sub objects using the same material,
+        // this must be done before the meshlets and the bounding boxes are computed. The pieces share the vertices
+        // of their seams until MeshVertexQuantizer.SplitSharedVertices runs.
+        public static int SplitSubObjects(MeshData meshData, int maxVertexCount = MaxUInt16VertexCount)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var vertexStamps = new int[meshData.Vertices.Count];
+            var stamp = 0;
+            var subObjects = new List<MeshSubObject>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var startIndex = (int)subObject.StartIndex;
+                var endIndex = startIndex + (int)subObject.IndexCount - (int)subObject.IndexCount % 3;
+                var pieceStartIndex = startIndex;
+                var pieceVertexCount = 0;
+
+                stamp++;
+
+                for (var i = startIndex; i < endIndex; i += 3)
+                {
+                    var newVertexCount = 0;
+
+                    for (var j = 0; j < 3; j++)
+                    {
+                        if (vertexStamps[meshData.Indices[i + j]] != stamp)
+                        {
+                            newVertexCount++;
+                        }
+                    }
+
+                    if (pieceVertexCount + newVertexCount > maxVertexCount)
+                    {
+                        subObjects.Add(CreateSubObjectPiece(subObject, pieceStartIndex, i - pieceStartIndex));
+
+                        pieceStartIndex = i;
+                        pieceVertexCount = 0;
+                        stamp++;
+                    }
+
+                    for (var j = 0; j < 3; j++)
+                    {
+                        var vertexIndex = meshData.Indices[i + j];
+
+                        if (vertexStamps[vertexIndex] != stamp)
+                        {
+                            vertexStamps[vertexIndex] = stamp;
+                            pieceVertexCount++;
+                        }
+                    }
+                }
+
+                if (pieceStartIndex == startIndex)
+                {
+                    subObjects.Add(subObject);
+                }
+
+                else
+                {
+                    subObjects.Add(CreateSubObjectPiece(subObject, pieceStartIndex, startIndex + (int)subObject.IndexCount - pieceStartIndex));
+                }
+            }
+
+            var result = subObjects.Count - meshData.MeshSubObjects.Count;
+
+            meshData.MeshSubObjects.Clear();
+
+            foreach (var subObject in subObjects)
+            {
+                meshData.MeshSubObjects.Add(subObject);
+            }
+
+            return result;
+        }
+
+        // Computes the base vertex of each sub object and returns the smallest index format that can address them
+        public static MeshIndexFormat ComputeIndexFormat(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var result = MeshIndexFormat.UInt16;
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var minVertex = uint.MaxValue;
+                var maxVertex = 0u;
+
+                for (var i = subObject.StartIndex; i < subObject.StartIndex + subObject.IndexCount; i++)
+                {
+                    var vertexIndex = meshData.Indices[(int)i];
+
+                    minVertex = Math.Min(minVertex, vertexIndex);
+                    maxVertex = Math.Max(maxVertex, vertexIndex);
+                }
+
+                subObject.BaseVertex = (subObject.IndexCount > 0) ? minVertex : 0;
+
+                if (subObject.IndexCount > 0 && maxVertex - minVertex >= MaxUInt16VertexCount)
+                {
+                    result = MeshIndexFormat.UInt32;
+                }
+            }
+
+            return result;
+        }
+
+        public static void WriteIndices(BinaryWriter writer, MeshData meshData, MeshIndexFormat indexFormat)
+        {
+            if (writer == null)
+            {
+                throw new ArgumentNullException(nameof(writer));
+            }
+
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            // Indices that are not part of a sub object are never drawn and are written as is
+            var baseVertices = new uint[meshData.Indices.Count];
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                for (var i = subObject.StartIndex; i < subObject.StartIndex + subObject.IndexCount; i++)
+                {
+                    baseVertices[i] = subObject.BaseVertex;
+                }
+
+                // Levels of detail use a subset of the sub object vertices
+                foreach (var lod in subObject.Lods)
+                {
+                    for (var i = lod.StartIndex; i < lod.StartIndex + lod.IndexCount; i++)
+                    {
+                        baseVertices[i] = subObject.BaseVertex;
+                    }
+                }
+            }
+
+            for (var i = 0; i < meshData.Indices.Count; i++)
+            {
+                var index = meshData.Indices[i] - baseVertices[i];
+
+                if (indexFormat == MeshIndexFormat.UInt16)
+                {
+                    writer.Write((ushort)index);
+                }
+
+                else
+                {
+                    writer.Write(index);
+                }
+            }
+
+            // Keeps the data following the index buffer aligned on 4 bytes
+            if (indexFormat == MeshIndexFormat.UInt16 && meshData.Indices.Count % 2 != 0)
+            {
+                writer.Write((ushort)0);
+            }
+        }
+
+        private static MeshSubObject CreateSubObjectPiece(MeshSubObject subObject, int startIndex, int indexCount)
+        {
+            var result = new MeshSubObject();
+
+            result.MaterialPath = subObject.MaterialPath;
+            result.StartIndex = (uint)startIndex;
+            result.IndexCount = (uint)indexCount;
+
+            foreach (var instance in subObject.Instances)
+            {
+                result.Instances.Add(instance);
+            }
+
+            return result;
+        }
+    }
+}
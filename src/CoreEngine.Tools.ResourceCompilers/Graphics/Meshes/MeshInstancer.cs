@@ -0,0 +1,372 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+using System.Runtime.InteropServices;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    // Finds the sub objects that have the same geometry placed differently (repeated FBX nodes or copies in OBJ files
+    // are baked in world space by the readers). The geometry is kept once and the sub object lists the transforms of
+    // its instances so that the repeats can be drawn instanced.
+    public static class MeshInstancer
+    {
+        // Texture coordinates are quantized before hashing so that the candidates tolerate small differences
+        private const float TextureCoordinatesQuantization = 4096.0f;
+
+        // Distance allowed between the transformed positions, relative to the size of the sub object
+        private const double PositionTolerance = 1e-4;
+
+        // Minimum cosine between the transformed normals
+        private const float NormalTolerance = 0.999f;
+
+        private class SubObjectGeometry
+        {
+            public SubObjectGeometry(int subObjectIndex, uint[] indices, MeshVertex[] vertices)
+            {
+                this.SubObjectIndex = subObjectIndex;
+                this.Indices = indices;
+                this.Vertices = vertices;
+            }
+
+            public int SubObjectIndex { get; }
+
+            // Indices renumbered in the order of first use so that identical geometry has identical indices
+            public uint[] Indices { get; }
+            public MeshVertex[] Vertices { get; }
+        }
+
+        // Returns the number of sub objects merged into instances of other sub objects
+        public static int MergeInstances(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var references = new Dictionary<ulong, List<SubObjectGeometry>>();
+            var mergedSubObjects = new HashSet<MeshSubObject>();
+
+            for (var i = 0; i < meshData.MeshSubObjects.Count; i++)
+            {
+                var subObject = meshData.MeshSubObjects[i];
+
+                if (subObject.IndexCount == 0)
+                {
+                    continue;
+                }
+
+                var geometry = ReadGeometry(meshData, subObject, i);
+                var hash = ComputeGeometryHash(geometry);
+                var isMerged = false;
+
+                if (!references.TryGetValue(hash, out var candidates))
+                {
+                    candidates = new List<SubObjectGeometry>();
+                    references.Add(hash, candidates);
+                }
+
+                foreach (var reference in candidates)
+                {
+                    if (TryFindTransform(reference, geometry, out var worldMatrix))
+                    {
+                        var referenceSubObject = meshData.MeshSubObjects[reference.SubObjectIndex];
+
+                        if (referenceSubObject.Instances.Count == 0)
+                        {
+                            referenceSubObject.Instances.Add(new MeshInstance(Matrix4x4.Identity, referenceSubObject.MaterialPath));
+                        }
+
+                        referenceSubObject.Instances.Add(new MeshInstance(worldMatrix, subObject.MaterialPath));
+                        mergedSubObjects.Add(subObject);
+                        isMerged = true;
+                        break;
+                    }
+                }
+
+                if (!isMerged)
+                {
+                    candidates.Add(geometry);
+                }
+            }
+
+            if (mergedSubObjects.Count > 0)
+            {
+                RemoveSubObjects(meshData, mergedSubObjects);
+            }
+
+            return mergedSubObjects.Count;
+        }
+
+        private static SubObjectGeometry ReadGeometry(MeshData meshData, MeshSubObject subObject, int subObjectIndex)
+        {
+            var localIndices = new Dictionary<uint, uint>();
+            var indices = new uint[subObject.IndexCount];
+            var vertices = new List<MeshVertex>();
+
+            for (var i = 0; i < subObject.IndexCount; i++)
+            {
+                var index = meshData.Indices[(int)(subObject.StartIndex + i)];
+
+                if (!localIndices.TryGetValue(index, out var localIndex))
+                {
+                    localIndex = (uint)vertices.Count;
+                    localIndices.Add(index, localIndex);
+                    vertices.Add(meshData.Vertices[(int)index]);
+                }
+
+                indices[i] = localIndex;
+            }
+
+            return new SubObjectGeometry(subObjectIndex, indices, vertices.ToArray());
+        }
+
+        // The hash only uses the data that doesn't change with the transform: the topology and the texture coordinates
+        private static ulong ComputeGeometryHash(SubObjectGeometry geometry)
+        {
+            var hash = new XxHash64();
+            hash.Append(MemoryMarshal.AsBytes(geometry.Indices.AsSpan()));
+
+            var textureCoordinates = new int[geometry.Vertices.Length * 2];
+
+            for (var i = 0; i < geometry.Vertices.Length; i++)
+            {
+                textureCoordinates[i * 2] = (int)MathF.Round(geometry.Vertices[i].TextureCoordinates.X * TextureCoordinatesQuantization);
+                textureCoordinates[i * 2 + 1] = (int)MathF.Round(geometry.Vertices[i].TextureCoordinates.Y * TextureCoordinatesQuantization);
+            }
+
+            hash.Append(MemoryMarshal.AsBytes(textureCoordinates.AsSpan()));
+            return hash.GetCurrentHash();
+        }
+
+        // Fits the affine transform from the reference positions to the candidate positions with least squares and
+        // checks that it maps every vertex. Flat geometry has no unique fit so only translated copies are found.
+        private static bool TryFindTransform(SubObjectGeometry reference, SubObjectGeometry candidate, out Matrix4x4 worldMatrix)
+        {
+            worldMatrix = Matrix4x4.Identity;
+
+            if (reference.Indices.Length != candidate.Indices.Length || reference.Vertices.Length != candidate.Vertices.Length)
+            {
+                return false;
+            }
+
+            for (var i = 0; i < reference.Indices.Length; i++)
+            {
+                if (reference.Indices[i] != candidate.Indices[i])
+                {
+                    return false;
+                }
+            }
+
+            var vertexCount = reference.Vertices.Length;
+            var referenceCenter = ComputeCenter(reference.Vertices);
+            var candidateCenter = ComputeCenter(candidate.Vertices);
+
+            // Covariance of the reference positions and cross covariance with the candidate positions
+            var covariance = new double[9];
+            var crossCovariance = new double[9];
+            var candidateRadius = 0.0;
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                var q = ToArray(reference.Vertices[i].Position, referenceCenter);
+                var p = ToArray(candidate.Vertices[i].Position, candidateCenter);
+
+                for (var row = 0; row < 3; row++)
+                {
+                    for (var column = 0; column < 3; column++)
+                    {
+                        covariance[row * 3 + column] += q[row] * q[column];
+                        crossCovariance[row * 3 + column] += p[row] * q[column];
+                    }
+                }
+
+                candidateRadius = Math.Max(candidateRadius, Math.Sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]));
+            }
+
+            var linearPart = new double[] { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+            var covarianceScale = covariance[0] + covariance[4] + covariance[8];
+            var covarianceDeterminant = ComputeDeterminant(covariance);
+
+            if (covarianceScale > 0 && covarianceDeterminant > 1e-9 * covarianceScale * covarianceScale * covarianceScale)
+            {
+                linearPart = Multiply(crossCovariance, Invert(covariance, covarianceDeterminant));
+            }
+
+            // Mirrored instances would reverse the triangle winding
+            var linearDeterminant = ComputeDeterminant(linearPart);
+
+            if (linearDeterminant <= 0)
+            {
+                return false;
+            }
+
+            var translation = new double[3];
+
+            for (var row = 0; row < 3; row++)
+            {
+                translation[row] = candidateCenter[row] - (linearPart[row * 3] * referenceCenter[0] + linearPart[row * 3 + 1] * referenceCenter[1] + linearPart[row * 3 + 2] * referenceCenter[2]);
+            }
+
+            var tolerance = PositionTolerance * Math.Max(candidateRadius, 1e-3);
+
+            // Normals are transformed by the inverse transpose of the linear part
+            var normalMatrix = Invert(linearPart, linearDeterminant);
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                var referenceVertex = reference.Vertices[i];
+                var candidateVertex = candidate.Vertices[i];
+
+                if (Vector2.Distance(referenceVertex.TextureCoordinates, candidateVertex.TextureCoordinates) > 1.0f / TextureCoordinatesQuantization)
+                {
+                    return false;
+                }
+
+                var q = referenceVertex.Position;
+                var p = candidateVertex.Position;
+
+                for (var row = 0; row < 3; row++)
+                {
+                    var transformed = linearPart[row * 3] * q.X + linearPart[row * 3 + 1] * q.Y + linearPart[row * 3 + 2] * q.Z + translation[row];
+
+                    if (Math.Abs(transformed - GetComponent(p, row)) > tolerance)
+                    {
+                        return false;
+                    }
+                }
+
+                var n = referenceVertex.Normal;
+                var transformedNormal = new Vector3((float)(normalMatrix[0] * n.X + normalMatrix[3] * n.Y + normalMatrix[6] * n.Z),
+                                                    (float)(normalMatrix[1] * n.X + normalMatrix[4] * n.Y + normalMatrix[7] * n.Z),
+                                                    (float)(normalMatrix[2] * n.X + normalMatrix[5] * n.Y + normalMatrix[8] * n.Z));
+
+                if (transformedNormal.LengthSquared() > 0 && candidateVertex.Normal.LengthSquared() > 0 &&
+                    Vector3.Dot(Vector3.Normalize(transformedNormal), Vector3.Normalize(candidateVertex.Normal)) < NormalTolerance)
+                {
+                    return false;
+                }
+            }
+
+            // Row vector convention of System.Numerics: the instance position is the reference position times the matrix
+            worldMatrix = new Matrix4x4((float)linearPart[0], (float)linearPart[3], (float)linearPart[6], 0,
+                                        (float)linearPart[1], (float)linearPart[4], (float)linearPart[7], 0,
+                                        (float)linearPart[2], (float)linearPart[5], (float)linearPart[8], 0,
+                                        (float)translation[0], (float)translation[1], (float)translation[2], 1);
+
+            return true;
+        }
+
+        // The merged sub objects and the vertices only they used are removed, the other vertices keep their order
+        private static void RemoveSubObjects(MeshData meshData, HashSet<MeshSubObject> mergedSubObjects)
+        {
+            var vertexRemap = new int[meshData.Vertices.Count];
+            Array.Fill(vertexRemap, -1);
+
+            var vertices = new List<MeshVertex>();
+            var indices = new List<uint>();
+
+            for (var i = meshData.MeshSubObjects.Count - 1; i >= 0; i--)
+            {
+                if (mergedSubObjects.Contains(meshData.MeshSubObjects[i]))
+                {
+                    meshData.MeshSubObjects.RemoveAt(i);
+                }
+            }
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var startIndex = (uint)indices.Count;
+
+                for (var i = subObject.StartIndex; i < subObject.StartIndex + subObject.IndexCount; i++)
+                {
+                    var index = (int)meshData.Indices[(int)i];
+
+                    if (vertexRemap[index] < 0)
+                    {
+                        vertexRemap[index] = vertices.Count;
+                        vertices.Add(meshData.Vertices[index]);
+                    }
+
+                    indices.Add((uint)vertexRemap[index]);
+                }
+
+                subObject.StartIndex = startIndex;
+            }
+
+            meshData.Vertices.Clear();
+            meshData.Vertices.AddRange(vertices);
+            meshData.Indices.Clear();
+            meshData.Indices.AddRange(indices);
+        }
+
+        private static double[] ComputeCenter(MeshVertex[] vertices)
+        {
+            var result = new double[3];
+
+            foreach (var vertex in vertices)
+            {
+                result[0] += vertex.Position.X;
+                result[1] += vertex.Position.Y;
+                result[2] += vertex.Position.Z;
+            }
+
+            for (var i = 0; i < 3; i++)
+            {
+                result[i] /= vertices.Length;
+            }
+
+            return result;
+        }
+
+        private static double[] ToArray(Vector3 position, double[] center)
+        {
+            return new double[] { position.X - center[0], position.Y - center[1], position.Z - center[2] };
+        }
+
+        private static double GetComponent(Vector3 value, int index)
+        {
+            return (index == 0) ? value.X : (index == 1) ? value.Y : value.Z;
+        }
+
+        private static double ComputeDeterminant(double[] m)
+        {
+            return m[0] * (m[4] * m[8] - m[5] * m[7]) -
+                   m[1] * (m[3] * m[8] - m[5] * m[6]) +
+                   m[2] * (m[3] * m[7] - m[4] * m[6]);
+        }
+
+        private static double[] Invert(double[] m, double determinant)
+        {
+            var inverseDeterminant = 1.0 / determinant;
+
+            return new double[]
+            {
+                (m[4] * m[8] - m[5] * m[7]) * inverseDeterminant,
+                (m[2] * m[7] - m[1] * m[8]) * inverseDeterminant,
+                (m[1] * m[5] - m[2] * m[4]) * inverseDeterminant,
+                (m[5] * m[6] - m[3] * m[8]) * inverseDeterminant,
+                (m[0] * m[8] - m[2] * m[6]) * inverseDeterminant,
+                (m[2] * m[3] - m[0] * m[5]) * inverseDeterminant,
+                (m[3] * m[7] - m[4] * m[6]) * inverseDeterminant,
+                (m[1] * m[6] - m[0] * m[7]) * inverseDeterminant,
+                (m[0] * m[4] - m[1] * m[3]) * inverseDeterminant
+            };
+        }
+
+        private static double[] Multiply(double[] a, double[] b)
+        {
+            var result = new double[9];
+
+            for (var row = 0; row < 3; row++)
+            {
+                for (var column = 0; column < 3; column++)
+                {
+                    result[row * 3 + column] = a[row * 3] * b[column] + a[row * 3 + 1] * b[3 + column] + a[row * 3 + 2] * b[6 + column];
+                }
+            }
+
+            return result;
+        }
+    }
+}
@@ -0,0 +1,572 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    public class VertexCacheStatistics
+    {
+        public VertexCacheStatistics(int transformedVertexCount, int triangleCount, int vertexCount)
+        {
+            this.TransformedVertexCount = transformedVertexCount;
+            this.TriangleCount = triangleCount;
+            this.VertexCount = vertexCount;
+        }
+
+        public int TransformedVertexCount { get; }
+        public int TriangleCount { get; }
+        public int VertexCount { get; }
+
+        // Average cache miss ratio: transformed vertices per triangle (0.5 is the optimum for a regular grid)
+        public float Acmr
+        {
+            get
+            {
+                return (this.TriangleCount > 0) ? (float)this.TransformedVertexCount / this.TriangleCount : 0.0f;
+            }
+        }
+
+        // Average transformed vertex ratio: transformed vertices per unique vertex (1.0 is the optimum)
+        public float Atvr
+        {
+            get
+            {
+                return (this.VertexCount > 0) ? (float)this.TransformedVertexCount / this.VertexCount : 0.0f;
+            }
+        }
+    }
+
+    // Implements the triangle reordering stages of the mesh compiler:
+    // - Vertex cache optimization: Tom Forsyth, "Linear-Speed Vertex Cache Optimisation", 2006
+    // - Overdraw optimization: Sander, Nehab, Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007
+    // - Vertex fetch optimization: vertices are renumbered in the order of their first use
+    public static class MeshOptimizer
+    {
+        // Size of the FIFO cache used to compute the statistics and the overdraw clusters
+        public const int FifoCacheSize = 16;
+
+        // Size of the LRU cache modeled by the Forsyth scoring function
+        private const int LruCacheSize = 32;
+        private const float CacheDecayPower = 1.5f;
+        private const float LastTriangleScore = 0.75f;
+        private const float ValenceBoostScale = 2.0f;
+        private const float ValenceBoostPower = 0.5f;
+        private const int MaxValence = 64;
+
+        private static readonly float[] cachePositionScores = ComputeCachePositionScores();
+        private static readonly float[] valenceScores = ComputeValenceScores();
+
+        public static VertexCacheStatistics ComputeVertexCacheStatistics(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var cacheTimestamps = new int[meshData.Vertices.Count];
+            var isVertexUsed = new bool[meshData.Vertices.Count];
+            var timestamp = FifoCacheSize + 1;
+            var transformedVertexCount = 0;
+            var triangleCount = 0;
+            var vertexCount = 0;
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                // Each sub object is a separate draw so the cache doesn't survive between them
+                timestamp += FifoCacheSize + 1;
+
+                for (var i = 0; i < subObject.IndexCount - subObject.IndexCount % 3; i++)
+                {
+                    var vertexIndex = (int)meshData.Indices[(int)subObject.StartIndex + i];
+
+                    if (timestamp - cacheTimestamps[vertexIndex] > FifoCacheSize)
+                    {
+                        cacheTimestamps[vertexIndex] = timestamp++;
+                        transformedVertexCount++;
+                    }
+
+                    if (!isVertexUsed[vertexIndex])
+                    {
+                        isVertexUsed[vertexIndex] = true;
+                        vertexCount++;
+                    }
+                }
+
+                triangleCount += (int)subObject.IndexCount / 3;
+            }
+
+            return new VertexCacheStatistics(transformedVertexCount, triangleCount, vertexCount);
+        }
+
+        public static void OptimizeMesh(MeshData meshData, float overdrawThreshold = 1.05f)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            // Maps the mesh vertices to the sub object local vertices, entries are reset after each sub object
+            var localVertexIndices = new int[meshData.Vertices.Count];
+            Array.Fill(localVertexIndices, -1);
+
+            var localVertices = new List<int>();
+            var localPositions = new List<Vector3>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var startIndex = (int)subObject.StartIndex;
+                var indexCount = (int)subObject.IndexCount - (int)subObject.IndexCount % 3;
+
+                if (indexCount == 0)
+                {
+                    continue;
+                }
+
+                var indices = new int[indexCount];
+
+                for (var i = 0; i < indexCount; i++)
+                {
+                    var vertexIndex = (int)meshData.Indices[startIndex + i];
+
+                    if (localVertexIndices[vertexIndex] == -1)
+                    {
+                        localVertexIndices[vertexIndex] = localVertices.Count;
+                        localVertices.Add(vertexIndex);
+                        localPositions.Add(meshData.Vertices[vertexIndex].Position);
+                    }
+
+                    indices[i] = localVertexIndices[vertexIndex];
+                }
+
+                indices = OptimizeVertexCache(indices, localVertices.Count);
+                indices = OptimizeOverdraw(indices, localPositions, overdrawThreshold);
+
+                for (var i = 0; i < indexCount; i++)
+                {
+                    meshData.Indices[startIndex + i] = (uint)localVertices[indices[i]];
+                }
+
+                foreach (var vertexIndex in localVertices)
+                {
+                    localVertexIndices[vertexIndex] = -1;
+                }
+
+                localVertices.Clear();
+                localPositions.Clear();
+            }
+
+            OptimizeVertexFetch(meshData);
+        }
+
+        public static int[] OptimizeVertexCache(int[] indices, int vertexCount)
+        {
+            if (indices == null)
+            {
+                throw new ArgumentNullException(nameof(indices));
+            }
+
+            var triangleCount = indices.Length / 3;
+
+            // Vertex to triangle adjacency, the live part of each vertex range shrinks when triangles are emitted
+            var adjacencyOffsets = new int[vertexCount + 1];
+            var liveTriangleCounts = new int[vertexCount];
+
+            foreach (var index in indices)
+            {
+                liveTriangleCounts[index]++;
+            }
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangleCounts[i];
+            }
+
+            var adjacency = new int[indices.Length];
+            var adjacencyFill = new int[vertexCount];
+
+            for (var i = 0; i < indices.Length; i++)
+            {
+                var vertexIndex = indices[i];
+                adjacency[adjacencyOffsets[vertexIndex] + adjacencyFill[vertexIndex]++] = i / 3;
+            }
+
+            var cachePositions = new int[vertexCount];
+            var vertexScores = new float[vertexCount];
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                cachePositions[i] = -1;
+                vertexScores[i] = ComputeVertexScore(-1, liveTriangleCounts[i]);
+            }
+
+            var isTriangleEmitted = new bool[triangleCount];
+
+            var cache = new int[LruCacheSize + 3];
+            var newCache = new int[LruCacheSize + 3];
+            var cacheCount = 0;
+
+            var result = new int[indices.Length];
+            var emittedTriangleCount = 0;
+            var nextInputTriangle = 0;
+            var bestTriangle = (triangleCount > 0) ? 0 : -1;
+
+            while (emittedTriangleCount < triangleCount)
+            {
+                // Dead end: no triangle touches the cache so continue with the next triangle in input order
+                if (bestTriangle == -1)
+                {
+                    while (isTriangleEmitted[nextInputTriangle])
+                    {
+                        nextInputTriangle++;
+                    }
+
+                    bestTriangle = nextInputTriangle;
+                }
+
+                isTriangleEmitted[bestTriangle] = true;
+                var newCacheCount = 0;
+
+                for (var i = 0; i < 3; i++)
+                {
+                    var vertexIndex = indices[bestTriangle * 3 + i];
+                    result[emittedTriangleCount * 3 + i] = vertexIndex;
+
+                    // Remove the emitted triangle from the live adjacency of the vertex
+                    var adjacencyStart = adjacencyOffsets[vertexIndex];
+                    var adjacencyEnd = adjacencyStart + liveTriangleCounts[vertexIndex];
+
+                    for (var j = adjacencyStart; j < adjacencyEnd; j++)
+                    {
+                        if (adjacency[j] == bestTriangle)
+                        {
+                            adjacency[j] = adjacency[adjacencyEnd - 1];
+                            liveTriangleCounts[vertexIndex]--;
+                            break;
+                        }
+                    }
+
+                    if (Array.IndexOf(newCache, vertexIndex, 0, newCacheCount) == -1)
+                    {
+                        newCache[newCacheCount++] = vertexIndex;
+                    }
+                }
+
+                emittedTriangleCount++;
+
+                for (var i = 0; i < cacheCount; i++)
+                {
+                    var vertexIndex = cache[i];
+
+                    if (Array.IndexOf(newCache, vertexIndex, 0, newCacheCount) == -1)
+                    {
+                        newCache[newCacheCount++] = vertexIndex;
+                    }
+                }
+
+                // Update the scores of the vertices in the cache, including the ones that have just been evicted
+                for (var i = 0; i < newCacheCount; i++)
+                {
+                    var vertexIndex = newCache[i];
+                    cachePositions[vertexIndex] = (i < LruCacheSize) ? i : -1;
+                    vertexScores[vertexIndex] = ComputeVertexScore(cachePositions[vertexIndex], liveTriangleCounts[vertexIndex]);
+                }
+
+                bestTriangle = -1;
+                var bestTriangleScore = -1.0f;
+
+                for (var i = 0; i < newCacheCount; i++)
+                {
+                    var vertexIndex = newCache[i];
+                    var adjacencyStart = adjacencyOffsets[vertexIndex];
+                    var adjacencyEnd = adjacencyStart + liveTriangleCounts[vertexIndex];
+
+                    for (var j = adjacencyStart; j < adjacencyEnd; j++)
+                    {
+                        var triangle = adjacency[j];
+                        var triangleScore = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+
+                        if (triangleScore > bestTriangleScore)
+                        {
+                            bestTriangle = triangle;
+                            bestTriangleScore = triangleScore;
+                        }
+                    }
+                }
+
+                cacheCount = Math.Min(newCacheCount, LruCacheSize);
+
+                var swapCache = cache;
+                cache = newCache;
+                newCache = swapCache;
+            }
+
+            return result;
+        }
+
+        public static int[] OptimizeOverdraw(int[] indices, IList<Vector3> positions, float threshold)
+        {
+            if (indices == null)
+            {
+                throw new ArgumentNullException(nameof(indices));
+            }
+
+            if (positions == null)
+            {
+                throw new ArgumentNullException(nameof(positions));
+            }
+
+            var triangleCount = indices.Length / 3;
+
+            if (triangleCount == 0)
+            {
+                return indices;
+            }
+
+            var cacheTimestamps = new int[positions.Count];
+            var hardClusters = GenerateHardClusterBoundaries(indices, cacheTimestamps);
+            var clusters = GenerateSoftClusterBoundaries(indices, hardClusters, threshold, cacheTimestamps);
+
+            // Clusters that face away from the center of the mesh are drawn first because they are likely to occlude the others
+            var meshCentroid = Vector3.Zero;
+
+            foreach (var position in positions)
+            {
+                meshCentroid += position;
+            }
+
+            meshCentroid /= positions.Count;
+
+            var clusterSortKeys = new float[clusters.Count];
+            var clusterOrder = new int[clusters.Count];
+
+            for (var i = 0; i < clusters.Count; i++)
+            {
+                var clusterStart = clusters[i];
+                var clusterEnd = (i + 1 < clusters.Count) ? clusters[i + 1] : triangleCount;
+
+                var clusterArea = 0.0f;
+                var clusterCentroid = Vector3.Zero;
+                var clusterNormal = Vector3.Zero;
+
+                for (var j = clusterStart; j < clusterEnd; j++)
+                {
+                    var position1 = positions[indices[j * 3]];
+                    var position2 = positions[indices[j * 3 + 1]];
+                    var position3 = positions[indices[j * 3 + 2]];
+
+                    var normal = Vector3.Cross(position2 - position1, position3 - position1);
+                    var area = normal.Length();
+
+                    clusterCentroid += (position1 + position2 + position3) * (area / 3.0f);
+                    clusterNormal += normal;
+                    clusterArea += area;
+                }
+
+                var clusterNormalLength = clusterNormal.Length();
+
+                clusterCentroid = (clusterArea > 0.0f) ? clusterCentroid / clusterArea : clusterCentroid;
+                clusterNormal = (clusterNormalLength > 0.0f) ? clusterNormal / clusterNormalLength : clusterNormal;
+
+                clusterSortKeys[i] = -Vector3.Dot(clusterCentroid - meshCentroid, clusterNormal);
+                clusterOrder[i] = i;
+            }
+
+            // Ties keep the order produced by the vertex cache optimization
+            Array.Sort(clusterOrder, (cluster1, cluster2) =>
+            {
+                var result = clusterSortKeys[cluster1].CompareTo(clusterSortKeys[cluster2]);
+                return (result != 0) ? result : cluster1.CompareTo(cluster2);
+            });
+
+            var sortedIndices = new int[indices.Length];
+            var outputIndex = 0;
+
+            foreach (var cluster in clusterOrder)
+            {
+                var clusterStart = clusters[cluster];
+                var clusterEnd = (cluster + 1 < clusters.Count) ? clusters[cluster + 1] : triangleCount;
+                var clusterIndexCount = (clusterEnd - clusterStart) * 3;
+
+                Array.Copy(indices, clusterStart * 3, sortedIndices, outputIndex, clusterIndexCount);
+                outputIndex += clusterIndexCount;
+            }
+
+            return sortedIndices;
+        }
+
+        public static void OptimizeVertexFetch(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var vertexRemap = new int[meshData.Vertices.Count];
+            Array.Fill(vertexRemap, -1);
+
+            var vertices = new List<MeshVertex>(meshData.Vertices.Count);
+
+            for (var i = 0; i < meshData.Indices.Count; i++)
+            {
+                var vertexIndex = (int)meshData.Indices[i];
+
+                if (vertexRemap[vertexIndex] == -1)
+                {
+                    vertexRemap[vertexIndex] = vertices.Count;
+                    vertices.Add(meshData.Vertices[vertexIndex]);
+                }
+
+                meshData.Indices[i] = (uint)vertexRemap[vertexIndex];
+            }
+
+            for (var i = 0; i < meshData.MeshletVertexIndices.Count; i++)
+            {
+                meshData.MeshletVertexIndices[i] = (uint)vertexRemap[(int)meshData.MeshletVertexIndices[i]];
+            }
+
+            // Vertices that are not referenced by any index are dropped
+            meshData.Vertices.Clear();
+            meshData.Vertices.AddRange(vertices);
+        }
+
+        // A cluster starts when a triangle misses the cache for its 3 vertices, which usually means a new disjoint patch
+        private static List<int> GenerateHardClusterBoundaries(int[] indices, int[] cacheTimestamps)
+        {
+            Array.Clear(cacheTimestamps, 0, cacheTimestamps.Length);
+
+            var result = new List<int>();
+            var timestamp = FifoCacheSize + 1;
+
+            for (var i = 0; i < indices.Length / 3; i++)
+            {
+                var cacheMissCount = UpdateFifoCache(indices, i, cacheTimestamps, ref timestamp);
+
+                if (i == 0 || cacheMissCount == 3)
+                {
+                    result.Add(i);
+                }
+            }
+
+            return result;
+        }
+
+        // Hard clusters are split further as soon as the running ACMR is within the threshold of the cluster ACMR
+        private static List<int> GenerateSoftClusterBoundaries(int[] indices, List<int> hardClusters, float threshold, int[] cacheTimestamps)
+        {
+            Array.Clear(cacheTimestamps, 0, cacheTimestamps.Length);
+
+            var result = new List<int>();
+            var timestamp = 0;
+
+            for (var i = 0; i < hardClusters.Count; i++)
+            {
+                var clusterStart = hardClusters[i];
+                var clusterEnd = (i + 1 < hardClusters.Count) ? hardClusters[i + 1] : indices.Length / 3;
+
+                timestamp += FifoCacheSize + 1;
+                var clusterMissCount = 0;
+
+                for (var j = clusterStart; j < clusterEnd; j++)
+                {
+                    clusterMissCount += UpdateFifoCache(indices, j, cacheTimestamps, ref timestamp);
+                }
+
+                var clusterThreshold = threshold * ((float)clusterMissCount / (clusterEnd - clusterStart));
+
+                result.Add(clusterStart);
+                timestamp += FifoCacheSize + 1;
+
+                var runningMissCount = 0;
+                var runningTriangleCount = 0;
+
+                for (var j = clusterStart; j < clusterEnd; j++)
+                {
+                    runningMissCount += UpdateFifoCache(indices, j, cacheTimestamps, ref timestamp);
+                    runningTriangleCount++;
+
+                    if ((float)runningMissCount / runningTriangleCount <= clusterThreshold)
+                    {
+                        result.Add(j + 1);
+                        timestamp += FifoCacheSize + 1;
+
+                        runningMissCount = 0;
+                        runningTriangleCount = 0;
+                    }
+                }
+
+                // The last soft cluster is merged with the previous one because it is usually too small to be efficient
+                // (this also removes the boundary added at the cluster end)
+                if (result[result.Count - 1] != clusterStart)
+                {
+                    result.RemoveAt(result.Count - 1);
+                }
+            }
+
+            return result;
+        }
+
+        private static int UpdateFifoCache(int[] indices, int triangle, int[] cacheTimestamps, ref int timestamp)
+        {
+            var cacheMissCount = 0;
+
+            for (var i = 0; i < 3; i++)
+            {
+                var vertexIndex = indices[triangle * 3 + i];
+
+                if (timestamp - cacheTimestamps[vertexIndex] > FifoCacheSize)
+                {
+                    cacheTimestamps[vertexIndex] = timestamp++;
+                    cacheMissCount++;
+                }
+            }
+
+            return cacheMissCount;
+        }
+
+        private static float ComputeVertexScore(int cachePosition, int liveTriangleCount)
+        {
+            if (liveTriangleCount == 0)
+            {
+                return -1.0f;
+            }
+
+            var score = (cachePosition >= 0) ? cachePositionScores[cachePosition] : 0.0f;
+            return score + valenceScores[Math.Min(liveTriangleCount, MaxValence)];
+        }
+
+        private static float[] ComputeCachePositionScores()
+        {
+            var result = new float[LruCacheSize];
+
+            for (var i = 0; i < LruCacheSize; i++)
+            {
+                // The vertices of the last triangle get a fixed score so that strips are not favored over fans
+                if (i < 3)
+                {
+                    result[i] = LastTriangleScore;
+                }
+
+                else
+                {
+                    var scaler = 1.0f / (LruCacheSize - 3);
+                    result[i] = MathF.Pow(1.0f - (i - 3) * scaler, CacheDecayPower);
+                }
+            }
+
+            return result;
+        }
+
+        private static float[] ComputeValenceScores()
+        {
+            var result = new float[MaxValence + 1];
+
+            // Vertices with few remaining triangles are boosted so that they are not left alone at the end
+            for (var i = 1; i <= MaxValence; i++)
+            {
+                result[i] = ValenceBoostScale * MathF.Pow(i, -ValenceBoostPower);
+            }
+
+            return result;
+        }
+    }
+}
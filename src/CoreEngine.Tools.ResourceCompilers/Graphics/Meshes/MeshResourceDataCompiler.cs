@@ -1,6 +1,6 @@
 using System;
 using System.Collections.Generic;
-using System.Linq;
+using System.Globalization;
 using System.IO;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
@@ -33,6 +33,11 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
             }
         }
 
+        public override long EstimateMemoryUsage(long sourceDataLength)
+        {
+            return sourceDataLength * 8;
+        }
+
         public override async Task<ReadOnlyMemory<ResourceEntry>> CompileAsync(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             if (context == null)
@@ -40,7 +45,14 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
                 throw new ArgumentNullException(nameof(context));
             }
 
-            var version = 1;
+            // Version 2: sub objects are no longer split every 126 indices, meshlets with culling bounds are stored instead
+            // Version 3: a BVH over the meshlets is appended after the mesh bounding box
+            // Version 4: the vertex format is stored after the version and vertices can use the compact format
+            // Version 5: the index format is stored after the vertex format and sub objects have a base vertex
+            // Version 6: sub objects store their levels of detail after their bounding box
+            // Version 7: sub objects store the world matrices and materials of their instances after their levels of detail
+            // Version 8: instanced sub objects have their own BVH, sub objects and the mesh store the index of their BVH root
+            var version = 8;
 
             // TODO: Add extension to the parameters in order to do a factory here base on the file extension
 
@@ -58,13 +70,62 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
 
             if (meshDataReader != null)
             {
-                var meshData = await meshDataReader.ReadAsync(sourceData);
+                MeshData? meshData;
+
+                using (BuildTracer.BeginSpan("ReadMesh", "Mesh"))
+                {
+                    meshData = await meshDataReader.ReadAsync(sourceData);
+                }
 
                 if (meshData != null)
                 {
+                    // The mesh bounding box is computed before the instances are merged so that it covers all of them
                     var meshBoundingBox = new BoundingBox();
 
-                    // Compute Bounding Boxes
+                    foreach (var index in meshData.Indices)
+                    {
+                        meshBoundingBox.Add(meshData.Vertices[(int)index].Position);
+                    }
+
+                    // Repeated geometry is stored once, before the other passes so that they only process the unique geometry
+                    using (BuildTracer.BeginSpan("MergeInstances", "Mesh"))
+                    {
+                        var vertexCount = meshData.Vertices.Count;
+                        var mergedSubObjectCount = MeshInstancer.MergeInstances(meshData);
+
+                        if (mergedSubObjectCount > 0)
+                        {
+                            Logger.WriteMessage($"Merged {mergedSubObjectCount} sub objects into instances, vertices: {vertexCount} -> {meshData.Vertices.Count}", LogMessageTypes.Debug);
+                        }
+                    }
+
+                    var statisticsBefore = MeshOptimizer.ComputeVertexCacheStatistics(meshData);
+
+                    using (BuildTracer.BeginSpan("OptimizeMesh", "Mesh"))
+                    {
+                        MeshOptimizer.OptimizeMesh(meshData);
+                    }
+
+                    var splitSubObjectCount = MeshIndexEncoder.SplitSubObjects(meshData);
+
+                    if (splitSubObjectCount > 0)
+                    {
+                        Logger.WriteMessage($"Split large sub objects into {splitSubObjectCount} additional sub objects for 16-bit indices", LogMessageTypes.Debug);
+                    }
+
+                    // Each vertex must belong to one sub object for the compact positions and the per sub object base vertex
+                    var splitVertexCount = MeshVertexQuantizer.SplitSharedVertices(meshData);
+
+                    if (splitVertexCount > 0)
+                    {
+                        Logger.WriteMessage($"Duplicated {splitVertexCount} vertices shared by several sub objects", LogMessageTypes.Debug);
+
+                        // The copies are appended at the end of the vertex buffer, ordering the vertices by first use again
+                        // makes the vertices of each sub object contiguous so that its indices fit in 16 bits
+                        MeshOptimizer.OptimizeVertexFetch(meshData);
+                    }
+
+                    // Compute Bounding Boxes, once the sub objects and their vertices are final
                     foreach (var subObject in meshData.MeshSubObjects)
                     {
                         for (var i = 0; i < subObject.IndexCount; i++)
@@ -73,83 +134,128 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
                             var vertex = meshData.Vertices[(int)index];
 
                             subObject.BoundingBox.Add(vertex.Position);
-                            meshBoundingBox.Add(vertex.Position);
                         }
                     }
 
-                    // TODO: Optimize mesh instances 
-                    // Logger.WriteMessage($"Before - Mesh SubObjects: {meshData.MeshSubObjects.Count} - Vertex Buffer Count: {meshData.Vertices.Count} - Index Buffer Count: {meshData.Indices.Count}");
+                    var vertexFormat = MeshVertexQuantizer.SelectVertexFormat(meshData);
 
-                    // meshData = OptimizeMesh(meshData);
+                    if (vertexFormat == MeshVertexFormat.Float)
+                    {
+                        Logger.WriteMessage("Texture coordinates exceed the half precision range, using the float vertex format", LogMessageTypes.Debug);
+                    }
 
-                    // Logger.WriteMessage($"After - Mesh SubObjects: {meshData.MeshSubObjects.Count} - Vertex Buffer Count: {meshData.Vertices.Count} - Index Buffer Count: {meshData.Indices.Count}");
-                    
-                    // TODO: Optimize mesh indices
+                    using (BuildTracer.BeginSpan("BuildMeshlets", "Mesh"))
+                    {
+                        MeshletBuilder.BuildMeshlets(meshData);
+                        MeshBvhBuilder.BuildBvh(meshData);
+                    }
 
-                    // Compute Bounding Boxes
-                    foreach (var subObject in meshData.MeshSubObjects)
+                    using (BuildTracer.BeginSpan("GenerateLods", "Mesh"))
                     {
-                        for (var i = 0; i < subObject.IndexCount; i++)
+                        MeshSimplifier.GenerateLods(meshData);
+                    }
+
+                    var indexFormat = MeshIndexEncoder.ComputeIndexFormat(meshData);
+                    Logger.WriteMessage($"Index format: {indexFormat}", LogMessageTypes.Debug);
+
+                    var statisticsAfter = MeshOptimizer.ComputeVertexCacheStatistics(meshData);
+
+                    Logger.WriteMessage($"Vertex cache: ACMR {statisticsBefore.Acmr.ToString("0.000", CultureInfo.InvariantCulture)} -> {statisticsAfter.Acmr.ToString("0.000", CultureInfo.InvariantCulture)}, ATVR {statisticsBefore.Atvr.ToString("0.000", CultureInfo.InvariantCulture)} -> {statisticsAfter.Atvr.ToString("0.000", CultureInfo.InvariantCulture)}", LogMessageTypes.Debug);
+
+                    if (meshData.Meshlets.Count > 0)
+                    {
+                        var averageVertexCount = (float)meshData.MeshletVertexIndices.Count / meshData.Meshlets.Count;
+                        var averageTriangleCount = (float)meshData.MeshletTriangleIndices.Count / meshData.Meshlets.Count;
+
+                        Logger.WriteMessage($"Meshlets: {meshData.Meshlets.Count}, {averageVertexCount.ToString("0.0", CultureInfo.InvariantCulture)} vertices and {averageTriangleCount.ToString("0.0", CultureInfo.InvariantCulture)} triangles on average", LogMessageTypes.Debug);
+                        Logger.WriteMessage($"BVH: {meshData.BvhNodes.Count} nodes", LogMessageTypes.Debug);
+                    }
+
+                    for (var i = 0; i < MeshSimplifier.MaxLodCount; i++)
+                    {
+                        var lodTriangleCount = 0;
+                        var lodMaxError = 0.0f;
+
+                        foreach (var subObject in meshData.MeshSubObjects)
                         {
-                            var index = meshData.Indices[i + (int)subObject.StartIndex];
-                            var vertex = meshData.Vertices[(int)index];
+                            if (i < subObject.Lods.Count)
+                            {
+                                lodTriangleCount += (int)subObject.Lods[i].IndexCount / 3;
+                                lodMaxError = MathF.Max(lodMaxError, subObject.Lods[i].Error);
+                            }
+                        }
 
-                            subObject.BoundingBox.Add(vertex.Position);
+                        if (lodTriangleCount > 0)
+                        {
+                            Logger.WriteMessage($"LOD {i + 1}: {lodTriangleCount} triangles, max error {lodMaxError.ToString("0.0000", CultureInfo.InvariantCulture)}", LogMessageTypes.Debug);
                         }
                     }
 
-                    var destinationMemoryStream = new MemoryStream();
+                    using var writeSpan = BuildTracer.BeginSpan("WriteMesh", "Mesh");
+                    var destinationBuffer = new PooledBufferWriter(meshData.Vertices.Count * 32 + meshData.Indices.Count * sizeof(uint));
 
-                    using var streamWriter = new BinaryWriter(destinationMemoryStream);
+                    using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
                     streamWriter.Write(new char[] { 'M', 'E', 'S', 'H'});
                     streamWriter.Write(version);
+                    streamWriter.Write((int)vertexFormat);
+                    streamWriter.Write((int)indexFormat);
 
                     streamWriter.Write(meshData.Vertices.Count);
                     streamWriter.Write(meshData.Indices.Count);
+                    streamWriter.Write(meshData.Meshlets.Count);
+                    streamWriter.Write(meshData.MeshletVertexIndices.Count);
+                    streamWriter.Write(meshData.MeshletTriangleIndices.Count);
                     
-                    // TODO: Currently we add a padding 0 to be aligned
-                    foreach (var vertex in meshData.Vertices)
+                    if (vertexFormat == MeshVertexFormat.Compact)
                     {
-                        streamWriter.Write(vertex.Position.X);
-                        streamWriter.Write(vertex.Position.Y);
-                        streamWriter.Write(vertex.Position.Z);
-                        streamWriter.Write(vertex.Normal.X);
-                        streamWriter.Write(vertex.Normal.Y);
-                        streamWriter.Write(vertex.Normal.Z);
-                        streamWriter.Write(vertex.TextureCoordinates.X);
-                        streamWriter.Write(vertex.TextureCoordinates.Y);
+                        var quantizationError = MeshVertexQuantizer.WriteCompactVertices(streamWriter, meshData);
+                        Logger.WriteMessage($"Compact vertices: max error position {quantizationError.MaxPositionError.ToString("0.000000", CultureInfo.InvariantCulture)}, normal {quantizationError.MaxNormalErrorInDegrees.ToString("0.000", CultureInfo.InvariantCulture)} degrees, texture coordinates {quantizationError.MaxTextureCoordinatesError.ToString("0.000000", CultureInfo.InvariantCulture)}", LogMessageTypes.Debug);
                     }
 
-                    foreach (var index in meshData.Indices)
+                    else
                     {
-                        streamWriter.Write(index);
+                        foreach (var vertex in meshData.Vertices)
+                        {
+                            streamWriter.Write(vertex.Position.X);
+                            streamWriter.Write(vertex.Position.Y);
+                            streamWriter.Write(vertex.Position.Z);
+                            streamWriter.Write(vertex.Normal.X);
+                            streamWriter.Write(vertex.Normal.Y);
+                            streamWriter.Write(vertex.Normal.Z);
+                            streamWriter.Write(vertex.TextureCoordinates.X);
+                            streamWriter.Write(vertex.TextureCoordinates.Y);
+                        }
                     }
 
-                    var newSubObjectList = new List<MeshSubObject>();
+                    MeshIndexEncoder.WriteIndices(streamWriter, meshData, indexFormat);
 
-                    foreach (var subObject in meshData.MeshSubObjects)
+                    // Meshlet data uses the layout of the Meshlet struct in Mesh.hlsl
+                    foreach (var meshlet in meshData.Meshlets)
                     {
-                        var meshletMaxVertices = 126;
-                        var meshletCount = MathF.Ceiling((float)subObject.IndexCount / meshletMaxVertices);
+                        streamWriter.Write(meshlet.PackedCone);
+                        streamWriter.Write(meshlet.BoundingSphereCenter.X);
+                        streamWriter.Write(meshlet.BoundingSphereCenter.Y);
+                        streamWriter.Write(meshlet.BoundingSphereCenter.Z);
+                        streamWriter.Write(meshlet.BoundingSphereRadius);
+                        streamWriter.Write(meshlet.VertexCount);
+                        streamWriter.Write(meshlet.VertexOffset);
+                        streamWriter.Write(meshlet.TriangleCount);
+                        streamWriter.Write(meshlet.TriangleOffset);
+                    }
 
-                        var currentIndex = subObject.StartIndex;
+                    foreach (var vertexIndex in meshData.MeshletVertexIndices)
+                    {
+                        streamWriter.Write(vertexIndex);
+                    }
 
-                        for (var i = 0; i < meshletCount; i++)
-                        {
-                            var newSubObject = new MeshSubObject();
-                            newSubObject.StartIndex = currentIndex;
-                            newSubObject.IndexCount = (uint)MathF.Min(meshletMaxVertices, subObject.IndexCount - i * meshletMaxVertices);
-                            newSubObject.BoundingBox = subObject.BoundingBox;
-                            newSubObject.MaterialPath = subObject.MaterialPath;
-
-                            newSubObjectList.Add(newSubObject);
-                            currentIndex += newSubObject.IndexCount;
-                        }
+                    foreach (var packedTriangle in meshData.MeshletTriangleIndices)
+                    {
+                        streamWriter.Write(packedTriangle);
                     }
 
-                    streamWriter.Write(newSubObjectList.Count);
+                    streamWriter.Write(meshData.MeshSubObjects.Count);
 
-                    foreach (var subObject in newSubObjectList)
+                    foreach (var subObject in meshData.MeshSubObjects)
                     {
                         // TODO: Replace that real material path
                         if (string.IsNullOrEmpty(subObject.MaterialPath))
@@ -164,12 +270,52 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
 
                         streamWriter.Write(subObject.StartIndex);
                         streamWriter.Write(subObject.IndexCount);
+                        streamWriter.Write(subObject.BaseVertex);
+                        streamWriter.Write(subObject.MeshletOffset);
+                        streamWriter.Write(subObject.MeshletCount);
+                        streamWriter.Write(subObject.BvhRootIndex);
                         streamWriter.Write(subObject.BoundingBox.MinPoint.X);
                         streamWriter.Write(subObject.BoundingBox.MinPoint.Y);
                         streamWriter.Write(subObject.BoundingBox.MinPoint.Z);
                         streamWriter.Write(subObject.BoundingBox.MaxPoint.X);
                         streamWriter.Write(subObject.BoundingBox.MaxPoint.Y);
                         streamWriter.Write(subObject.BoundingBox.MaxPoint.Z);
+
+                        streamWriter.Write(subObject.Lods.Count);
+
+                        foreach (var lod in subObject.Lods)
+                        {
+                            streamWriter.Write(lod.StartIndex);
+                            streamWriter.Write(lod.IndexCount);
+                            streamWriter.Write(lod.Error);
+                        }
+
+                        // No instances means that the sub object is drawn once with its material, the matrices use the
+                        // layout of GeometryInstance.WorldMatrix in Common.h
+                        streamWriter.Write(subObject.Instances.Count);
+
+                        foreach (var instance in subObject.Instances)
+                        {
+                            streamWriter.Write(string.IsNullOrEmpty(instance.MaterialPath) ? string.Empty : $"{instance.MaterialPath}.material");
+
+                            var matrix = instance.WorldMatrix;
+                            streamWriter.Write(matrix.M11);
+                            streamWriter.Write(matrix.M12);
+                            streamWriter.Write(matrix.M13);
+                            streamWriter.Write(matrix.M14);
+                            streamWriter.Write(matrix.M21);
+                            streamWriter.Write(matrix.M22);
+                            streamWriter.Write(matrix.M23);
+                            streamWriter.Write(matrix.M24);
+                            streamWriter.Write(matrix.M31);
+                            streamWriter.Write(matrix.M32);
+                            streamWriter.Write(matrix.M33);
+                            streamWriter.Write(matrix.M34);
+                            streamWriter.Write(matrix.M41);
+                            streamWriter.Write(matrix.M42);
+                            streamWriter.Write(matrix.M43);
+                            streamWriter.Write(matrix.M44);
+                        }
                     }
 
                     streamWriter.Write(meshBoundingBox.MinPoint.X);
@@ -179,78 +325,40 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
                     streamWriter.Write(meshBoundingBox.MaxPoint.Y);
                     streamWriter.Write(meshBoundingBox.MaxPoint.Z);
 
-                    streamWriter.Flush();
-
-                    destinationMemoryStream.Flush();
-                    var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-                    var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", resourceData);
-
-                    return new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry });
-                }
-            }
-
-            return null;
-        }
-
-        // TODO: Implement BVH to optimize GPU culling
+                    // The mesh tree is traversed in mesh space and does not contain the instanced sub objects. For each
+                    // instance, the sub object bounding box is transformed by the instance matrix and culled, then the
+                    // tree of the sub object is traversed from its root in the space of its geometry.
+                    streamWriter.Write(meshData.BvhNodes.Count);
+                    streamWriter.Write(meshData.BvhRootIndex);
 
-        private MeshData OptimizeMesh(MeshData mesh)
-        {
-            // TODO: Compute the max object space based on the global bounding box of the mesh
-            var maxObjectSpace = 1000;
-
-            var result = new MeshData();
-
-            var vertexIndexList = new Dictionary<MeshVertex, int>();
-            var currentSubMesh = new MeshSubObject();
-
-            foreach (var subMesh in mesh.MeshSubObjects.OrderBy(x => x.MaterialPath))
-            {
-                // if (currentSubMesh.MaterialPath != subMesh.MaterialPath || ((currentSubMesh.BoundingBox.Center - subMesh.BoundingBox.Center).Length() > maxObjectSpace))
-                // {
-                    currentSubMesh.BoundingBox = new BoundingBox();
-                    currentSubMesh.IndexCount = (uint)(result.Indices.Count - currentSubMesh.StartIndex);
-
-                    if (currentSubMesh.IndexCount > 0)
+                    // BVH nodes are 32 bytes long and the node array is aligned on 32 bytes so that a node
+                    // never straddles a cache line when the data is uploaded as is to the GPU
+                    while (destinationBuffer.WrittenCount % 32 != 0)
                     {
-                        result.MeshSubObjects.Add(currentSubMesh);
+                        streamWriter.Write((byte)0);
                     }
 
-                    vertexIndexList.Clear();
-                    //vertexIndexList = new Dictionary<MeshVertex, int>();
-                    currentSubMesh = new MeshSubObject();
-                    currentSubMesh.MaterialPath = subMesh.MaterialPath;
-                    currentSubMesh.StartIndex = (uint)result.Indices.Count;
-                    currentSubMesh.BoundingBox = subMesh.BoundingBox;
-                //}
-
-                for (var i = (int)subMesh.StartIndex; i < (subMesh.StartIndex + subMesh.IndexCount); i++)
-                {
-                    var index = mesh.Indices[i];
-                    var vertex = mesh.Vertices[(int)index];
-
-                    if (!vertexIndexList.ContainsKey(vertex))
+                    foreach (var node in meshData.BvhNodes)
                     {
-                        vertexIndexList.Add(vertex, result.Vertices.Count);
-                        result.Indices.Add((uint)result.Vertices.Count);
-                        result.Vertices.Add(vertex);
+                        streamWriter.Write(node.MinPoint.X);
+                        streamWriter.Write(node.MinPoint.Y);
+                        streamWriter.Write(node.MinPoint.Z);
+                        streamWriter.Write(node.ChildOrMeshletOffset);
+                        streamWriter.Write(node.MaxPoint.X);
+                        streamWriter.Write(node.MaxPoint.Y);
+                        streamWriter.Write(node.MaxPoint.Z);
+                        streamWriter.Write(node.MeshletCount);
                     }
 
-                    else
-                    {
-                        result.Indices.Add((uint)vertexIndexList[vertex]);
-                    }
-                }
-            }
+                    streamWriter.Flush();
 
-            currentSubMesh.IndexCount = (uint)(result.Indices.Count - currentSubMesh.StartIndex);
+                    var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", destinationBuffer);
 
-            if (currentSubMesh.IndexCount > 0)
-            {
-                result.MeshSubObjects.Add(currentSubMesh);
+                    return new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry });
+                }
             }
 
-            return result;
+            return null;
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,502 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    // Generates the levels of detail of the sub objects with quadric error metrics edge collapses:
+    // Garland, Heckbert, "Surface Simplification Using Quadric Error Metrics", 1997
+    // The levels of detail reuse the vertex buffer of the mesh: an edge is collapsed onto one of its vertices
+    // and vertices on UV seams, open borders and sub object borders are never moved so the simplified sub
+    // objects keep their texture mapping and still match their neighbours.
+    public static class MeshSimplifier
+    {
+        public const int MaxLodCount = 4;
+
+        // Each level of detail targets this ratio of the triangles of the previous one
+        private const float LodReductionRatio = 0.5f;
+
+        // Levels of detail are not generated below this triangle count or when they remove less than 10% of the triangles
+        private const int MinLodTriangleCount = 32;
+        private const float MinLodReduction = 0.9f;
+
+        private struct Quadric
+        {
+            public double A00, A01, A02, A11, A12, A22, B0, B1, B2, C;
+
+            public static Quadric FromPlane(Vector3 normal, float distance, float weight)
+            {
+                var result = new Quadric();
+
+                result.A00 = weight * normal.X * normal.X;
+                result.A01 = weight * normal.X * normal.Y;
+                result.A02 = weight * normal.X * normal.Z;
+                result.A11 = weight * normal.Y * normal.Y;
+                result.A12 = weight * normal.Y * normal.Z;
+                result.A22 = weight * normal.Z * normal.Z;
+                result.B0 = weight * normal.X * distance;
+                result.B1 = weight * normal.Y * distance;
+                result.B2 = weight * normal.Z * distance;
+                result.C = weight * distance * distance;
+
+                return result;
+            }
+
+            public void Add(in Quadric quadric)
+            {
+                this.A00 += quadric.A00;
+                this.A01 += quadric.A01;
+                this.A02 += quadric.A02;
+                this.A11 += quadric.A11;
+                this.A12 += quadric.A12;
+                this.A22 += quadric.A22;
+                this.B0 += quadric.B0;
+                this.B1 += quadric.B1;
+                this.B2 += quadric.B2;
+                this.C += quadric.C;
+            }
+
+            // Sum of the squared distances of the point to the planes of the quadric weighted by the area of their triangles
+            public double Evaluate(Vector3 point)
+            {
+                double x = point.X;
+                double y = point.Y;
+                double z = point.Z;
+
+                var result = this.A00 * x * x + 2.0 * this.A01 * x * y + 2.0 * this.A02 * x * z + this.A11 * y * y + 2.0 * this.A12 * y * z + this.A22 * z * z;
+                result += 2.0 * (this.B0 * x + this.B1 * y + this.B2 * z) + this.C;
+
+                return Math.Max(result, 0.0);
+            }
+        }
+
+        public static void GenerateLods(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var lockedVertices = ComputeLockedVertices(meshData);
+
+            var localVertexIndices = new int[meshData.Vertices.Count];
+            Array.Fill(localVertexIndices, -1);
+
+            var localVertices = new List<int>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                subObject.Lods.Clear();
+
+                var startIndex = (int)subObject.StartIndex;
+                var indexCount = (int)subObject.IndexCount - (int)subObject.IndexCount % 3;
+
+                if (indexCount / 3 < MinLodTriangleCount * 2)
+                {
+                    continue;
+                }
+
+                var indices = new int[indexCount];
+
+                for (var i = 0; i < indexCount; i++)
+                {
+                    var vertexIndex = (int)meshData.Indices[startIndex + i];
+
+                    if (localVertexIndices[vertexIndex] == -1)
+                    {
+                        localVertexIndices[vertexIndex] = localVertices.Count;
+                        localVertices.Add(vertexIndex);
+                    }
+
+                    indices[i] = localVertexIndices[vertexIndex];
+                }
+
+                var positions = new Vector3[localVertices.Count];
+                var isLocked = new bool[localVertices.Count];
+
+                for (var i = 0; i < localVertices.Count; i++)
+                {
+                    positions[i] = meshData.Vertices[localVertices[i]].Position;
+                    isLocked[i] = lockedVertices[localVertices[i]];
+                }
+
+                foreach (var (lodIndices, error) in SimplifyIndices(indices, positions, isLocked))
+                {
+                    var optimizedIndices = MeshOptimizer.OptimizeVertexCache(lodIndices, localVertices.Count);
+
+                    var lod = new MeshSubObjectLod();
+                    lod.StartIndex = (uint)meshData.Indices.Count;
+                    lod.IndexCount = (uint)optimizedIndices.Length;
+                    lod.Error = error;
+
+                    foreach (var index in optimizedIndices)
+                    {
+                        meshData.Indices.Add((uint)localVertices[index]);
+                    }
+
+                    subObject.Lods.Add(lod);
+                }
+
+                foreach (var vertexIndex in localVertices)
+                {
+                    localVertexIndices[vertexIndex] = -1;
+                }
+
+                localVertices.Clear();
+            }
+        }
+
+        // A vertex is locked when its position is shared with other vertices (UV or normal seam, other sub object)
+        // or when it lies on an open or non-manifold edge of its sub object
+        private static bool[] ComputeLockedVertices(MeshData meshData)
+        {
+            var result = new bool[meshData.Vertices.Count];
+
+            var positionIds = new Dictionary<Vector3, int>();
+            var vertexPositionIds = new int[meshData.Vertices.Count];
+            var positionVertices = new List<int>();
+
+            for (var i = 0; i < meshData.Vertices.Count; i++)
+            {
+                var position = meshData.Vertices[i].Position;
+
+                if (!positionIds.TryGetValue(position, out var positionId))
+                {
+                    positionId = positionIds.Count;
+                    positionIds.Add(position, positionId);
+                    positionVertices.Add(i);
+                }
+
+                else
+                {
+                    result[i] = true;
+                    result[positionVertices[positionId]] = true;
+                }
+
+                vertexPositionIds[i] = positionId;
+            }
+
+            var edgeCounts = new Dictionary<(int, int), int>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var startIndex = (int)subObject.StartIndex;
+                var endIndex = startIndex + (int)subObject.IndexCount - (int)subObject.IndexCount % 3;
+
+                edgeCounts.Clear();
+
+                for (var i = startIndex; i < endIndex; i += 3)
+                {
+                    for (var j = 0; j < 3; j++)
+                    {
+                        var edgeKey = ComputeEdgeKey(vertexPositionIds[meshData.Indices[i + j]], vertexPositionIds[meshData.Indices[i + (j + 1) % 3]]);
+                        edgeCounts.TryGetValue(edgeKey, out var edgeCount);
+                        edgeCounts[edgeKey] = edgeCount + 1;
+                    }
+                }
+
+                for (var i = startIndex; i < endIndex; i += 3)
+                {
+                    for (var j = 0; j < 3; j++)
+                    {
+                        var vertex0 = (int)meshData.Indices[i + j];
+                        var vertex1 = (int)meshData.Indices[i + (j + 1) % 3];
+
+                        if (edgeCounts[ComputeEdgeKey(vertexPositionIds[vertex0], vertexPositionIds[vertex1])] != 2)
+                        {
+                            result[vertex0] = true;
+                            result[vertex1] = true;
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // The levels of detail are snapshots of a single simplification, the quadrics are accumulated from
+        // the original triangles so the error of each level is measured against the original surface.
+        // The quadrics only order the collapses, the error of a level is the maximum distance between a collapsed
+        // vertex and the planes of the original triangles merged into it.
+        private static List<(int[] Indices, float Error)> SimplifyIndices(int[] sourceIndices, Vector3[] positions, bool[] isLocked)
+        {
+            var result = new List<(int[] Indices, float Error)>();
+            var indices = (int[])sourceIndices.Clone();
+            var indexCount = indices.Length;
+            var vertexCount = positions.Length;
+
+            var quadrics = new Quadric[vertexCount];
+            var planes = new List<(Vector3 Normal, float Distance)>();
+            var vertexPlanes = new List<int>[vertexCount];
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                vertexPlanes[i] = new List<int>();
+            }
+
+            for (var i = 0; i < indexCount; i += 3)
+            {
+                var position0 = positions[indices[i]];
+                var normal = Vector3.Cross(positions[indices[i + 1]] - position0, positions[indices[i + 2]] - position0);
+                var normalLength = normal.Length();
+
+                if (normalLength == 0.0f)
+                {
+                    continue;
+                }
+
+                normal /= normalLength;
+
+                var distance = -Vector3.Dot(normal, position0);
+                var quadric = Quadric.FromPlane(normal, distance, normalLength * 0.5f);
+
+                for (var j = 0; j < 3; j++)
+                {
+                    quadrics[indices[i + j]].Add(quadric);
+                    vertexPlanes[indices[i + j]].Add(planes.Count);
+                }
+
+                planes.Add((normal, distance));
+            }
+
+            var adjacencyOffsets = new int[vertexCount + 1];
+            var adjacency = new int[indexCount];
+            var collapseTargets = new int[vertexCount];
+            var vertexStamps = new int[vertexCount];
+            var stamp = 0;
+            var planeStamps = new int[planes.Count];
+            var planeStamp = 0;
+            var maxError = 0.0f;
+
+            var candidateVertices = new List<(int Source, int Target)>();
+            var candidateCosts = new List<double>();
+
+            var previousTriangleCount = indexCount / 3;
+            var targetTriangleCount = (int)(previousTriangleCount * LodReductionRatio);
+
+            while (result.Count < MaxLodCount && targetTriangleCount >= MinLodTriangleCount)
+            {
+                BuildAdjacency(indices, indexCount, adjacencyOffsets, adjacency);
+
+                candidateVertices.Clear();
+                candidateCosts.Clear();
+
+                for (var i = 0; i < indexCount; i++)
+                {
+                    var vertex0 = indices[i];
+                    var vertex1 = indices[i - i % 3 + (i + 1) % 3];
+
+                    // Each edge is visited from its two triangles, the collapse is evaluated in both directions once
+                    if (vertex0 > vertex1 || (isLocked[vertex0] && isLocked[vertex1]))
+                    {
+                        continue;
+                    }
+
+                    var quadric = quadrics[vertex0];
+                    quadric.Add(quadrics[vertex1]);
+
+                    var cost0 = isLocked[vertex0] ? double.MaxValue : quadric.Evaluate(positions[vertex1]);
+                    var cost1 = isLocked[vertex1] ? double.MaxValue : quadric.Evaluate(positions[vertex0]);
+
+                    candidateVertices.Add((cost0 <= cost1) ? (vertex0, vertex1) : (vertex1, vertex0));
+                    candidateCosts.Add(Math.Min(cost0, cost1));
+                }
+
+                var sortedCandidates = candidateVertices.ToArray();
+                Array.Sort(candidateCosts.ToArray(), sortedCandidates);
+
+                for (var i = 0; i < vertexCount; i++)
+                {
+                    collapseTargets[i] = i;
+                }
+
+                // A collapse removes two triangles on a closed surface, the vertices around a collapse are not
+                // collapsed again in the same pass so that the flip test stays valid
+                var collapseLimit = (indexCount / 3 - targetTriangleCount + 1) / 2;
+                var collapseCount = 0;
+
+                stamp++;
+
+                for (var i = 0; i < sortedCandidates.Length && collapseCount < collapseLimit; i++)
+                {
+                    var (source, target) = sortedCandidates[i];
+
+                    if (vertexStamps[source] == stamp || vertexStamps[target] == stamp)
+                    {
+                        continue;
+                    }
+
+                    if (!IsCollapseValid(indices, adjacencyOffsets, adjacency, positions, source, target))
+                    {
+                        continue;
+                    }
+
+                    quadrics[target].Add(quadrics[source]);
+                    maxError = MathF.Max(maxError, MergePlanes(vertexPlanes[target], vertexPlanes[source], planes, positions[target], planeStamps, ++planeStamp));
+                    collapseTargets[source] = target;
+                    collapseCount++;
+
+                    for (var j = adjacencyOffsets[source]; j < adjacencyOffsets[source + 1]; j++)
+                    {
+                        var triangle = adjacency[j];
+
+                        vertexStamps[indices[triangle * 3]] = stamp;
+                        vertexStamps[indices[triangle * 3 + 1]] = stamp;
+                        vertexStamps[indices[triangle * 3 + 2]] = stamp;
+                    }
+                }
+
+                if (collapseCount == 0)
+                {
+                    // Locked vertices can prevent reaching the target, the level is kept if it is still worth it
+                    if (indexCount / 3 <= previousTriangleCount * MinLodReduction)
+                    {
+                        result.Add((CopyIndices(indices, indexCount), maxError));
+                    }
+
+                    break;
+                }
+
+                // Remaps the collapsed vertices and removes the degenerate triangles
+                var outputIndexCount = 0;
+
+                for (var i = 0; i < indexCount; i += 3)
+                {
+                    var vertex0 = collapseTargets[indices[i]];
+                    var vertex1 = collapseTargets[indices[i + 1]];
+                    var vertex2 = collapseTargets[indices[i + 2]];
+
+                    if (vertex0 != vertex1 && vertex1 != vertex2 && vertex2 != vertex0)
+                    {
+                        indices[outputIndexCount++] = vertex0;
+                        indices[outputIndexCount++] = vertex1;
+                        indices[outputIndexCount++] = vertex2;
+                    }
+                }
+
+                indexCount = outputIndexCount;
+
+                if (indexCount / 3 <= targetTriangleCount)
+                {
+                    result.Add((CopyIndices(indices, indexCount), maxError));
+
+                    previousTriangleCount = indexCount / 3;
+                    targetTriangleCount = (int)(previousTriangleCount * LodReductionRatio);
+                }
+            }
+
+            return result;
+        }
+
+        private static int[] CopyIndices(int[] indices, int indexCount)
+        {
+            var result = new int[indexCount];
+            Array.Copy(indices, result, indexCount);
+
+            return result;
+        }
+
+        // Adds the planes of the source vertex to the target vertex and returns the maximum distance between the target
+        // position and the merged planes
+        private static float MergePlanes(List<int> targetPlanes, List<int> sourcePlanes, List<(Vector3 Normal, float Distance)> planes, Vector3 position, int[] planeStamps, int stamp)
+        {
+            foreach (var plane in targetPlanes)
+            {
+                planeStamps[plane] = stamp;
+            }
+
+            foreach (var plane in sourcePlanes)
+            {
+                if (planeStamps[plane] != stamp)
+                {
+                    planeStamps[plane] = stamp;
+                    targetPlanes.Add(plane);
+                }
+            }
+
+            var result = 0.0f;
+
+            foreach (var plane in targetPlanes)
+            {
+                result = MathF.Max(result, MathF.Abs(Vector3.Dot(planes[plane].Normal, position) + planes[plane].Distance));
+            }
+
+            return result;
+        }
+
+        private static void BuildAdjacency(int[] indices, int indexCount, int[] adjacencyOffsets, int[] adjacency)
+        {
+            Array.Clear(adjacencyOffsets, 0, adjacencyOffsets.Length);
+
+            for (var i = 0; i < indexCount; i++)
+            {
+                adjacencyOffsets[indices[i] + 1]++;
+            }
+
+            for (var i = 1; i < adjacencyOffsets.Length; i++)
+            {
+                adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+            }
+
+            var writeOffsets = (int[])adjacencyOffsets.Clone();
+
+            for (var i = 0; i < indexCount; i++)
+            {
+                adjacency[writeOffsets[indices[i]]++] = i / 3;
+            }
+        }
+
+        // Rejects the collapses that flip or degenerate one of the remaining triangles around the source vertex
+        private static bool IsCollapseValid(int[] indices, int[] adjacencyOffsets, int[] adjacency, Vector3[] positions, int source, int target)
+        {
+            for (var i = adjacencyOffsets[source]; i < adjacencyOffsets[source + 1]; i++)
+            {
+                var triangle = adjacency[i];
+                var vertex0 = indices[triangle * 3];
+                var vertex1 = indices[triangle * 3 + 1];
+                var vertex2 = indices[triangle * 3 + 2];
+
+                if (vertex0 == target || vertex1 == target || vertex2 == target)
+                {
+                    continue;
+                }
+
+                var position0 = positions[vertex0];
+                var position1 = positions[vertex1];
+                var position2 = positions[vertex2];
+
+                var normal = Vector3.Cross(position1 - position0, position2 - position0);
+
+                if (vertex0 == source)
+                {
+                    position0 = positions[target];
+                }
+
+                else if (vertex1 == source)
+                {
+                    position1 = positions[target];
+                }
+
+                else
+                {
+                    position2 = positions[target];
+                }
+
+                var newNormal = Vector3.Cross(position1 - position0, position2 - position0);
+
+                if (Vector3.Dot(normal, newNormal) <= 1e-2f * normal.Length() * newNormal.Length())
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        // The hash of a long only xors its two halves which collides for every pair of small ids, a tuple is used instead
+        private static (int, int) ComputeEdgeKey(int positionId0, int positionId1)
+        {
+            return (positionId0 < positionId1) ? (positionId0, positionId1) : (positionId1, positionId0);
+        }
+    }
+}
@@ -0,0 +1,316 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Numerics;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    public enum MeshVertexFormat
+    {
+        // Position, normal and texture coordinates as 32-bit floats (32 bytes)
+        Float = 0,
+
+        // Position as 16-bit unorm relative to the sub object bounding box, octahedral normal as 16-bit snorm
+        // and texture coordinates as 16-bit floats (16 bytes)
+        Compact = 1
+    }
+
+    public class VertexQuantizationError
+    {
+        public float MaxPositionError { get; set; }
+        public float MaxNormalErrorInDegrees { get; set; }
+        public float MaxTextureCoordinatesError { get; set; }
+    }
+
+    // Encodes the vertices of a mesh in the compact vertex format, the decoding must match DecodeCompactVertex in Common.h and Mesh.hlsl
+    public static class MeshVertexQuantizer
+    {
+        public const int CompactVertexSize = 16;
+
+        // Half precision keeps this error for texture coordinates in [-2, 2], meshes tiling textures further use the float format
+        public const float MaxTextureCoordinatesError = 1.0f / 2048.0f;
+
+        public static MeshVertexFormat SelectVertexFormat(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            foreach (var vertex in meshData.Vertices)
+            {
+                var textureCoordinates = vertex.TextureCoordinates;
+
+                if (!IsFinite(vertex.Position.X) || !IsFinite(vertex.Position.Y) || !IsFinite(vertex.Position.Z))
+                {
+                    return MeshVertexFormat.Float;
+                }
+
+                if (MathF.Abs(HalfToFloat(FloatToHalf(textureCoordinates.X)) - textureCoordinates.X) > MaxTextureCoordinatesError ||
+                    MathF.Abs(HalfToFloat(FloatToHalf(textureCoordinates.Y)) - textureCoordinates.Y) > MaxTextureCoordinatesError)
+                {
+                    return MeshVertexFormat.Float;
+                }
+            }
+
+            return MeshVertexFormat.Compact;
+        }
+
+        // Positions are quantized relative to the bounding box of their sub object and indices are stored relative
+        // to the sub object base vertex so a vertex cannot be shared by two sub objects, shared vertices are
+        // duplicated for each additional sub object. Only the index buffer is remapped so this must run before the
+        // meshlets are built.
+        public static int SplitSharedVertices(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            if (meshData.Meshlets.Count > 0)
+            {
+                throw new InvalidOperationException("Shared vertices must be split before the meshlets are built.");
+            }
+
+            var vertexOwners = new int[meshData.Vertices.Count];
+            Array.Fill(vertexOwners, -1);
+
+            var vertexCopies = new Dictionary<uint, uint>();
+            var result = 0;
+
+            for (var i = 0; i < meshData.MeshSubObjects.Count; i++)
+            {
+                var subObject = meshData.MeshSubObjects[i];
+
+                vertexCopies.Clear();
+
+                uint RemapVertex(uint vertexIndex)
+                {
+                    if (vertexIndex >= vertexOwners.Length || vertexOwners[vertexIndex] == i)
+                    {
+                        return vertexIndex;
+                    }
+
+                    if (vertexOwners[vertexIndex] == -1)
+                    {
+                        vertexOwners[vertexIndex] = i;
+                        return vertexIndex;
+                    }
+
+                    if (!vertexCopies.TryGetValue(vertexIndex, out var copyIndex))
+                    {
+                        copyIndex = (uint)meshData.Vertices.Count;
+                        meshData.Vertices.Add(meshData.Vertices[(int)vertexIndex]);
+                        vertexCopies.Add(vertexIndex, copyIndex);
+                        result++;
+                    }
+
+                    return copyIndex;
+                }
+
+                for (var j = subObject.StartIndex; j < subObject.StartIndex + subObject.IndexCount; j++)
+                {
+                    meshData.Indices[(int)j] = RemapVertex(meshData.Indices[(int)j]);
+                }
+            }
+
+            return result;
+        }
+
+        public static VertexQuantizationError WriteCompactVertices(BinaryWriter writer, MeshData meshData)
+        {
+            if (writer == null)
+            {
+                throw new ArgumentNullException(nameof(writer));
+            }
+
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            var vertexBoundingBoxes = new BoundingBox?[meshData.Vertices.Count];
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                for (var i = subObject.StartIndex; i < subObject.StartIndex + subObject.IndexCount; i++)
+                {
+                    vertexBoundingBoxes[(int)meshData.Indices[(int)i]] = subObject.BoundingBox;
+                }
+            }
+
+            var result = new VertexQuantizationError();
+            var minNormalDot = 1.0f;
+
+            for (var i = 0; i < meshData.Vertices.Count; i++)
+            {
+                var vertex = meshData.Vertices[i];
+                var boundingBox = vertexBoundingBoxes[i];
+
+                // Vertices that are not referenced by a sub object are never fetched
+                if (boundingBox == null)
+                {
+                    writer.Write(new byte[CompactVertexSize]);
+                    continue;
+                }
+
+                var extent = boundingBox.MaxPoint - boundingBox.MinPoint;
+                var quantizedPositionX = QuantizeUnorm16(vertex.Position.X, boundingBox.MinPoint.X, extent.X);
+                var quantizedPositionY = QuantizeUnorm16(vertex.Position.Y, boundingBox.MinPoint.Y, extent.Y);
+                var quantizedPositionZ = QuantizeUnorm16(vertex.Position.Z, boundingBox.MinPoint.Z, extent.Z);
+
+                var decodedPosition = boundingBox.MinPoint + new Vector3(quantizedPositionX, quantizedPositionY, quantizedPositionZ) / 65535.0f * extent;
+                var positionError = Vector3.Abs(decodedPosition - vertex.Position);
+                result.MaxPositionError = MathF.Max(result.MaxPositionError, MathF.Max(positionError.X, MathF.Max(positionError.Y, positionError.Z)));
+
+                var encodedNormal = EncodeOctahedralNormal(vertex.Normal);
+                var quantizedNormalX = (short)MathF.Round(Math.Clamp(encodedNormal.X, -1.0f, 1.0f) * 32767.0f);
+                var quantizedNormalY = (short)MathF.Round(Math.Clamp(encodedNormal.Y, -1.0f, 1.0f) * 32767.0f);
+
+                if (vertex.Normal.LengthSquared() > 0.0f)
+                {
+                    var decodedNormal = DecodeOctahedralNormal(new Vector2(MathF.Max(quantizedNormalX / 32767.0f, -1.0f), MathF.Max(quantizedNormalY / 32767.0f, -1.0f)));
+                    minNormalDot = MathF.Min(minNormalDot, Vector3.Dot(decodedNormal, Vector3.Normalize(vertex.Normal)));
+                }
+
+                var textureCoordinatesX = FloatToHalf(vertex.TextureCoordinates.X);
+                var textureCoordinatesY = FloatToHalf(vertex.TextureCoordinates.Y);
+
+                result.MaxTextureCoordinatesError = MathF.Max(result.MaxTextureCoordinatesError, MathF.Abs(HalfToFloat(textureCoordinatesX) - vertex.TextureCoordinates.X));
+                result.MaxTextureCoordinatesError = MathF.Max(result.MaxTextureCoordinatesError, MathF.Abs(HalfToFloat(textureCoordinatesY) - vertex.TextureCoordinates.Y));
+
+                writer.Write(quantizedPositionX);
+                writer.Write(quantizedPositionY);
+                writer.Write(quantizedPositionZ);
+                writer.Write((ushort)0);
+                writer.Write(quantizedNormalX);
+                writer.Write(quantizedNormalY);
+                writer.Write(textureCoordinatesX);
+                writer.Write(textureCoordinatesY);
+            }
+
+            result.MaxNormalErrorInDegrees = MathF.Acos(Math.Clamp(minNormalDot, -1.0f, 1.0f)) * 180.0f / MathF.PI;
+            return result;
+        }
+
+        private static Vector2 EncodeOctahedralNormal(Vector3 normal)
+        {
+            var length = MathF.Abs(normal.X) + MathF.Abs(normal.Y) + MathF.Abs(normal.Z);
+
+            if (length == 0.0f)
+            {
+                return Vector2.Zero;
+            }
+
+            var result = new Vector2(normal.X, normal.Y) / length;
+
+            // The lower hemisphere is folded over the diagonals
+            if (normal.Z < 0.0f)
+            {
+                result = new Vector2((1.0f - MathF.Abs(result.Y)) * SignNotZero(result.X), (1.0f - MathF.Abs(result.X)) * SignNotZero(result.Y));
+            }
+
+            return result;
+        }
+
+        private static Vector3 DecodeOctahedralNormal(Vector2 encodedNormal)
+        {
+            var result = new Vector3(encodedNormal.X, encodedNormal.Y, 1.0f - MathF.Abs(encodedNormal.X) - MathF.Abs(encodedNormal.Y));
+            var t = Math.Clamp(-result.Z, 0.0f, 1.0f);
+
+            result.X += (result.X >= 0.0f) ? -t : t;
+            result.Y += (result.Y >= 0.0f) ? -t : t;
+
+            return Vector3.Normalize(result);
+        }
+
+        private static float SignNotZero(float value)
+        {
+            return (value >= 0.0f) ? 1.0f : -1.0f;
+        }
+
+        // Round to nearest even conversion to IEEE 754 half precision
+        private static ushort FloatToHalf(float value)
+        {
+            var bits = BitConverter.SingleToInt32Bits(value);
+            var sign = (bits >> 16) & 0x8000;
+            var floatExponent = (bits >> 23) & 0xFF;
+            var mantissa = bits & 0x7FFFFF;
+
+            if (floatExponent == 0xFF)
+            {
+                return (ushort)(sign | 0x7C00 | ((mantissa != 0) ? 0x200 : 0));
+            }
+
+            var exponent = floatExponent - 127 + 15;
+
+            if (exponent >= 31)
+            {
+                return (ushort)(sign | 0x7C00);
+            }
+
+            if (exponent <= 0)
+            {
+                if (exponent < -10)
+                {
+                    return (ushort)sign;
+                }
+
+                mantissa |= 0x800000;
+
+                var shift = 14 - exponent;
+                var subnormal = mantissa >> shift;
+                var remainder = mantissa & ((1 << shift) - 1);
+                var halfway = 1 << (shift - 1);
+
+                if (remainder > halfway || (remainder == halfway && (subnormal & 1) != 0))
+                {
+                    subnormal++;
+                }
+
+                return (ushort)(sign | subnormal);
+            }
+
+            var result = (exponent << 10) | (mantissa >> 13);
+            var roundBits = mantissa & 0x1FFF;
+
+            // A carry out of the mantissa correctly increments the exponent, up to infinity
+            if (roundBits > 0x1000 || (roundBits == 0x1000 && (result & 1) != 0))
+            {
+                result++;
+            }
+
+            return (ushort)(sign | result);
+        }
+
+        private static float HalfToFloat(ushort value)
+        {
+            var sign = (value & 0x8000) != 0 ? -1.0f : 1.0f;
+            var exponent = (value >> 10) & 0x1F;
+            var mantissa = value & 0x3FF;
+
+            if (exponent == 0)
+            {
+                return sign * mantissa / 16777216.0f;
+            }
+
+            if (exponent == 31)
+            {
+                return (mantissa == 0) ? sign * float.PositiveInfinity : float.NaN;
+            }
+
+            return BitConverter.Int32BitsToSingle(((value & 0x8000) << 16) | ((exponent + 112) << 23) | (mantissa << 13));
+        }
+
+        private static bool IsFinite(float value)
+        {
+            return !float.IsNaN(value) && !float.IsInfinity(value);
+        }
+
+        private static ushort QuantizeUnorm16(float value, float minValue, float extent)
+        {
+            var normalizedValue = (extent > 0.0f) ? (value - minValue) / extent : 0.0f;
+            return (ushort)MathF.Round(Math.Clamp(normalizedValue, 0.0f, 1.0f) * 65535.0f);
+        }
+    }
+}
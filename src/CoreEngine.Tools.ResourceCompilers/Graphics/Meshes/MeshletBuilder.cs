@@ -0,0 +1,407 @@
+using System;
+using System.Collections.Generic;
+using System.Numerics;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
+{
+    // Splits the sub objects of a mesh into meshlets that match the mesh shader output limits of RenderMeshInstance
+    public static class MeshletBuilder
+    {
+        public const int MaxVertexCount = 64;
+        public const int MaxTriangleCount = 126;
+
+        // Weight of the normal deviation compared to the distance when choosing the next triangle of a meshlet,
+        // higher values produce tighter normal cones at the expense of rounder meshlets
+        private const float ConeWeight = 0.5f;
+
+        private class MeshletState
+        {
+            public List<int> Vertices { get; } = new List<int>();
+            public List<int> Triangles { get; } = new List<int>();
+            public Vector3 CentroidSum { get; set; }
+            public Vector3 NormalSum { get; set; }
+        }
+
+        public static void BuildMeshlets(MeshData meshData)
+        {
+            if (meshData == null)
+            {
+                throw new ArgumentNullException(nameof(meshData));
+            }
+
+            meshData.Meshlets.Clear();
+            meshData.MeshletVertexIndices.Clear();
+            meshData.MeshletTriangleIndices.Clear();
+
+            var localVertexIndices = new int[meshData.Vertices.Count];
+            Array.Fill(localVertexIndices, -1);
+
+            var localVertices = new List<int>();
+
+            foreach (var subObject in meshData.MeshSubObjects)
+            {
+                var startIndex = (int)subObject.StartIndex;
+                var indexCount = (int)subObject.IndexCount - (int)subObject.IndexCount % 3;
+
+                subObject.MeshletOffset = (uint)meshData.Meshlets.Count;
+
+                var indices = new int[indexCount];
+
+                for (var i = 0; i < indexCount; i++)
+                {
+                    var vertexIndex = (int)meshData.Indices[startIndex + i];
+
+                    if (localVertexIndices[vertexIndex] == -1)
+                    {
+                        localVertexIndices[vertexIndex] = localVertices.Count;
+                        localVertices.Add(vertexIndex);
+                    }
+
+                    indices[i] = localVertexIndices[vertexIndex];
+                }
+
+                var outputIndex = startIndex;
+
+                foreach (var meshletTriangles in BuildSubObjectMeshlets(meshData, indices, localVertices))
+                {
+                    var meshlet = new Meshlet();
+                    var meshletVertices = new List<int>();
+
+                    meshlet.VertexOffset = (uint)meshData.MeshletVertexIndices.Count;
+                    meshlet.TriangleOffset = (uint)meshData.MeshletTriangleIndices.Count;
+                    meshlet.TriangleCount = (uint)meshletTriangles.Count;
+
+                    foreach (var triangle in meshletTriangles)
+                    {
+                        var packedTriangle = 0u;
+
+                        for (var i = 0; i < 3; i++)
+                        {
+                            var vertexIndex = localVertices[indices[triangle * 3 + i]];
+                            var meshletVertexIndex = meshletVertices.IndexOf(vertexIndex);
+
+                            if (meshletVertexIndex == -1)
+                            {
+                                meshletVertexIndex = meshletVertices.Count;
+                                meshletVertices.Add(vertexIndex);
+                                meshData.MeshletVertexIndices.Add((uint)vertexIndex);
+                            }
+
+                            packedTriangle |= (uint)meshletVertexIndex << (i * 8);
+
+                            // The index buffer is rewritten in meshlet order for the renderers that don't use mesh shaders
+                            meshData.Indices[outputIndex++] = (uint)vertexIndex;
+                        }
+
+                        meshData.MeshletTriangleIndices.Add(packedTriangle);
+                    }
+
+                    meshlet.VertexCount = (uint)meshletVertices.Count;
+                    ComputeMeshletBounds(meshData, meshlet, meshletVertices, meshletTriangles, indices, localVertices);
+
+                    meshData.Meshlets.Add(meshlet);
+                }
+
+                subObject.MeshletCount = (uint)meshData.Meshlets.Count - subObject.MeshletOffset;
+
+                foreach (var vertexIndex in localVertices)
+                {
+                    localVertexIndices[vertexIndex] = -1;
+                }
+
+                localVertices.Clear();
+            }
+
+            MeshOptimizer.OptimizeVertexFetch(meshData);
+        }
+
+        // Greedy builder: each meshlet grows with the adjacent triangle that adds the fewest new vertices and then
+        // stays the closest to the meshlet centroid and normal. A new meshlet is seeded with the triangle that didn't
+        // fit or the next triangle in input order so the locality of the vertex cache optimization is kept.
+        private static List<List<int>> BuildSubObjectMeshlets(MeshData meshData, int[] indices, List<int> localVertices)
+        {
+            var triangleCount = indices.Length / 3;
+            var vertexCount = localVertices.Count;
+            var result = new List<List<int>>();
+
+            var adjacencyOffsets = new int[vertexCount + 1];
+            var liveTriangleCounts = new int[vertexCount];
+
+            foreach (var index in indices)
+            {
+                liveTriangleCounts[index]++;
+            }
+
+            for (var i = 0; i < vertexCount; i++)
+            {
+                adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveTriangleCounts[i];
+            }
+
+            var adjacency = new int[indices.Length];
+            var adjacencyFill = new int[vertexCount];
+
+            for (var i = 0; i < indices.Length; i++)
+            {
+                var vertexIndex = indices[i];
+                adjacency[adjacencyOffsets[vertexIndex] + adjacencyFill[vertexIndex]++] = i / 3;
+            }
+
+            var triangleCentroids = new Vector3[triangleCount];
+            var triangleNormals = new Vector3[triangleCount];
+
+            for (var i = 0; i < triangleCount; i++)
+            {
+                var position1 = meshData.Vertices[localVertices[indices[i * 3]]].Position;
+                var position2 = meshData.Vertices[localVertices[indices[i * 3 + 1]]].Position;
+                var position3 = meshData.Vertices[localVertices[indices[i * 3 + 2]]].Position;
+
+                var normal = Vector3.Cross(position2 - position1, position3 - position1);
+                var normalLength = normal.Length();
+
+                triangleCentroids[i] = (position1 + position2 + position3) / 3.0f;
+                triangleNormals[i] = (normalLength > 0.0f) ? normal / normalLength : Vector3.Zero;
+            }
+
+            var isTriangleEmitted = new bool[triangleCount];
+            var meshletVertexStamps = new int[vertexCount];
+            var meshletStamp = 1;
+            var nextInputTriangle = 0;
+
+            var meshlet = new MeshletState();
+            var nextTriangle = -1;
+
+            for (var emittedTriangleCount = 0; emittedTriangleCount < triangleCount; emittedTriangleCount++)
+            {
+                if (nextTriangle == -1)
+                {
+                    while (isTriangleEmitted[nextInputTriangle])
+                    {
+                        nextInputTriangle++;
+                    }
+
+                    nextTriangle = nextInputTriangle;
+                }
+
+                var newVertexCount = CountNewVertices(indices, nextTriangle, meshletVertexStamps, meshletStamp);
+
+                if (meshlet.Vertices.Count + newVertexCount > MaxVertexCount || meshlet.Triangles.Count + 1 > MaxTriangleCount)
+                {
+                    result.Add(meshlet.Triangles);
+
+                    meshlet = new MeshletState();
+                    meshletStamp++;
+                }
+
+                isTriangleEmitted[nextTriangle] = true;
+                meshlet.Triangles.Add(nextTriangle);
+                meshlet.CentroidSum += triangleCentroids[nextTriangle];
+                meshlet.NormalSum += triangleNormals[nextTriangle];
+
+                for (var i = 0; i < 3; i++)
+                {
+                    var vertexIndex = indices[nextTriangle * 3 + i];
+
+                    if (meshletVertexStamps[vertexIndex] != meshletStamp)
+                    {
+                        meshletVertexStamps[vertexIndex] = meshletStamp;
+                        meshlet.Vertices.Add(vertexIndex);
+                    }
+
+                    RemoveAdjacentTriangle(adjacency, adjacencyOffsets, liveTriangleCounts, vertexIndex, nextTriangle);
+                }
+
+                nextTriangle = FindBestAdjacentTriangle(meshlet, indices, adjacency, adjacencyOffsets, liveTriangleCounts, meshletVertexStamps, meshletStamp, triangleCentroids, triangleNormals);
+            }
+
+            if (meshlet.Triangles.Count > 0)
+            {
+                result.Add(meshlet.Triangles);
+            }
+
+            return result;
+        }
+
+        private static int FindBestAdjacentTriangle(MeshletState meshlet, int[] indices, int[] adjacency, int[] adjacencyOffsets, int[] liveTriangleCounts, int[] meshletVertexStamps, int meshletStamp, Vector3[] triangleCentroids, Vector3[] triangleNormals)
+        {
+            var meshletCentroid = meshlet.CentroidSum / meshlet.Triangles.Count;
+            var meshletNormalLength = meshlet.NormalSum.Length();
+            var meshletNormal = (meshletNormalLength > 0.0f) ? meshlet.NormalSum / meshletNormalLength : Vector3.Zero;
+
+            var result = -1;
+            var bestNewVertexCount = int.MaxValue;
+            var bestScore = float.MaxValue;
+
+            foreach (var vertexIndex in meshlet.Vertices)
+            {
+                var adjacencyStart = adjacencyOffsets[vertexIndex];
+                var adjacencyEnd = adjacencyStart + liveTriangleCounts[vertexIndex];
+
+                for (var i = adjacencyStart; i < adjacencyEnd; i++)
+                {
+                    var triangle = adjacency[i];
+                    var newVertexCount = CountNewVertices(indices, triangle, meshletVertexStamps, meshletStamp);
+
+                    if (newVertexCount > bestNewVertexCount)
+                    {
+                        continue;
+                    }
+
+                    var distance = Vector3.Distance(triangleCentroids[triangle], meshletCentroid);
+                    var score = distance * (1.0f + ConeWeight * (1.0f - Vector3.Dot(triangleNormals[triangle], meshletNormal)));
+
+                    if (newVertexCount < bestNewVertexCount || score < bestScore)
+                    {
+                        result = triangle;
+                        bestNewVertexCount = newVertexCount;
+                        bestScore = score;
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        private static int CountNewVertices(int[] indices, int triangle, int[] meshletVertexStamps, int meshletStamp)
+        {
+            var result = 0;
+
+            for (var i = 0; i < 3; i++)
+            {
+                if (meshletVertexStamps[indices[triangle * 3 + i]] != meshletStamp)
+                {
+                    result++;
+                }
+            }
+
+            return result;
+        }
+
+        private static void RemoveAdjacentTriangle(int[] adjacency, int[] adjacencyOffsets, int[] liveTriangleCounts, int vertexIndex, int triangle)
+        {
+            var adjacencyStart = adjacencyOffsets[vertexIndex];
+            var adjacencyEnd = adjacencyStart + liveTriangleCounts[vertexIndex];
+
+            for (var i = adjacencyStart; i < adjacencyEnd; i++)
+            {
+                if (adjacency[i] == triangle)
+                {
+                    adjacency[i] = adjacency[adjacencyEnd - 1];
+                    liveTriangleCounts[vertexIndex]--;
+                    break;
+                }
+            }
+        }
+
+        private static void ComputeMeshletBounds(MeshData meshData, Meshlet meshlet, List<int> meshletVertices, List<int> meshletTriangles, int[] indices, List<int> localVertices)
+        {
+            // Bounding sphere (Ritter): start from the most distant pair of axis extreme points and grow to fit all vertices
+            var minPoints = new Vector3[3];
+            var maxPoints = new Vector3[3];
+            var firstPosition = meshData.Vertices[meshletVertices[0]].Position;
+
+            for (var i = 0; i < 3; i++)
+            {
+                minPoints[i] = firstPosition;
+                maxPoints[i] = firstPosition;
+            }
+
+            foreach (var vertexIndex in meshletVertices)
+            {
+                var position = meshData.Vertices[vertexIndex].Position;
+
+                if (position.X < minPoints[0].X) minPoints[0] = position;
+                if (position.Y < minPoints[1].Y) minPoints[1] = position;
+                if (position.Z < minPoints[2].Z) minPoints[2] = position;
+                if (position.X > maxPoints[0].X) maxPoints[0] = position;
+                if (position.Y > maxPoints[1].Y) maxPoints[1] = position;
+                if (position.Z > maxPoints[2].Z) maxPoints[2] = position;
+            }
+
+            var extremeAxis = 0;
+
+            for (var i = 1; i < 3; i++)
+            {
+                if (Vector3.DistanceSquared(minPoints[i], maxPoints[i]) > Vector3.DistanceSquared(minPoints[extremeAxis], maxPoints[extremeAxis]))
+                {
+                    extremeAxis = i;
+                }
+            }
+
+            var center = (minPoints[extremeAxis] + maxPoints[extremeAxis]) * 0.5f;
+            var radius = Vector3.Distance(minPoints[extremeAxis], maxPoints[extremeAxis]) * 0.5f;
+
+            foreach (var vertexIndex in meshletVertices)
+            {
+                var position = meshData.Vertices[vertexIndex].Position;
+                var distance = Vector3.Distance(position, center);
+
+                if (distance > radius)
+                {
+                    var newRadius = (radius + distance) * 0.5f;
+                    center += (position - center) * ((newRadius - radius) / distance);
+                    radius = newRadius;
+                }
+            }
+
+            meshlet.BoundingSphereCenter = center;
+            meshlet.BoundingSphereRadius = radius;
+
+            // Normal cone: average of the triangle normals, the cutoff is the sine of the largest deviation to the axis
+            // so that a meshlet is back facing when dot(center - camera, axis) >= cutoff * distance + radius
+            var normals = new List<Vector3>(meshletTriangles.Count);
+            var axis = Vector3.Zero;
+
+            foreach (var triangle in meshletTriangles)
+            {
+                var position1 = meshData.Vertices[localVertices[indices[triangle * 3]]].Position;
+                var position2 = meshData.Vertices[localVertices[indices[triangle * 3 + 1]]].Position;
+                var position3 = meshData.Vertices[localVertices[indices[triangle * 3 + 2]]].Position;
+
+                var normal = Vector3.Cross(position2 - position1, position3 - position1);
+                var normalLength = normal.Length();
+
+                if (normalLength > 0.0f)
+                {
+                    normals.Add(normal / normalLength);
+                    axis += normal / normalLength;
+                }
+            }
+
+            var axisLength = axis.Length();
+            var minDot = 1.0f;
+
+            if (axisLength > 0.0f)
+            {
+                axis /= axisLength;
+
+                foreach (var normal in normals)
+                {
+                    minDot = MathF.Min(minDot, Vector3.Dot(normal, axis));
+                }
+            }
+
+            else
+            {
+                minDot = -1.0f;
+            }
+
+            // Wide cones almost never cull anything so they are disabled to save the test on the GPU
+            var cutoff = (minDot <= 0.1f) ? 1.0f : MathF.Sqrt(1.0f - minDot * minDot);
+
+            var axisX = QuantizeSnorm8(axis.X);
+            var axisY = QuantizeSnorm8(axis.Y);
+            var axisZ = QuantizeSnorm8(axis.Z);
+
+            // The quantization error of the axis is added to the cutoff to keep the culling conservative
+            var axisError = MathF.Abs(axisX / 127.0f - axis.X) + MathF.Abs(axisY / 127.0f - axis.Y) + MathF.Abs(axisZ / 127.0f - axis.Z);
+            var quantizedCutoff = (cutoff >= 1.0f) ? 127 : Math.Min(127, (int)(127.0f * (cutoff + axisError)) + 1);
+
+            meshlet.PackedCone = (uint)(byte)axisX | ((uint)(byte)axisY << 8) | ((uint)(byte)axisZ << 16) | ((uint)(byte)quantizedCutoff << 24);
+        }
+
+        private static sbyte QuantizeSnorm8(float value)
+        {
+            return (sbyte)MathF.Round(Math.Clamp(value, -1.0f, 1.0f) * 127.0f);
+        }
+    }
+}
@@ -1,149 +1,183 @@
 using System;
+using System.Buffers.Text;
+using System.Collections.Generic;
 using System.IO;
-using System.Threading.Tasks;
+using System.Numerics;
 using System.Text;
+using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
-using System.Numerics;
-using System.Globalization;
-using System.Collections.Generic;
 
 namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
 {
+    // Face element indices are 1-based and 0 means that the element is not present. Relative (negative)
+    // indices are stored as chunk local indices offset by ObjMeshDataReader.RelativeIndexBias.
     struct FaceElement
     {
-        public uint VertexIndex;
-        public uint TextureCoordinatesIndex;
-        public uint NormalIndex;
+        public int VertexIndex;
+        public int TextureCoordinatesIndex;
+        public int NormalIndex;
     }
 
     public class ObjMeshDataReader : MeshDataReader
     {
+        private enum ObjChunkEventType
+        {
+            Group,
+            UseMaterial
+        }
+
+        private struct ObjChunkEvent
+        {
+            public ObjChunkEventType Type;
+            public int FaceElementOffset;
+            public string Name;
+        }
+
+        // Result of the parsing of a range of lines, chunks are parsed in parallel and merged in file order
+        private class ObjChunk
+        {
+            public ObjChunk(int start, int length)
+            {
+                this.Start = start;
+                this.Length = length;
+
+                // Rough capacity estimation (lines are about 32 bytes long and spread between 4 lists)
+                // to avoid most of the list reallocations
+                var estimatedElementCount = length / 128;
+
+                this.Vertices = new List<Vector3>(estimatedElementCount);
+                this.VertexNormals = new List<Vector3>(estimatedElementCount);
+                this.VertexTextureCoordinates = new List<Vector3>(estimatedElementCount);
+                this.FaceElements = new List<FaceElement>(estimatedElementCount);
+                this.Events = new List<ObjChunkEvent>();
+            }
+
+            public int Start { get; }
+            public int Length { get; }
+            public List<Vector3> Vertices { get; }
+            public List<Vector3> VertexNormals { get; }
+            public List<Vector3> VertexTextureCoordinates { get; }
+            public List<FaceElement> FaceElements { get; }
+            public List<ObjChunkEvent> Events { get; }
+        }
+
+        // Range of face elements that share the same vertex deduplication dictionary
+        private struct VertexSegment
+        {
+            public int Start;
+            public int Length;
+        }
+
+        private const int MinChunkSize = 1024 * 1024;
+        private const int RelativeIndexBias = int.MinValue / 2;
+
+        private static ReadOnlySpan<byte> UseMaterialKeyword => new byte[] { (byte)'u', (byte)'s', (byte)'e', (byte)'m', (byte)'t', (byte)'l' };
+
         private bool invertHandedness = true;
 
         public override Task<MeshData?> ReadAsync(ReadOnlyMemory<byte> sourceData)
         {
-            // TODO: Use Disney osOcean.obj to test performances
             // FIXME: Disney obj files use Catmull-Clark subdivision surfaces
 
-            var result = new MeshData();
+            var chunks = SplitChunks(sourceData.Span);
 
-            var vertexDictionary = new Dictionary<MeshVertex, uint>();
-            var vertexList = new List<Vector3>();
-            var vertexNormalList = new List<Vector3>();
-            var vertexTextureCoordinatesList = new List<Vector3>();
+            Parallel.For(0, chunks.Length, i =>
+            {
+                ParseChunk(chunks[i], sourceData.Span.Slice(chunks[i].Start, chunks[i].Length));
+            });
 
-            MeshSubObject? currentSubObject = null;
+            return Task.FromResult<MeshData?>(MergeChunks(chunks));
+        }
 
-            // TODO: Try to avoid the ToArray call that copy the buffer to the MemoryStream
-            using var reader = new StreamReader(new MemoryStream(sourceData.ToArray()));
-            
-            while (!reader.EndOfStream)
-            {
-                var line = reader.ReadLine()!;
+        private static ObjChunk[] SplitChunks(ReadOnlySpan<byte> data)
+        {
+            var chunkSize = Math.Max(MinChunkSize, data.Length / (Environment.ProcessorCount * 4));
+            var chunks = new List<ObjChunk>();
+            var start = 0;
 
-                // TODO: Wait for the Span<char> split method that is currenctly in dev
-                var lineParts = line.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+            while (start < data.Length)
+            {
+                var end = Math.Min(start + chunkSize, data.Length);
 
-                if (lineParts.Length > 1)
+                // Chunks always end on a line boundary
+                if (end < data.Length)
                 {
-                    if (lineParts[0] == "g")
-                    {
-                        if (currentSubObject != null)
-                        {
-                            currentSubObject.IndexCount = (uint)result.Indices.Count - currentSubObject.StartIndex;
-                            
-                            if (currentSubObject.IndexCount > 0)
-                            {
-                                result.MeshSubObjects.Add(currentSubObject);
-                            }
-                        }
+                    var lineEnd = data.Slice(end).IndexOf((byte)'\n');
+                    end = (lineEnd == -1) ? data.Length : end + lineEnd + 1;
+                }
 
-                        currentSubObject = new MeshSubObject();
-                        currentSubObject.StartIndex = (uint)result.Indices.Count;
-                        vertexDictionary.Clear();
-                    }
+                chunks.Add(new ObjChunk(start, end - start));
+                start = end;
+            }
 
-                    if (lineParts[0] == "v")
-                    {
-                        ParseVectorElement(vertexList, line.AsSpan());
-                    }
+            return chunks.ToArray();
+        }
 
-                    else if (lineParts[0] == "vn")
-                    {
-                        ParseVectorElement(vertexNormalList, line.AsSpan());
-                    }
+        private void ParseChunk(ObjChunk chunk, ReadOnlySpan<byte> data)
+        {
+            while (data.Length > 0)
+            {
+                var lineEnd = data.IndexOf((byte)'\n');
+                var line = (lineEnd == -1) ? data : data.Slice(0, lineEnd);
+                data = (lineEnd == -1) ? ReadOnlySpan<byte>.Empty : data.Slice(lineEnd + 1);
 
-                    else if (lineParts[0] == "vt")
-                    {
-                        ParseVectorElement(vertexTextureCoordinatesList, line.AsSpan());
-                    }
+                var keyword = ReadToken(ref line);
 
-                    else if (lineParts[0] == "f")
-                    {
-                        ParseFace(result, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, line.AsSpan());
-                    }
+                if (keyword.Length == 0 || keyword[0] == '#' || SkipWhitespace(line).Length == 0)
+                {
+                    continue;
+                }
 
-                    else if (currentSubObject != null && lineParts[0] == "usemtl")
-                    {
-                        if (((uint)result.Indices.Count - currentSubObject.StartIndex) > 0)
-                        {
-                            if (currentSubObject != null)
-                            {
-                                currentSubObject.IndexCount = (uint)result.Indices.Count - currentSubObject.StartIndex;
-                                
-                                if (currentSubObject.IndexCount > 0)
-                                {
-                                    result.MeshSubObjects.Add(currentSubObject);
-                                }
-                            }
-
-                            currentSubObject = new MeshSubObject();
-                            currentSubObject.StartIndex = (uint)result.Indices.Count;
-                            vertexDictionary.Clear();
-
-                            currentSubObject.MaterialPath = lineParts[1];
-                        }
+                if (keyword.Length == 1 && keyword[0] == 'v')
+                {
+                    chunk.Vertices.Add(ParseVectorElement(line));
+                }
 
-                        else
-                        {
-                            currentSubObject.MaterialPath = lineParts[1];
-                        }
-                    }
+                else if (keyword.Length == 2 && keyword[0] == 'v' && keyword[1] == 'n')
+                {
+                    chunk.VertexNormals.Add(ParseVectorElement(line));
                 }
-            }
 
-            if (currentSubObject != null)
-            {
-                currentSubObject.IndexCount = (uint)result.Indices.Count - currentSubObject.StartIndex;
+                else if (keyword.Length == 2 && keyword[0] == 'v' && keyword[1] == 't')
+                {
+                    chunk.VertexTextureCoordinates.Add(ParseVectorElement(line));
+                }
 
-                if (currentSubObject.IndexCount > 0)
+                else if (keyword.Length == 1 && keyword[0] == 'f')
                 {
-                    result.MeshSubObjects.Add(currentSubObject);
+                    ParseFace(chunk, line);
+                }
+
+                else if (keyword.Length == 1 && keyword[0] == 'g')
+                {
+                    chunk.Events.Add(new ObjChunkEvent { Type = ObjChunkEventType.Group, FaceElementOffset = chunk.FaceElements.Count, Name = string.Empty });
                 }
-            }
 
-            return Task.FromResult<MeshData?>(result);
+                else if (keyword.SequenceEqual(UseMaterialKeyword))
+                {
+                    var materialName = Encoding.UTF8.GetString(ReadToken(ref line));
+                    chunk.Events.Add(new ObjChunkEvent { Type = ObjChunkEventType.UseMaterial, FaceElementOffset = chunk.FaceElements.Count, Name = materialName });
+                }
+            }
         }
 
-        private void ParseVectorElement(List<Vector3> vectorList, ReadOnlySpan<char> line)
+        private Vector3 ParseVectorElement(ReadOnlySpan<byte> line)
         {
-            // TODO: Wait for the Span<char> split method that is currenctly in dev
-
-            var stringLine = line.ToString();
-            var lineParts = stringLine.Split(' ', StringSplitOptions.RemoveEmptyEntries);
+            var x = ParseFloat(ReadToken(ref line));
+            var yToken = ReadToken(ref line);
 
-            if (lineParts.Length < 3)
+            if (yToken.Length == 0)
             {
-                throw new InvalidDataException("Invalid obj vertor line");
+                throw new InvalidDataException("Invalid obj vector line");
             }
 
-            var x = float.Parse(lineParts[1], CultureInfo.InvariantCulture);
-            var y = float.Parse(lineParts[2], CultureInfo.InvariantCulture);
+            var y = ParseFloat(yToken);
             var z = 0.0f;
-            
-            if (lineParts.Length > 3)
+            var zToken = ReadToken(ref line);
+
+            if (zToken.Length > 0)
             {
-                z = float.Parse(lineParts[3], CultureInfo.InvariantCulture);
+                z = ParseFloat(zToken);
             }
 
             if (this.invertHandedness)
@@ -151,119 +185,414 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Meshes
                 z = -z;
             }
 
-            vectorList.Add(new Vector3(x, y , z));
+            return new Vector3(x, y, z);
         }
 
-        private void ParseFace(MeshData meshData, Dictionary<MeshVertex, uint> vertexDictionary, List<Vector3> vertexList, List<Vector3> vertexNormalList, List<Vector3> vertexTextureCoordinatesList, ReadOnlySpan<char> line)
+        private void ParseFace(ObjChunk chunk, ReadOnlySpan<byte> line)
         {
-            // TODO: Wait for the Span<char> split method that is currenctly in dev
+            var element1 = ParseFaceElement(chunk, ReadToken(ref line));
+            var previousElement = ParseFaceElement(chunk, ReadToken(ref line));
+            var elementToken = ReadToken(ref line);
 
-            var stringLine = line.ToString();
-            var lineParts = stringLine.Split(' ', StringSplitOptions.RemoveEmptyEntries);
-
-            if (lineParts.Length < 4)
+            if (elementToken.Length == 0)
             {
-                throw new InvalidDataException("Invalid obj vertex line");
+                throw new InvalidDataException("Invalid obj face line");
             }
 
-            var element1 = ParceFaceElement(lineParts[1]);
-            var element2 = ParceFaceElement(lineParts[2]);
-            var element3 = ParceFaceElement(lineParts[3]);
-
-            if (!this.invertHandedness)
+            // Polygons are triangulated as a fan around the first element
+            while (elementToken.Length > 0)
             {
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element1);
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element2);
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element3);
+                var element = ParseFaceElement(chunk, elementToken);
+
+                chunk.FaceElements.Add(element1);
+
+                if (!this.invertHandedness)
+                {
+                    chunk.FaceElements.Add(previousElement);
+                    chunk.FaceElements.Add(element);
+                }
+
+                else
+                {
+                    chunk.FaceElements.Add(element);
+                    chunk.FaceElements.Add(previousElement);
+                }
+
+                previousElement = element;
+                elementToken = ReadToken(ref line);
             }
+        }
 
-            else 
+        private static FaceElement ParseFaceElement(ObjChunk chunk, ReadOnlySpan<byte> faceElement)
+        {
+            if (faceElement.Length == 0)
             {
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element1);
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element3);
-                AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element2);
+                throw new InvalidDataException("Invalid obj face line");
             }
 
-            if (lineParts.Length == 5)
+            var result = new FaceElement();
+            var separatorIndex = faceElement.IndexOf((byte)'/');
+
+            result.VertexIndex = ParseIndex((separatorIndex == -1) ? faceElement : faceElement.Slice(0, separatorIndex), chunk.Vertices.Count);
+
+            if (separatorIndex != -1)
             {
-                var element4 = ParceFaceElement(lineParts[4]);
+                faceElement = faceElement.Slice(separatorIndex + 1);
+                separatorIndex = faceElement.IndexOf((byte)'/');
 
-                if (!this.invertHandedness)
+                result.TextureCoordinatesIndex = ParseIndex((separatorIndex == -1) ? faceElement : faceElement.Slice(0, separatorIndex), chunk.VertexTextureCoordinates.Count);
+
+                if (separatorIndex != -1)
                 {
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element1);
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element3);
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element4);
+                    result.NormalIndex = ParseIndex(faceElement.Slice(separatorIndex + 1), chunk.VertexNormals.Count);
                 }
+            }
 
-                else
+            return result;
+        }
+
+        private static int ParseIndex(ReadOnlySpan<byte> value, int chunkElementCount)
+        {
+            if (value.Length == 0)
+            {
+                return 0;
+            }
+
+            if (!Utf8Parser.TryParse(value, out int index, out var bytesConsumed) || bytesConsumed != value.Length || index == 0)
+            {
+                throw new InvalidDataException("Invalid obj face index");
+            }
+
+            // Relative indices can only be resolved once the element counts of the previous chunks are known
+            if (index < 0)
+            {
+                return RelativeIndexBias + chunkElementCount + index;
+            }
+
+            return index;
+        }
+
+        private static float ParseFloat(ReadOnlySpan<byte> value)
+        {
+            if (TryParseFloatFast(value, out var result))
+            {
+                return result;
+            }
+
+            if (!Utf8Parser.TryParse(value, out result, out var bytesConsumed) || bytesConsumed != value.Length)
+            {
+                throw new InvalidDataException("Invalid obj number");
+            }
+
+            return result;
+        }
+
+        private static readonly double[] powersOf10 = new double[]
+        {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        // Fast path for the plain decimal numbers written by most exporters. The mantissa and the power of 10 are
+        // exact doubles so the division is correctly rounded, the result is only rejected when the double is too
+        // close to a float rounding midpoint to guarantee the same result as float.Parse.
+        private static bool TryParseFloatFast(ReadOnlySpan<byte> value, out float result)
+        {
+            result = 0.0f;
+
+            var i = 0;
+            var isNegative = false;
+
+            if (i < value.Length && (value[i] == '-' || value[i] == '+'))
+            {
+                isNegative = (value[i] == '-');
+                i++;
+            }
+
+            var mantissa = 0UL;
+            var digitCount = 0;
+            var fractionDigitCount = 0;
+
+            while (i < value.Length && (uint)(value[i] - '0') <= 9)
+            {
+                mantissa = mantissa * 10 + (uint)(value[i] - '0');
+                digitCount++;
+                i++;
+            }
+
+            if (i < value.Length && value[i] == '.')
+            {
+                i++;
+
+                while (i < value.Length && (uint)(value[i] - '0') <= 9)
                 {
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element1);
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element4);
-                    AddFaceElement(meshData, vertexDictionary, vertexList, vertexNormalList, vertexTextureCoordinatesList, element3);
+                    mantissa = mantissa * 10 + (uint)(value[i] - '0');
+                    digitCount++;
+                    fractionDigitCount++;
+                    i++;
                 }
             }
+
+            // Exponents and long mantissas are handled by the general parser
+            if (i != value.Length || digitCount == 0 || digitCount > 15 || fractionDigitCount >= powersOf10.Length)
+            {
+                return false;
+            }
+
+            var doubleResult = mantissa / powersOf10[fractionDigitCount];
+
+            if (doubleResult != 0.0 && doubleResult < 1e-30)
+            {
+                return false;
+            }
+
+            // A float keeps 23 of the 52 mantissa bits, the 29 discarded bits tell how close to a midpoint the value is
+            var discardedBits = BitConverter.DoubleToInt64Bits(doubleResult) & 0x1FFFFFFF;
+
+            if (discardedBits >= 0x0FFFFFFF && discardedBits <= 0x10000001)
+            {
+                return false;
+            }
+
+            result = isNegative ? -(float)doubleResult : (float)doubleResult;
+            return true;
         }
 
-        private static void AddFaceElement(MeshData meshData, Dictionary<MeshVertex, uint> vertexDictionary, List<Vector3> vertexList, List<Vector3> vertexNormalList, List<Vector3> vertexTextureCoordinatesList, FaceElement faceElement)
+        private static ReadOnlySpan<byte> SkipWhitespace(ReadOnlySpan<byte> line)
         {
-            var vertex = ConstructVertex(vertexList, vertexNormalList, vertexTextureCoordinatesList, faceElement);
+            var i = 0;
 
-            if (!vertexDictionary.ContainsKey(vertex))
+            while (i < line.Length && IsWhitespace(line[i]))
             {
-                meshData.Indices.Add((uint)meshData.Vertices.Count);
-                vertexDictionary.Add(vertex, (uint)meshData.Vertices.Count);
-                meshData.Vertices.Add(vertex);
+                i++;
             }
 
-            else
+            return line.Slice(i);
+        }
+
+        private static ReadOnlySpan<byte> ReadToken(ref ReadOnlySpan<byte> line)
+        {
+            line = SkipWhitespace(line);
+
+            var length = 0;
+
+            while (length < line.Length && !IsWhitespace(line[length]))
             {
-                var vertexIndex = vertexDictionary[vertex];
-                meshData.Indices.Add((uint)vertexIndex);
+                length++;
             }
+
+            var result = line.Slice(0, length);
+            line = line.Slice(length);
+
+            return result;
         }
 
-        private static FaceElement ParceFaceElement(string faceElement)
+        private static bool IsWhitespace(byte value)
         {
-            var result = new FaceElement();
+            return value == ' ' || value == '\t' || value == '\r';
+        }
 
-            var faceElements = faceElement.Split('/');
+        private static MeshData MergeChunks(ObjChunk[] chunks)
+        {
+            var result = new MeshData();
+
+            var vertexBase = new int[chunks.Length];
+            var vertexNormalBase = new int[chunks.Length];
+            var vertexTextureCoordinatesBase = new int[chunks.Length];
+            var faceElementBase = new int[chunks.Length];
 
-            result.VertexIndex = uint.Parse(faceElements[0], CultureInfo.InvariantCulture);
+            var vertexCount = 0;
+            var vertexNormalCount = 0;
+            var vertexTextureCoordinatesCount = 0;
+            var faceElementCount = 0;
 
-            if (faceElements.Length > 1 && !string.IsNullOrEmpty(faceElements[1]))
+            for (var i = 0; i < chunks.Length; i++)
             {
-                result.TextureCoordinatesIndex = uint.Parse(faceElements[1], CultureInfo.InvariantCulture);
+                vertexBase[i] = vertexCount;
+                vertexNormalBase[i] = vertexNormalCount;
+                vertexTextureCoordinatesBase[i] = vertexTextureCoordinatesCount;
+                faceElementBase[i] = faceElementCount;
+
+                vertexCount += chunks[i].Vertices.Count;
+                vertexNormalCount += chunks[i].VertexNormals.Count;
+                vertexTextureCoordinatesCount += chunks[i].VertexTextureCoordinates.Count;
+                faceElementCount += chunks[i].FaceElements.Count;
             }
 
-            if (faceElements.Length > 2 && !string.IsNullOrEmpty(faceElements[2]))
+            var vertices = new Vector3[vertexCount];
+            var vertexNormals = new Vector3[vertexNormalCount];
+            var vertexTextureCoordinates = new Vector3[vertexTextureCoordinatesCount];
+            var faceElements = new FaceElement[faceElementCount];
+
+            // Face indices are converted to global 0-based indices (-1 when not present)
+            Parallel.For(0, chunks.Length, i =>
             {
-                result.NormalIndex = uint.Parse(faceElements[2], CultureInfo.InvariantCulture);
+                var chunk = chunks[i];
+
+                chunk.Vertices.CopyTo(vertices, vertexBase[i]);
+                chunk.VertexNormals.CopyTo(vertexNormals, vertexNormalBase[i]);
+                chunk.VertexTextureCoordinates.CopyTo(vertexTextureCoordinates, vertexTextureCoordinatesBase[i]);
+
+                for (var j = 0; j < chunk.FaceElements.Count; j++)
+                {
+                    var faceElement = chunk.FaceElements[j];
+
+                    faceElement.VertexIndex = ResolveIndex(faceElement.VertexIndex, vertexBase[i], vertexCount);
+                    faceElement.TextureCoordinatesIndex = ResolveIndex(faceElement.TextureCoordinatesIndex, vertexTextureCoordinatesBase[i], vertexTextureCoordinatesCount);
+                    faceElement.NormalIndex = ResolveIndex(faceElement.NormalIndex, vertexNormalBase[i], vertexNormalCount);
+
+                    faceElements[faceElementBase[i] + j] = faceElement;
+                }
+            });
+
+            // Replay the group and material events in file order, each new sub object starts a new vertex segment
+            var segments = new List<VertexSegment>();
+            var segmentStart = 0;
+            MeshSubObject? currentSubObject = null;
+
+            void StartSubObject(int startIndex)
+            {
+                if (currentSubObject != null)
+                {
+                    currentSubObject.IndexCount = (uint)startIndex - currentSubObject.StartIndex;
+
+                    if (currentSubObject.IndexCount > 0)
+                    {
+                        result.MeshSubObjects.Add(currentSubObject);
+                    }
+                }
+
+                currentSubObject = new MeshSubObject();
+                currentSubObject.StartIndex = (uint)startIndex;
+
+                if (startIndex > segmentStart)
+                {
+                    segments.Add(new VertexSegment { Start = segmentStart, Length = startIndex - segmentStart });
+                    segmentStart = startIndex;
+                }
+            }
+
+            for (var i = 0; i < chunks.Length; i++)
+            {
+                foreach (var chunkEvent in chunks[i].Events)
+                {
+                    var eventIndex = faceElementBase[i] + chunkEvent.FaceElementOffset;
+
+                    if (chunkEvent.Type == ObjChunkEventType.Group)
+                    {
+                        StartSubObject(eventIndex);
+                    }
+
+                    else if (currentSubObject != null)
+                    {
+                        if (eventIndex - currentSubObject.StartIndex > 0)
+                        {
+                            StartSubObject(eventIndex);
+                        }
+
+                        currentSubObject.MaterialPath = chunkEvent.Name;
+                    }
+                }
+            }
+
+            // Closes the last sub object and vertex segment
+            StartSubObject(faceElementCount);
+
+            // Vertices are deduplicated per segment so the segments can be processed in parallel
+            var indices = new uint[faceElementCount];
+            var segmentVertices = new List<MeshVertex>[segments.Count];
+
+            Parallel.For(0, segments.Count, () => new Dictionary<MeshVertex, uint>(), (i, loopState, vertexDictionary) =>
+            {
+                var segment = segments[i];
+                var segmentVertexList = new List<MeshVertex>();
+
+                // The dictionary is reused by all the segments processed by the same thread
+                vertexDictionary.Clear();
+
+                for (var j = segment.Start; j < segment.Start + segment.Length; j++)
+                {
+                    var vertex = ConstructVertex(vertices, vertexNormals, vertexTextureCoordinates, faceElements[j]);
+
+                    if (!vertexDictionary.TryGetValue(vertex, out var vertexIndex))
+                    {
+                        vertexIndex = (uint)segmentVertexList.Count;
+                        vertexDictionary.Add(vertex, vertexIndex);
+                        segmentVertexList.Add(vertex);
+                    }
+
+                    indices[j] = vertexIndex;
+                }
+
+                segmentVertices[i] = segmentVertexList;
+                return vertexDictionary;
+            }, vertexDictionary => { });
+
+            var totalVertexCount = 0;
+
+            foreach (var segmentVertexList in segmentVertices)
+            {
+                totalVertexCount += segmentVertexList.Count;
+            }
+
+            result.Vertices.Capacity = totalVertexCount;
+            result.Indices.Capacity = faceElementCount;
+
+            for (var i = 0; i < segments.Count; i++)
+            {
+                var segment = segments[i];
+                var vertexOffset = (uint)result.Vertices.Count;
+
+                for (var j = segment.Start; j < segment.Start + segment.Length; j++)
+                {
+                    indices[j] += vertexOffset;
+                }
+
+                result.Vertices.AddRange(segmentVertices[i]);
+            }
+
+            result.Indices.AddRange(indices);
+            return result;
+        }
+
+        private static int ResolveIndex(int index, int chunkBase, int count)
+        {
+            if (index == 0)
+            {
+                return -1;
+            }
+
+            var result = (index < 0) ? chunkBase + (index - RelativeIndexBias) : index - 1;
+
+            if (result < 0 || result >= count)
+            {
+                throw new InvalidDataException("Invalid obj face index");
             }
 
             return result;
         }
-        
-        private static MeshVertex ConstructVertex(List<Vector3> vertexList, List<Vector3> vertexNormalList, List<Vector3> vertexTextureCoordinatesList, FaceElement faceElement)
+
+        private static MeshVertex ConstructVertex(Vector3[] vertices, Vector3[] vertexNormals, Vector3[] vertexTextureCoordinates, FaceElement faceElement)
         {
             var result = new MeshVertex();
 
-            if (faceElement.VertexIndex != 0)
+            if (faceElement.VertexIndex != -1)
             {
-                result.Position = vertexList[(int)faceElement.VertexIndex - 1];
+                result.Position = vertices[faceElement.VertexIndex];
             }
 
-            if (faceElement.NormalIndex != 0)
+            if (faceElement.NormalIndex != -1)
             {
-                result.Normal = vertexNormalList[(int)faceElement.NormalIndex - 1];
+                result.Normal = vertexNormals[faceElement.NormalIndex];
             }
 
-            if (faceElement.TextureCoordinatesIndex != 0)
+            if (faceElement.TextureCoordinatesIndex != -1)
             {
-                var textureCoordinates = vertexTextureCoordinatesList[(int)faceElement.TextureCoordinatesIndex - 1];
+                var textureCoordinates = vertexTextureCoordinates[faceElement.TextureCoordinatesIndex];
                 result.TextureCoordinates = new Vector2(textureCoordinates.X, -textureCoordinates.Y);
             }
 
             return result;
         }
     }
-}
\ No newline at end of file
+}
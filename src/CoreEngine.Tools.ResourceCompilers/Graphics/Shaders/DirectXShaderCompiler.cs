@@ -1,46 +1,46 @@
 using System;
-using System.Diagnostics;
 using System.Linq;
 using System.IO;
-using System.Reflection;
+using System.Text;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
-using Microsoft.Win32;
 using System.Collections.Generic;
+using System.Globalization;
 using System.Text.RegularExpressions;
 
 namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
 {
     public static class DirectXShaderCompiler
     {
-        public static async Task<ReadOnlyMemory<byte>?> CompileDirectXShaderAsync(ReadOnlyMemory<byte> data)
+        public static async Task<ReadOnlyMemory<byte>?> CompileDirectXShaderAsync(ReadOnlyMemory<byte> data, string sourcePath, string includeDirectory, ShaderBytecodeCache bytecodeCache, CompileCache? cache)
         {
-            Logger.WriteMessage("Compiling DirectX shader with command line tools");
-
-            string? windowsSdkToolPath = null;
+            if (sourcePath == null)
+            {
+                throw new ArgumentNullException(nameof(sourcePath));
+            }
 
-            using var key = Registry.LocalMachine.OpenSubKey(@"SOFTWARE\Microsoft\Windows Kits\Installed Roots");
-            
-            if (key != null)
+            if (includeDirectory == null)
             {
-                var windowsSdkPath = key.GetValue("KitsRoot10")?.ToString();
-                var windowsSdkVersion = key.GetSubKeyNames().OrderByDescending(x => x).FirstOrDefault();
+                throw new ArgumentNullException(nameof(includeDirectory));
+            }
 
-                windowsSdkToolPath = $@"{windowsSdkPath}bin\{windowsSdkVersion}\x64\";
+            if (bytecodeCache == null)
+            {
+                throw new ArgumentNullException(nameof(bytecodeCache));
             }
 
-            if (windowsSdkToolPath == null)
+            Logger.WriteMessage("Compiling DirectX shader with the DXC library");
+
+            if (!DxcLibrary.IsAvailable)
             {
+                Logger.WriteMessage("The DXC library (dxcompiler) was not found.", LogMessageTypes.Error);
                 return null;
             }
 
-            // TODO: Find a way to invoke compilation in-memory
-            // TODO: Put intermediate files into temp directory
-            // TODO: Remove intermediate files
             // TODO: Check debug profile
 
             var entryPoints = new List<string>();
-            var shaderContent = System.Text.Encoding.UTF8.GetString(data.ToArray());
+            var shaderContent = Encoding.UTF8.GetString(data.Span);
 
             var regex = new Regex(@"(VertexMain|PixelMain|AmplificationMain|MeshMain|ComputeMain|\[numthreads\(.*void\s(?<entryPoint>[^\(]*)\()", RegexOptions.Singleline);
             var matches = regex.Matches(shaderContent);
@@ -64,52 +64,58 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
 
             if (rootParameterMatch.Success)
             {
-                parameterCount = int.Parse(rootParameterMatch.Groups[1].Value);
+                parameterCount = int.Parse(rootParameterMatch.Groups[1].Value, CultureInfo.InvariantCulture);
                 Logger.WriteMessage($"Parameter Count: {rootParameterMatch.Groups[1].Value}");
             }
             // TODO: Parse local thread count
 
-            var tempFolder = Path.GetDirectoryName(Assembly.GetEntryAssembly()!.Location)!;
-            var inputShaderFile = Path.Combine(tempFolder, "tempShader.hlsl");
-            var outputShaderFile = Path.Combine(tempFolder, "tempShader.cso");
+            // The entry points and the root signature are independent so they are compiled concurrently,
+            // the include files are read once for all of them
+            var includeHandler = new ShaderIncludeHandler();
+            string preprocessedSource;
+
+            using (BuildTracer.BeginSpan("PreprocessShader", "Shader"))
+            {
+                preprocessedSource = ShaderPreprocessor.Preprocess(data.Span, sourcePath, new string[] { includeDirectory }, includeHandler);
+            }
+
+            Task<byte[]?> CompileVariantAsync(string name, string[] arguments, bool isOptional)
+            {
+                // The include directory is not part of the key, the includes are part of the preprocessed source
+                var key = ShaderBytecodeCache.ComputeKey(preprocessedSource, "DXC", DxcLibrary.LibraryIdentifier, string.Join(" ", arguments));
+                return bytecodeCache.GetOrCompileAsync(name, key, cache, () => Task.Run(() => CompileVariant(data, sourcePath, includeDirectory, includeHandler, name, arguments, isOptional)));
+            }
 
-            await File.WriteAllBytesAsync(inputShaderFile, data.ToArray());
+            var dxilTasks = entryPoints.Select(entryPoint => CompileVariantAsync($"{entryPoint} (DXIL)", GetEntryPointArguments(entryPoint, isSpirv: false), isOptional: false)).ToArray();
+            var spirvTasks = entryPoints.Select(entryPoint => CompileVariantAsync($"{entryPoint} (SPIR-V)", GetEntryPointArguments(entryPoint, isSpirv: true), isOptional: true)).ToArray();
+            var rootSignatureTask = CompileVariantAsync("RootSignature", new string[] { "-all-resources-bound", "-T", "rootsig_1_1", "-E", "RootSignatureDef" }, isOptional: false);
 
+            await Task.WhenAll(dxilTasks.Concat(spirvTasks).Append(rootSignatureTask));
+
+            // The tables are filled in the entry point order so that the output is deterministic
             var shaderTable = new Dictionary<string, byte[]>();
             var sprivShaderTable = new Dictionary<string, byte[]>();
 
-            foreach (var entryPoint in entryPoints)
+            for (var i = 0; i < entryPoints.Count; i++)
             {
-                var shaderData = await CompileShaderEntryPoint(entryPoint, inputShaderFile, outputShaderFile, isSpirv: false);
-                shaderTable.Add(entryPoint, shaderData);
-
-                shaderData = await CompileShaderEntryPoint(entryPoint, inputShaderFile, outputShaderFile, isSpirv: true);
+                var shaderData = dxilTasks[i].Result;
 
-                if (shaderData != null)
+                if (shaderData == null)
                 {
-                    sprivShaderTable.Add(entryPoint, shaderData);
+                    return null;
                 }
 
-                else
-                {
-                    sprivShaderTable.Add(entryPoint, Array.Empty<byte>());
-                }
+                shaderTable.Add(entryPoints[i], shaderData);
+                sprivShaderTable.Add(entryPoints[i], spirvTasks[i].Result ?? Array.Empty<byte>());
             }
 
-            using var buildProcess = new Process();
-            buildProcess.StartInfo.FileName = $".\\dxc\\dxc.exe";
-            buildProcess.StartInfo.Arguments = $"{inputShaderFile} -all-resources-bound -I ..\\..\\TestData\\System\\Shaders\\Lib\\ -T rootsig_1_1 -E RootSignatureDef -Fo {outputShaderFile}";
+            var rootSignatureData = rootSignatureTask.Result;
 
-            buildProcess.Start();
-            buildProcess.WaitForExit();
-
-            if (buildProcess.ExitCode != 0)
+            if (rootSignatureData == null)
             {
                 return null;
             }
 
-            var rootSignatureData = await File.ReadAllBytesAsync(outputShaderFile);
-
             var dxilOutput = WriteShaderTable(shaderTable, rootSignatureData, parameterCount);
             var sprivOutput = WriteShaderTable(sprivShaderTable, null, parameterCount);
 
@@ -124,10 +130,8 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
             return new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
         }
 
-        private static Task<byte[]?> CompileShaderEntryPoint(string entryPoint, string inputShaderFile, string outputShaderFile, bool isSpirv)
+        private static string[] GetEntryPointArguments(string entryPoint, bool isSpirv)
         {
-            // TODO: Use the DXC lib instead of the exe
-            
             var target = "cs_6_6";
 
             if (entryPoint == "VertexMain")
@@ -150,30 +154,43 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
                 target = "ms_6_6";
             }
 
-            Logger.WriteMessage($"Compiling entry point: {entryPoint} {target} (OutputFormat: {(isSpirv ? "SPIR-V" : "DXIL")})");
-            
-            using var buildProcess = new Process();
-            buildProcess.StartInfo.FileName = $".\\dxc\\dxc.exe";
-
             if (!isSpirv)
             {
-                buildProcess.StartInfo.Arguments = $"{inputShaderFile} -Zpr -all-resources-bound -Wno-ignored-attributes -I ..\\..\\TestData\\System\\Shaders\\Lib\\ -T {target} -E {entryPoint} -Fo {outputShaderFile}";
+                return new string[] { "-Zpr", "-all-resources-bound", "-Wno-ignored-attributes", "-T", target, "-E", entryPoint };
             }
 
-            else
-            {
-                buildProcess.StartInfo.Arguments = $"{inputShaderFile} -spirv -D VULKAN -Zpr -fspv-target-env=vulkan1.1 -fvk-use-dx-layout -all-resources-bound -I ..\\..\\TestData\\System\\Shaders\\Lib\\ -T {target} -E {entryPoint} -Fo {outputShaderFile}";
-            }
+            return new string[] { "-spirv", "-D", "VULKAN", "-Zpr", "-fspv-target-env=vulkan1.1", "-fvk-use-dx-layout", "-all-resources-bound", "-T", target, "-E", entryPoint };
+        }
+
+        private static byte[]? CompileVariant(ReadOnlyMemory<byte> data, string sourcePath, string includeDirectory, ShaderIncludeHandler includeHandler, string name, string[] arguments, bool isOptional)
+        {
+            Logger.WriteMessage($"Compiling {name}");
+
+            using var compileSpan = BuildTracer.BeginSpan($"Dxc {name}", "Shader");
+            compileSpan.SetArgument("arguments", string.Join(" ", arguments));
 
-            buildProcess.Start();
-            buildProcess.WaitForExit();
+            var result = DxcLibrary.Compile(data, sourcePath, arguments.Concat(new string[] { "-I", includeDirectory }).ToArray(), includeHandler);
+            WriteCompileMessages(name, result, isOptional);
 
-            if (buildProcess.ExitCode != 0)
+            // Optional variants that fail are cached empty so that they are not compiled again on each build
+            return (result.Data == null && isOptional) ? Array.Empty<byte>() : result.Data;
+        }
+
+        // SPIR-V failures don't fail the shader, an empty entry point is written instead
+        private static void WriteCompileMessages(string name, DxcCompileResult result, bool isOptional)
+        {
+            if (result.IsSuccess)
             {
-                return Task.FromResult<byte[]?>(null);
-            }            
+                if (result.Messages != null)
+                {
+                    Logger.WriteMessage($"{name}: {result.Messages}", LogMessageTypes.Warning);
+                }
+            }
 
-            return File.ReadAllBytesAsync(outputShaderFile);
+            else
+            {
+                Logger.WriteMessage($"{name}: {result.Messages ?? "Compilation failed."}", isOptional ? LogMessageTypes.Warning : LogMessageTypes.Error);
+            }
         }
 
         private static byte[] WriteShaderTable(Dictionary<string, byte[]> shaderTable, byte[]? rootSignatureData, int parameterCount)
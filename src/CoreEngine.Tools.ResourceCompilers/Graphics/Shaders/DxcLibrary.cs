@@ -0,0 +1,404 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Reflection;
+using System.Runtime.InteropServices;
+using System.Text;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
+{
+    public class DxcCompileResult
+    {
+        public DxcCompileResult(byte[]? data, string? messages)
+        {
+            this.Data = data;
+            this.Messages = messages;
+        }
+
+        public byte[]? Data { get; }
+        public string? Messages { get; }
+
+        public bool IsSuccess
+        {
+            get
+            {
+                return this.Data != null;
+            }
+        }
+    }
+
+    // Compiles shaders in-process with the DXC library (dxcompiler). COM interop is not available on Linux and macOS
+    // so the interfaces are called through their vtables. Outside of Windows only the DXC releases where IUnknown
+    // has the Windows layout are supported, older builds declared a virtual destructor that shifts the vtables.
+    public static class DxcLibrary
+    {
+        [StructLayout(LayoutKind.Sequential)]
+        private struct DxcBuffer
+        {
+            public IntPtr Pointer;
+            public UIntPtr Size;
+            public uint Encoding;
+        }
+
+        private class IncludeContext
+        {
+            public IncludeContext(ShaderIncludeHandler handler, IntPtr utils)
+            {
+                this.Handler = handler;
+                this.Utils = utils;
+            }
+
+            public ShaderIncludeHandler Handler { get; }
+            public IntPtr Utils { get; }
+        }
+
+        private delegate int DxcCreateInstanceDelegate(ref Guid classId, ref Guid interfaceId, out IntPtr instance);
+        private delegate int QueryInterfaceDelegate(IntPtr instance, ref Guid interfaceId, out IntPtr result);
+        private delegate uint ReferenceCountDelegate(IntPtr instance);
+        private delegate int CompileDelegate(IntPtr instance, ref DxcBuffer source, IntPtr[] arguments, uint argumentCount, IntPtr includeHandler, ref Guid interfaceId, out IntPtr result);
+        private delegate int GetStatusDelegate(IntPtr instance, out int status);
+        private delegate int GetBlobDelegate(IntPtr instance, out IntPtr blob);
+        private delegate IntPtr GetBufferPointerDelegate(IntPtr instance);
+        private delegate UIntPtr GetBufferSizeDelegate(IntPtr instance);
+        private delegate int CreateBlobDelegate(IntPtr instance, IntPtr data, uint size, uint codePage, out IntPtr blob);
+        private delegate int LoadSourceDelegate(IntPtr instance, IntPtr filename, out IntPtr includeSource);
+
+        private const uint Utf8CodePage = 65001;
+        private const int NoInterfaceError = unchecked((int)0x80004002);
+        private const int FailError = unchecked((int)0x80004005);
+        private const int FileNotFoundError = unchecked((int)0x80070002);
+
+        // Vtable slots, IUnknown uses the first three
+        private const int ReleaseSlot = 2;
+        private const int CompileSlot = 3;
+        private const int GetStatusSlot = 3;
+        private const int GetResultSlot = 4;
+        private const int GetErrorBufferSlot = 5;
+        private const int GetBufferPointerSlot = 3;
+        private const int GetBufferSizeSlot = 4;
+        private const int CreateBlobSlot = 6;
+
+        private static readonly Guid compilerClassId = new Guid("73e22d93-e6ce-47f3-b5bf-f0664f39c1b0");
+        private static readonly Guid utilsClassId = new Guid("6245d6af-66e0-48fd-80b4-4d271796748c");
+        private static readonly Guid compiler3InterfaceId = new Guid("228b4687-5a6a-4730-900c-9702b2203f54");
+        private static readonly Guid utilsInterfaceId = new Guid("4605c4cb-2019-492a-ada4-65f20bb7d67f");
+        private static readonly Guid operationResultInterfaceId = new Guid("cedb484a-d4e9-445a-b991-ca21ca157dc2");
+        private static readonly Guid unknownInterfaceId = new Guid("00000000-0000-0000-c000-000000000046");
+        private static readonly Guid includeHandlerInterfaceId = new Guid("7f61fc7d-950d-467f-b3e3-3c02fb49187c");
+
+        private static readonly bool isWindows = RuntimeInformation.IsOSPlatform(OSPlatform.Windows);
+        private static readonly Lazy<DxcCreateInstanceDelegate?> createInstance = new Lazy<DxcCreateInstanceDelegate?>(LoadLibrary);
+        private static string libraryIdentifier = string.Empty;
+
+        // The delegates of the include handler vtable must stay alive while the library can call them
+        private static readonly QueryInterfaceDelegate includeHandlerQueryInterface = IncludeHandlerQueryInterface;
+        private static readonly ReferenceCountDelegate includeHandlerReferenceCount = IncludeHandlerReferenceCount;
+        private static readonly LoadSourceDelegate includeHandlerLoadSource = IncludeHandlerLoadSource;
+        private static readonly Lazy<IntPtr> includeHandlerVtable = new Lazy<IntPtr>(CreateIncludeHandlerVtable);
+
+        public static bool IsAvailable
+        {
+            get
+            {
+                return createInstance.Value != null;
+            }
+        }
+
+        // Identifies the loaded library in the shader variant keys by the hash of its file, a library found in the
+        // system search paths is only identified by its name
+        public static string LibraryIdentifier
+        {
+            get
+            {
+                return IsAvailable ? libraryIdentifier : string.Empty;
+            }
+        }
+
+        // The source path is only used for the messages and to resolve the includes relative to the source
+        public static DxcCompileResult Compile(ReadOnlyMemory<byte> source, string sourcePath, IList<string> arguments, ShaderIncludeHandler includeHandler)
+        {
+            if (sourcePath == null)
+            {
+                throw new ArgumentNullException(nameof(sourcePath));
+            }
+
+            if (arguments == null)
+            {
+                throw new ArgumentNullException(nameof(arguments));
+            }
+
+            if (includeHandler == null)
+            {
+                throw new ArgumentNullException(nameof(includeHandler));
+            }
+
+            var compiler = IntPtr.Zero;
+            var utils = IntPtr.Zero;
+            var nativeArguments = new IntPtr[arguments.Count + 1];
+            var includeContext = new GCHandle();
+            var nativeIncludeHandler = IntPtr.Zero;
+            var result = IntPtr.Zero;
+
+            try
+            {
+                compiler = CreateInstance(compilerClassId, compiler3InterfaceId);
+                utils = CreateInstance(utilsClassId, utilsInterfaceId);
+                includeContext = GCHandle.Alloc(new IncludeContext(includeHandler, utils));
+
+                nativeArguments[0] = AllocateWideString(sourcePath);
+
+                for (var i = 0; i < arguments.Count; i++)
+                {
+                    nativeArguments[i + 1] = AllocateWideString(arguments[i]);
+                }
+
+                // The native include handler is a vtable pointer followed by the handle of its context
+                nativeIncludeHandler = Marshal.AllocHGlobal(IntPtr.Size * 2);
+                Marshal.WriteIntPtr(nativeIncludeHandler, includeHandlerVtable.Value);
+                Marshal.WriteIntPtr(nativeIncludeHandler, IntPtr.Size, GCHandle.ToIntPtr(includeContext));
+
+                using var sourceHandle = source.Pin();
+                var sourceBuffer = new DxcBuffer();
+
+                unsafe
+                {
+                    sourceBuffer.Pointer = (IntPtr)sourceHandle.Pointer;
+                }
+
+                sourceBuffer.Size = (UIntPtr)source.Length;
+                sourceBuffer.Encoding = Utf8CodePage;
+
+                var interfaceId = operationResultInterfaceId;
+                ThrowIfFailed(GetMethod<CompileDelegate>(compiler, CompileSlot)(compiler, ref sourceBuffer, nativeArguments, (uint)nativeArguments.Length, nativeIncludeHandler, ref interfaceId, out result));
+                ThrowIfFailed(GetMethod<GetStatusDelegate>(result, GetStatusSlot)(result, out var status));
+
+                var messages = ReadBlob(result, GetErrorBufferSlot);
+                var data = (status >= 0) ? ReadBlob(result, GetResultSlot) : null;
+
+                return new DxcCompileResult(data, (messages != null && messages.Length > 0) ? Encoding.UTF8.GetString(messages).TrimEnd('\0', '\n') : null);
+            }
+
+            finally
+            {
+                Release(result);
+
+                foreach (var nativeArgument in nativeArguments)
+                {
+                    Marshal.FreeHGlobal(nativeArgument);
+                }
+
+                Marshal.FreeHGlobal(nativeIncludeHandler);
+
+                if (includeContext.IsAllocated)
+                {
+                    includeContext.Free();
+                }
+
+                Release(utils);
+                Release(compiler);
+            }
+        }
+
+        private static DxcCreateInstanceDelegate? LoadLibrary()
+        {
+            var libraryName = isWindows ? "dxcompiler.dll" : RuntimeInformation.IsOSPlatform(OSPlatform.OSX) ? "libdxcompiler.dylib" : "libdxcompiler.so";
+            var dxilLibraryName = isWindows ? "dxil.dll" : RuntimeInformation.IsOSPlatform(OSPlatform.OSX) ? "libdxil.dylib" : "libdxil.so";
+            var toolsDirectory = Path.GetDirectoryName(Assembly.GetExecutingAssembly().Location)!;
+            var candidatePaths = new List<string>();
+
+            // COREENGINE_DXC_PATH can point to the library or to its directory
+            var environmentPath = Environment.GetEnvironmentVariable("COREENGINE_DXC_PATH");
+
+            if (!string.IsNullOrEmpty(environmentPath))
+            {
+                candidatePaths.Add(Directory.Exists(environmentPath) ? Path.Combine(environmentPath, libraryName) : environmentPath);
+            }
+
+            candidatePaths.Add(Path.Combine(toolsDirectory, "dxc", libraryName));
+            candidatePaths.Add(Path.Combine(toolsDirectory, "Tools", "ShaderConductor", libraryName));
+            candidatePaths.Add(libraryName);
+
+            foreach (var candidatePath in candidatePaths)
+            {
+                // dxcompiler loads dxil by name to sign the shaders, a copy next to it is not in the search paths
+                var dxilPath = Path.Combine(Path.GetDirectoryName(candidatePath)!, dxilLibraryName);
+
+                if (File.Exists(candidatePath) && File.Exists(dxilPath))
+                {
+                    NativeLibrary.TryLoad(dxilPath, out _);
+                }
+
+                if (NativeLibrary.TryLoad(candidatePath, out var library))
+                {
+                    if (NativeLibrary.TryGetExport(library, "DxcCreateInstance", out var export))
+                    {
+                        libraryIdentifier = File.Exists(candidatePath) ? $"{libraryName}:{XxHash64.HashFile(candidatePath):x16}" : libraryName;
+
+                        return Marshal.GetDelegateForFunctionPointer<DxcCreateInstanceDelegate>(export);
+                    }
+
+                    NativeLibrary.Free(library);
+                }
+            }
+
+            return null;
+        }
+
+        private static IntPtr CreateInstance(Guid classId, Guid interfaceId)
+        {
+            var createInstanceMethod = createInstance.Value;
+
+            if (createInstanceMethod == null)
+            {
+                throw new InvalidOperationException("The DXC library (dxcompiler) was not found.");
+            }
+
+            ThrowIfFailed(createInstanceMethod(ref classId, ref interfaceId, out var result));
+            return result;
+        }
+
+        private static T GetMethod<T>(IntPtr instance, int slot) where T : Delegate
+        {
+            var vtable = Marshal.ReadIntPtr(instance);
+            return Marshal.GetDelegateForFunctionPointer<T>(Marshal.ReadIntPtr(vtable, slot * IntPtr.Size));
+        }
+
+        private static void Release(IntPtr instance)
+        {
+            if (instance != IntPtr.Zero)
+            {
+                GetMethod<ReferenceCountDelegate>(instance, ReleaseSlot)(instance);
+            }
+        }
+
+        private static void ThrowIfFailed(int result)
+        {
+            if (result < 0)
+            {
+                throw new InvalidOperationException($"DXC call failed with HRESULT 0x{result:X8}.");
+            }
+        }
+
+        private static byte[]? ReadBlob(IntPtr result, int slot)
+        {
+            if (GetMethod<GetBlobDelegate>(result, slot)(result, out var blob) < 0 || blob == IntPtr.Zero)
+            {
+                return null;
+            }
+
+            try
+            {
+                var pointer = GetMethod<GetBufferPointerDelegate>(blob, GetBufferPointerSlot)(blob);
+                var size = (int)GetMethod<GetBufferSizeDelegate>(blob, GetBufferSizeSlot)(blob);
+                var data = new byte[size];
+
+                if (size > 0)
+                {
+                    Marshal.Copy(pointer, data, 0, size);
+                }
+
+                return data;
+            }
+
+            finally
+            {
+                Release(blob);
+            }
+        }
+
+        // wchar_t is 16 bits on Windows and 32 bits on Linux and macOS
+        private static IntPtr AllocateWideString(string value)
+        {
+            var characterSize = isWindows ? 2 : 4;
+            var bytes = isWindows ? Encoding.Unicode.GetBytes(value) : Encoding.UTF32.GetBytes(value);
+            var result = Marshal.AllocHGlobal(bytes.Length + characterSize);
+
+            Marshal.Copy(bytes, 0, result, bytes.Length);
+
+            for (var i = 0; i < characterSize; i++)
+            {
+                Marshal.WriteByte(result, bytes.Length + i, 0);
+            }
+
+            return result;
+        }
+
+        private static string ReadWideString(IntPtr value)
+        {
+            if (isWindows)
+            {
+                return Marshal.PtrToStringUni(value)!;
+            }
+
+            var length = 0;
+
+            while (Marshal.ReadInt32(value, length * 4) != 0)
+            {
+                length++;
+            }
+
+            var bytes = new byte[length * 4];
+            Marshal.Copy(value, bytes, 0, bytes.Length);
+
+            return Encoding.UTF32.GetString(bytes);
+        }
+
+        private static IntPtr CreateIncludeHandlerVtable()
+        {
+            var result = Marshal.AllocHGlobal(IntPtr.Size * 4);
+
+            Marshal.WriteIntPtr(result, 0, Marshal.GetFunctionPointerForDelegate(includeHandlerQueryInterface));
+            Marshal.WriteIntPtr(result, IntPtr.Size, Marshal.GetFunctionPointerForDelegate(includeHandlerReferenceCount));
+            Marshal.WriteIntPtr(result, IntPtr.Size * 2, Marshal.GetFunctionPointerForDelegate(includeHandlerReferenceCount));
+            Marshal.WriteIntPtr(result, IntPtr.Size * 3, Marshal.GetFunctionPointerForDelegate(includeHandlerLoadSource));
+
+            return result;
+        }
+
+        private static int IncludeHandlerQueryInterface(IntPtr instance, ref Guid interfaceId, out IntPtr result)
+        {
+            if (interfaceId == unknownInterfaceId || interfaceId == includeHandlerInterfaceId)
+            {
+                result = instance;
+                return 0;
+            }
+
+            result = IntPtr.Zero;
+            return NoInterfaceError;
+        }
+
+        // The native include handler is owned by Compile so reference counting is not needed
+        private static uint IncludeHandlerReferenceCount(IntPtr instance)
+        {
+            return 1;
+        }
+
+        // Exceptions must not cross the native boundary, DXC tries the next include directory on failure
+        private static unsafe int IncludeHandlerLoadSource(IntPtr instance, IntPtr filename, out IntPtr includeSource)
+        {
+            includeSource = IntPtr.Zero;
+
+            try
+            {
+                var context = (IncludeContext)GCHandle.FromIntPtr(Marshal.ReadIntPtr(instance, IntPtr.Size)).Target!;
+                var data = context.Handler.LoadSource(ReadWideString(filename));
+
+                if (data == null)
+                {
+                    return FileNotFoundError;
+                }
+
+                fixed (byte* dataPointer = data)
+                {
+                    return GetMethod<CreateBlobDelegate>(context.Utils, CreateBlobSlot)(context.Utils, (IntPtr)dataPointer, (uint)data.Length, Utf8CodePage, out includeSource);
+                }
+            }
+
+            catch (Exception)
+            {
+                return FailError;
+            }
+        }
+    }
+}
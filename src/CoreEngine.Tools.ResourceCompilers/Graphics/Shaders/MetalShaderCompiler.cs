@@ -1,7 +1,6 @@
 using System;
 using System.Diagnostics;
 using System.IO;
-using System.Reflection;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
 
@@ -9,7 +8,43 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
 {
     public static class MetalShaderCompiler
     {
-        public static async Task<ReadOnlyMemory<byte>?> CompileMetalShaderAsync(ReadOnlyMemory<byte> data, bool transpileShader, string includeDirectory)
+        public static async Task<ReadOnlyMemory<byte>?> CompileMetalShaderAsync(ReadOnlyMemory<byte> data, bool transpileShader, string sourcePath, string includeDirectory, ShaderBytecodeCache bytecodeCache, CompileCache? cache)
+        {
+            if (sourcePath == null)
+            {
+                throw new ArgumentNullException(nameof(sourcePath));
+            }
+
+            if (includeDirectory == null)
+            {
+                throw new ArgumentNullException(nameof(includeDirectory));
+            }
+
+            if (bytecodeCache == null)
+            {
+                throw new ArgumentNullException(nameof(bytecodeCache));
+            }
+
+            string preprocessedSource;
+
+            using (BuildTracer.BeginSpan("PreprocessShader", "Shader"))
+            {
+                preprocessedSource = ShaderPreprocessor.Preprocess(data.Span, sourcePath, new string[] { includeDirectory, Path.Combine(includeDirectory, "Lib") }, new ShaderIncludeHandler());
+            }
+
+            // The metallib contains all the entry points so the shader is a single variant
+            var key = ShaderBytecodeCache.ComputeKey(preprocessedSource, "Metal", transpileShader ? "HLSL" : "MSL");
+            var result = await bytecodeCache.GetOrCompileAsync(Path.GetFileName(sourcePath), key, cache, () => CompileMetalVariantAsync(data, transpileShader, includeDirectory));
+
+            if (result == null)
+            {
+                return null;
+            }
+
+            return result;
+        }
+
+        private static async Task<byte[]?> CompileMetalVariantAsync(ReadOnlyMemory<byte> data, bool transpileShader, string includeDirectory)
         {
             if (transpileShader)
             {
@@ -32,96 +67,98 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
         private static async Task<ReadOnlyMemory<byte>?> TranspileShaderToMetalAsync(ReadOnlyMemory<byte> data)
         {
             // TODO: Add parameters for vertex and pixel main
-            // TODO: Use shader conductor lib instead of command line tool
+            // TODO: Use shader conductor lib instead of command line tool, the library only exposes a C++ API
 
-            var tempFolder = Path.Combine(Path.GetDirectoryName(Assembly.GetEntryAssembly()!.Location), "temp")!;
+            var tempFolder = CreateTempFolder();
 
-            if (!Directory.Exists(tempFolder))
+            try
             {
-                Directory.CreateDirectory(tempFolder);
-            }
+                var inputShaderFile = Path.Combine(tempFolder, "tempShader_transpile.hlsl");
+                var vsOutputShaderFile = Path.Combine(tempFolder, "vs_tempShader_transpile.metal");
+                var psOutputShaderFile = Path.Combine(tempFolder, "ps_tempShader_transpile.metal");
 
-            var inputShaderFile = Path.Combine(tempFolder, "tempShader_transpile.hlsl");
-            var vsOutputShaderFile = Path.Combine(tempFolder, "vs_tempShader_transpile.metal");
-            var psOutputShaderFile = Path.Combine(tempFolder, "ps_tempShader_transpile.metal");
+                await File.WriteAllBytesAsync(inputShaderFile, data.ToArray());
 
-            await File.WriteAllBytesAsync(inputShaderFile, data.ToArray());
+                // Both stages are transpiled concurrently
+                var vertexShaderTask = RunProcessAsync("ShaderConductorCmd", $"-I {inputShaderFile} -O {vsOutputShaderFile} -S vs -T msl_macos -V 20200 -E VertexMain");
+                var pixelShaderTask = RunProcessAsync("ShaderConductorCmd", $"-I {inputShaderFile} -O {psOutputShaderFile} -S ps -T msl_macos -V 20200 -E PixelMain");
 
-            using var buildProcess = new Process();
-            buildProcess.StartInfo.FileName = "ShaderConductorCmd";
-            buildProcess.StartInfo.Arguments = $"-I {inputShaderFile} -O {vsOutputShaderFile} -S vs -T msl_macos -V 20200 -E VertexMain";
-
-            buildProcess.Start();
-            buildProcess.WaitForExit();
-
-            if (buildProcess.ExitCode != 0)
-            {
-                return null;
-            }
+                if (!await vertexShaderTask || !await pixelShaderTask)
+                {
+                    return null;
+                }
 
-            var vertexShaderData = await File.ReadAllBytesAsync(vsOutputShaderFile);
+                var vertexShaderData = await File.ReadAllBytesAsync(vsOutputShaderFile);
+                var pixelShaderData = await File.ReadAllBytesAsync(psOutputShaderFile);
 
-            buildProcess.StartInfo.Arguments = $"-I {inputShaderFile} -O {psOutputShaderFile} -S ps -T msl_macos -V 20200 -E PixelMain";
+                var outputArray = new byte[vertexShaderData.Length + pixelShaderData.Length];
+                Array.Copy(vertexShaderData, outputArray, vertexShaderData.Length);
+                Array.Copy(pixelShaderData, 0, outputArray, vertexShaderData.Length, pixelShaderData.Length);
 
-            buildProcess.Start();
-            buildProcess.WaitForExit();
+                return outputArray;
+            }
 
-            if (buildProcess.ExitCode != 0)
+            finally
             {
-                return null;
+                Directory.Delete(tempFolder, true);
             }
-
-            var pixelShaderData = await File.ReadAllBytesAsync(psOutputShaderFile);
-
-            var outputArray = new byte[vertexShaderData.Length + pixelShaderData.Length];
-            Array.Copy(vertexShaderData, outputArray, vertexShaderData.Length);
-            Array.Copy(pixelShaderData, 0, outputArray, vertexShaderData.Length, pixelShaderData.Length);
-
-            return outputArray;
         }
 
-        private static async Task<ReadOnlyMemory<byte>?> CompileMetalShaderSourceAsync(ReadOnlyMemory<byte> data, string includeDirectory)
+        private static async Task<byte[]?> CompileMetalShaderSourceAsync(ReadOnlyMemory<byte> data, string includeDirectory)
         {
             // TODO: Find a way to invoke compilation in-memory
-            // TODO: Put intermediate files into temp directory
-            // TODO: Remove intermediate files
 
-            var tempFolder = Path.Combine(Path.GetDirectoryName(Assembly.GetEntryAssembly()!.Location), "temp")!;
-            
-            if (!Directory.Exists(tempFolder))
+            var tempFolder = CreateTempFolder();
+
+            try
             {
-                Directory.CreateDirectory(tempFolder);
-            }
+                var inputShaderFile = Path.Combine(tempFolder, "tempShader.metal");
+                var outputAirFile = Path.Combine(tempFolder, "tempShader.air");
+                var outputMetalLibFile = Path.Combine(tempFolder, "tempShader.metallib");
 
-            var inputShaderFile = Path.Combine(tempFolder, "tempShader.metal");
-            var outputAirFile = Path.Combine(tempFolder, "tempShader.air");
-            var outputMetalLibFile = Path.Combine(tempFolder, "tempShader.metallib");
+                await File.WriteAllBytesAsync(inputShaderFile, data.ToArray());
 
-            await File.WriteAllBytesAsync(inputShaderFile, data.ToArray());
+                if (!await RunProcessAsync("xcrun", $"-sdk macosx metal -gline-tables-only -MO -I {includeDirectory} -c {inputShaderFile} -o {outputAirFile}"))
+                {
+                    return null;
+                }
 
-            using var buildProcess = new Process();
-            buildProcess.StartInfo.FileName = "xcrun";
-            buildProcess.StartInfo.Arguments = $"-sdk macosx metal -gline-tables-only -MO -I {includeDirectory} -c {inputShaderFile} -o {outputAirFile}";
+                if (!await RunProcessAsync("xcrun", $"-sdk macosx metallib {outputAirFile} -o {outputMetalLibFile}"))
+                {
+                    return null;
+                }
 
-            buildProcess.Start();
-            buildProcess.WaitForExit();
+                return await File.ReadAllBytesAsync(outputMetalLibFile);
+            }
 
-            if (buildProcess.ExitCode != 0)
+            finally
             {
-                return null;
-            }            
+                Directory.Delete(tempFolder, true);
+            }
+        }
 
-            buildProcess.StartInfo.Arguments = $"-sdk macosx metallib {outputAirFile} -o {outputMetalLibFile}";
+        // Each compilation uses its own intermediate files so that shaders can be compiled concurrently
+        private static string CreateTempFolder()
+        {
+            var result = Path.Combine(Path.GetTempPath(), "CoreEngineCompiler", Guid.NewGuid().ToString("N"));
+            Directory.CreateDirectory(result);
 
-            buildProcess.Start();
-            buildProcess.WaitForExit();
+            return result;
+        }
 
-            if (buildProcess.ExitCode != 0)
+        private static Task<bool> RunProcessAsync(string fileName, string arguments)
+        {
+            return Task.Run(() =>
             {
-                return null;
-            } 
+                using var buildProcess = new Process();
+                buildProcess.StartInfo.FileName = fileName;
+                buildProcess.StartInfo.Arguments = arguments;
+
+                buildProcess.Start();
+                buildProcess.WaitForExit();
 
-            return await File.ReadAllBytesAsync(outputMetalLibFile);
+                return buildProcess.ExitCode == 0;
+            });
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+using System;
+using System.Collections.Concurrent;
+using System.Text;
+using System.Threading.Tasks;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
+{
+    // Compiled shader variants keyed by the preprocessed source and the compiler parameters, an edit that doesn't change
+    // the preprocessed source (a comment in a header for example) compiles nothing. Identical variants requested at the
+    // same time are compiled once and identical bytecode is stored once in the compile cache.
+    public class ShaderBytecodeCache
+    {
+        // The variants of the current build are kept in memory, the compile cache keeps them between builds
+        private const int MaxVariantCount = 4096;
+
+        private readonly ConcurrentDictionary<string, Lazy<Task<byte[]?>>> variants = new ConcurrentDictionary<string, Lazy<Task<byte[]?>>>(StringComparer.Ordinal);
+
+        public static string ComputeKey(string preprocessedSource, params string[] parameters)
+        {
+            if (preprocessedSource == null)
+            {
+                throw new ArgumentNullException(nameof(preprocessedSource));
+            }
+
+            if (parameters == null)
+            {
+                throw new ArgumentNullException(nameof(parameters));
+            }
+
+            var keyBuilder = new CacheKeyBuilder();
+            keyBuilder.AppendString(ResourceCompiler.CompilerAssemblyHash);
+
+            foreach (var parameter in parameters)
+            {
+                keyBuilder.AppendString(parameter);
+            }
+
+            keyBuilder.AppendData(Encoding.UTF8.GetBytes(preprocessedSource));
+            return keyBuilder.GetKey();
+        }
+
+        public async Task<byte[]?> GetOrCompileAsync(string name, string key, CompileCache? cache, Func<Task<byte[]?>> compile)
+        {
+            if (this.variants.Count > MaxVariantCount)
+            {
+                this.variants.Clear();
+            }
+
+            var variant = this.variants.GetOrAdd(key, variantKey => new Lazy<Task<byte[]?>>(() => LoadOrCompileAsync(name, variantKey, cache, compile)));
+            byte[]? result;
+
+            try
+            {
+                result = await variant.Value;
+            }
+
+            catch
+            {
+                this.variants.TryRemove(key, out _);
+                throw;
+            }
+
+            // Failed variants are compiled again so that their messages are written for each shader
+            if (result == null)
+            {
+                this.variants.TryRemove(key, out _);
+            }
+
+            return result;
+        }
+
+        private static async Task<byte[]?> LoadOrCompileAsync(string name, string key, CompileCache? cache, Func<Task<byte[]?>> compile)
+        {
+            // The variant entry references the bytecode entry by its content hash so that identical bytecode of
+            // different variants is only stored once
+            if (cache != null)
+            {
+                using var cacheSpan = BuildTracer.BeginSpan("ShaderCacheLookup", "Cache");
+                var bytecodeKey = cache.TryReadData(key);
+
+                if (bytecodeKey != null)
+                {
+                    var bytecode = cache.TryReadData(Encoding.ASCII.GetString(bytecodeKey));
+
+                    if (bytecode != null)
+                    {
+                        Logger.WriteMessage(LogMessageTypes.Debug, "Shader variant {0} restored from compile cache", name);
+                        return bytecode;
+                    }
+                }
+            }
+
+            var result = await compile();
+
+            if (result != null && cache != null)
+            {
+                using var cacheSpan = BuildTracer.BeginSpan("ShaderCacheStore", "Cache");
+
+                var keyBuilder = new CacheKeyBuilder();
+                keyBuilder.AppendData(result);
+                var bytecodeKey = keyBuilder.GetKey();
+
+                cache.StoreData(bytecodeKey, result);
+                cache.StoreData(key, Encoding.ASCII.GetBytes(bytecodeKey));
+            }
+
+            return result;
+        }
+    }
+}
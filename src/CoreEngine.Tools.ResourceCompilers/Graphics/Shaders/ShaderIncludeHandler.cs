@@ -0,0 +1,25 @@
+using System;
+using System.Collections.Concurrent;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
+{
+    // Serves the includes of a shader to the preprocessor and to the DXC library, each file is read once and shared
+    // by the concurrent compilations of the shader entry points
+    public sealed class ShaderIncludeHandler
+    {
+        private readonly ConcurrentDictionary<string, byte[]?> sources = new ConcurrentDictionary<string, byte[]?>(StringComparer.Ordinal);
+
+        public byte[]? LoadSource(string path)
+        {
+            if (path == null)
+            {
+                throw new ArgumentNullException(nameof(path));
+            }
+
+            // DXC builds the candidate paths with Windows separators
+            var fullPath = Path.GetFullPath(path.Replace('\\', Path.DirectorySeparatorChar));
+            return this.sources.GetOrAdd(fullPath, key => File.Exists(key) ? File.ReadAllBytes(key) : null);
+        }
+    }
+}
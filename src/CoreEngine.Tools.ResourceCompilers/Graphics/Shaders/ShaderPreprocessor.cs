@@ -0,0 +1,174 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using System.Text.RegularExpressions;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
+{
+    // Expands the quoted includes of a shader and removes its comments and blank space. The result identifies the
+    // compiled shader variants: the compilers still get the original source so that their messages keep the line numbers.
+    public static class ShaderPreprocessor
+    {
+        private static readonly Regex includeRegex = new Regex(@"^#\s*include\s*""([^""]+)""", RegexOptions.Compiled);
+
+        public static string Preprocess(ReadOnlySpan<byte> source, string sourcePath, IList<string> includeDirectories, ShaderIncludeHandler includeHandler)
+        {
+            if (sourcePath == null)
+            {
+                throw new ArgumentNullException(nameof(sourcePath));
+            }
+
+            if (includeDirectories == null)
+            {
+                throw new ArgumentNullException(nameof(includeDirectories));
+            }
+
+            if (includeHandler == null)
+            {
+                throw new ArgumentNullException(nameof(includeHandler));
+            }
+
+            var fullSourcePath = Path.GetFullPath(sourcePath);
+            var result = new StringBuilder(source.Length);
+            var includedFiles = new HashSet<string>(StringComparer.Ordinal) { fullSourcePath };
+
+            AppendSource(result, Encoding.UTF8.GetString(source), Path.GetDirectoryName(fullSourcePath)!, includeDirectories, includeHandler, includedFiles);
+            return result.ToString();
+        }
+
+        // Each file is expanded once, its content is already part of the result for the next includes
+        private static void AppendSource(StringBuilder result, string source, string sourceDirectory, IList<string> includeDirectories, ShaderIncludeHandler includeHandler, HashSet<string> includedFiles)
+        {
+            foreach (var line in RemoveComments(source).Split('\n'))
+            {
+                if (line.Length == 0)
+                {
+                    continue;
+                }
+
+                var match = includeRegex.Match(line);
+
+                if (match.Success)
+                {
+                    var includePath = ResolveInclude(match.Groups[1].Value, sourceDirectory, includeDirectories, includeHandler, out var includeData);
+
+                    if (includePath != null && includeData != null)
+                    {
+                        if (includedFiles.Add(includePath))
+                        {
+                            AppendSource(result, Encoding.UTF8.GetString(includeData), Path.GetDirectoryName(includePath)!, includeDirectories, includeHandler, includedFiles);
+                        }
+
+                        continue;
+                    }
+                }
+
+                // Unresolved includes (system headers for example) are kept as they are
+                result.Append(line);
+                result.Append('\n');
+            }
+        }
+
+        private static string? ResolveInclude(string include, string sourceDirectory, IList<string> includeDirectories, ShaderIncludeHandler includeHandler, out byte[]? includeData)
+        {
+            var candidatePath = Path.GetFullPath(Path.Combine(sourceDirectory, include));
+            includeData = includeHandler.LoadSource(candidatePath);
+
+            if (includeData != null)
+            {
+                return candidatePath;
+            }
+
+            foreach (var includeDirectory in includeDirectories)
+            {
+                candidatePath = Path.GetFullPath(Path.Combine(includeDirectory, include));
+                includeData = includeHandler.LoadSource(candidatePath);
+
+                if (includeData != null)
+                {
+                    return candidatePath;
+                }
+            }
+
+            return null;
+        }
+
+        // Comments become a single space, runs of blank characters are collapsed, lines are trimmed and empty lines
+        // are removed. String and character literals are copied as they are.
+        private static string RemoveComments(string source)
+        {
+            var result = new StringBuilder(source.Length);
+            var hasPendingSpace = false;
+            var i = 0;
+
+            while (i < source.Length)
+            {
+                var character = source[i];
+
+                if (character == '/' && i + 1 < source.Length && source[i + 1] == '/')
+                {
+                    while (i < source.Length && source[i] != '\n')
+                    {
+                        i++;
+                    }
+                }
+
+                else if (character == '/' && i + 1 < source.Length && source[i + 1] == '*')
+                {
+                    var commentEnd = source.IndexOf("*/", i + 2, StringComparison.Ordinal);
+                    i = (commentEnd >= 0) ? commentEnd + 2 : source.Length;
+                    hasPendingSpace = true;
+                }
+
+                else if (character == '\n')
+                {
+                    if (result.Length > 0 && result[result.Length - 1] != '\n')
+                    {
+                        result.Append('\n');
+                    }
+
+                    hasPendingSpace = false;
+                    i++;
+                }
+
+                else if (char.IsWhiteSpace(character))
+                {
+                    hasPendingSpace = true;
+                    i++;
+                }
+
+                else
+                {
+                    if (hasPendingSpace && result.Length > 0 && result[result.Length - 1] != '\n')
+                    {
+                        result.Append(' ');
+                    }
+
+                    hasPendingSpace = false;
+
+                    if (character == '"' || character == '\'')
+                    {
+                        var literalStart = i++;
+
+                        while (i < source.Length && source[i] != character && source[i] != '\n')
+                        {
+                            i += (source[i] == '\\') ? 2 : 1;
+                        }
+
+                        i = Math.Min(i + 1, source.Length);
+                        result.Append(source, literalStart, i - literalStart);
+                    }
+
+                    else
+                    {
+                        result.Append(character);
+                        i++;
+                    }
+                }
+            }
+
+            return result.ToString();
+        }
+    }
+}
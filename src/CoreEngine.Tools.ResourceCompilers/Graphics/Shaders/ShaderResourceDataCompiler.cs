@@ -1,6 +1,8 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Text;
+using System.Text.RegularExpressions;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
 
@@ -8,6 +10,10 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
 {
     public class ShaderResourceDataCompiler : ResourceDataCompiler
     {
+        private static readonly Regex includeRegex = new Regex(@"^\s*#\s*include\s*""([^""]+)""", RegexOptions.Multiline | RegexOptions.Compiled);
+
+        private readonly ShaderBytecodeCache bytecodeCache = new ShaderBytecodeCache();
+
         public override string Name
         {
             get
@@ -32,6 +38,25 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
             }
         }
 
+        public override IList<string> ReadDependencies(ReadOnlyMemory<byte> sourceData)
+        {
+            var result = new List<string>();
+            var shaderContent = Encoding.UTF8.GetString(sourceData.Span);
+
+            // Only quoted includes are tracked, system includes like <metal_stdlib> are not part of the project
+            foreach (Match match in includeRegex.Matches(shaderContent))
+            {
+                var includePath = match.Groups[1].Value;
+
+                if (!result.Contains(includePath))
+                {
+                    result.Add(includePath);
+                }
+            }
+
+            return result;
+        }
+
         public override async Task<ReadOnlyMemory<ResourceEntry>> CompileAsync(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             if (context == null)
@@ -39,7 +64,8 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
                 throw new ArgumentNullException(nameof(context));
             }
 
-            if (Path.GetExtension(context.SourceFilename) == ".h")
+            // Metal sources are only compiled for the osx target
+            if (Path.GetExtension(context.SourceFilename) == ".h" || (Path.GetExtension(context.SourceFilename) == ".metal" && context.TargetPlatform != "osx"))
             {
                 return new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[0]);
             }
@@ -50,28 +76,27 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Shaders
 
             if (context.TargetPlatform == "osx")
             {
-                shaderCompiledData = await MetalShaderCompiler.CompileMetalShaderAsync(sourceData, Path.GetExtension(context.SourceFilename) != ".metal", context.InputDirectory);
+                shaderCompiledData = await MetalShaderCompiler.CompileMetalShaderAsync(sourceData, Path.GetExtension(context.SourceFilename) != ".metal", Path.Combine(context.InputDirectory, context.SourceFilename), context.InputDirectory, this.bytecodeCache, context.Cache);
             }
 
-            else if (context.TargetPlatform == "windows")
+            // The DXIL and SPIR-V shaders are compiled with DXC which also runs on Linux
+            else if (context.TargetPlatform == "windows" || context.TargetPlatform == "linux")
             {
-                shaderCompiledData = await DirectXShaderCompiler.CompileDirectXShaderAsync(sourceData);
+                shaderCompiledData = await DirectXShaderCompiler.CompileDirectXShaderAsync(sourceData, Path.Combine(context.InputDirectory, context.SourceFilename), Path.Combine(context.InputDirectory, "Lib"), this.bytecodeCache, context.Cache);
             }
             
             if (shaderCompiledData != null)
             {
-                var destinationMemoryStream = new MemoryStream();
+                var destinationBuffer = new PooledBufferWriter(shaderCompiledData.Value.Length + 64);
 
-                using var streamWriter = new BinaryWriter(destinationMemoryStream);
+                using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
                 streamWriter.Write(new char[] { 'S', 'H', 'A', 'D', 'E', 'R'});
                 streamWriter.Write(version);
-                streamWriter.Write(shaderCompiledData.Value.Length); // TODO: Use span overload?
-                streamWriter.Write(shaderCompiledData.Value.ToArray());
+                streamWriter.Write(shaderCompiledData.Value.Length);
+                streamWriter.Write(shaderCompiledData.Value.Span);
                 streamWriter.Flush();
 
-                destinationMemoryStream.Flush();
-                var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-                var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", resourceData);
+                var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", destinationBuffer);
 
                 return new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry });
             }
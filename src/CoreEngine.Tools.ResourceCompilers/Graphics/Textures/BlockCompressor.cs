@@ -0,0 +1,763 @@
+using System;
+using System.Runtime.Intrinsics;
+using System.Runtime.Intrinsics.X86;
+using System.Threading.Tasks;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
+{
+    public enum BlockCompressionFormat
+    {
+        BC1,
+        BC3,
+        BC4,
+        BC5
+    }
+
+    public enum BlockCompressionQuality
+    {
+        // Bounding box endpoints
+        Fast,
+
+        // Principal axis endpoints
+        Normal,
+
+        // Principal axis endpoints refined by least squares and endpoint search
+        High
+    }
+
+    // Encodes RGBA8 images in the BC formats, each row of 4x4 blocks is compressed on its own task
+    public static class BlockCompressor
+    {
+        public const int BlockDimension = 4;
+
+        private const int BlockPixelCount = BlockDimension * BlockDimension;
+        private const int LeastSquaresIterationCount = 2;
+        private const int AlphaEndpointSearchRange = 3;
+
+        public static int GetBlockSizeInBytes(BlockCompressionFormat format)
+        {
+            return (format == BlockCompressionFormat.BC1 || format == BlockCompressionFormat.BC4) ? 8 : 16;
+        }
+
+        public static int GetCompressedSizeInBytes(int width, int height, BlockCompressionFormat format)
+        {
+            return ((width + BlockDimension - 1) / BlockDimension) * ((height + BlockDimension - 1) / BlockDimension) * GetBlockSizeInBytes(format);
+        }
+
+        public static unsafe byte[] Compress(byte[] rgbaData, int width, int height, BlockCompressionFormat format, BlockCompressionQuality quality)
+        {
+            if (rgbaData == null)
+            {
+                throw new ArgumentNullException(nameof(rgbaData));
+            }
+
+            if (width < 1 || height < 1 || rgbaData.Length < width * height * 4)
+            {
+                throw new ArgumentException("The image data is smaller than the image dimensions.", nameof(rgbaData));
+            }
+
+            var blockCountX = (width + BlockDimension - 1) / BlockDimension;
+            var blockCountY = (height + BlockDimension - 1) / BlockDimension;
+            var blockSize = GetBlockSizeInBytes(format);
+            var result = new byte[blockCountX * blockCountY * blockSize];
+
+            Parallel.For(0, blockCountY, blockY =>
+            {
+                // Channel major pixels: 16 red values, then 16 green, 16 blue and 16 alpha
+                var pixels = stackalloc float[BlockPixelCount * 4];
+
+                fixed (byte* source = rgbaData)
+                fixed (byte* destination = result)
+                {
+                    for (var blockX = 0; blockX < blockCountX; blockX++)
+                    {
+                        LoadBlock(source, width, height, blockX, blockY, pixels);
+
+                        var block = destination + (blockY * blockCountX + blockX) * blockSize;
+
+                        switch (format)
+                        {
+                            case BlockCompressionFormat.BC1:
+                                CompressColorBlock(pixels, quality, block);
+                                break;
+
+                            case BlockCompressionFormat.BC3:
+                                CompressAlphaBlock(pixels + BlockPixelCount * 3, quality, block);
+                                CompressColorBlock(pixels, quality, block + 8);
+                                break;
+
+                            case BlockCompressionFormat.BC4:
+                                CompressAlphaBlock(pixels, quality, block);
+                                break;
+
+                            case BlockCompressionFormat.BC5:
+                                CompressAlphaBlock(pixels, quality, block);
+                                CompressAlphaBlock(pixels + BlockPixelCount, quality, block + 8);
+                                break;
+                        }
+                    }
+                }
+            });
+
+            return result;
+        }
+
+        // Decodes to RGBA8, single channel formats decode to red and two channel formats to red and green
+        public static unsafe byte[] Decompress(byte[] compressedData, int width, int height, BlockCompressionFormat format)
+        {
+            if (compressedData == null)
+            {
+                throw new ArgumentNullException(nameof(compressedData));
+            }
+
+            if (compressedData.Length < GetCompressedSizeInBytes(width, height, format))
+            {
+                throw new ArgumentException("The compressed data is smaller than the image dimensions.", nameof(compressedData));
+            }
+
+            var blockCountX = (width + BlockDimension - 1) / BlockDimension;
+            var blockCountY = (height + BlockDimension - 1) / BlockDimension;
+            var blockSize = GetBlockSizeInBytes(format);
+            var result = new byte[width * height * 4];
+
+            var colors = stackalloc byte[BlockPixelCount * 4];
+            var values = stackalloc byte[BlockPixelCount];
+
+            fixed (byte* source = compressedData)
+            {
+                for (var blockY = 0; blockY < blockCountY; blockY++)
+                {
+                    for (var blockX = 0; blockX < blockCountX; blockX++)
+                    {
+                        var block = source + (blockY * blockCountX + blockX) * blockSize;
+
+                        for (var i = 0; i < BlockPixelCount; i++)
+                        {
+                            colors[i * 4] = 0;
+                            colors[i * 4 + 1] = 0;
+                            colors[i * 4 + 2] = 0;
+                            colors[i * 4 + 3] = 255;
+                        }
+
+                        switch (format)
+                        {
+                            case BlockCompressionFormat.BC1:
+                                DecompressColorBlock(block, colors, isOpaque: false);
+                                break;
+
+                            case BlockCompressionFormat.BC3:
+                                DecompressColorBlock(block + 8, colors, isOpaque: true);
+                                DecompressAlphaBlock(block, values);
+                                CopyChannel(values, colors, 3);
+                                break;
+
+                            case BlockCompressionFormat.BC4:
+                                DecompressAlphaBlock(block, values);
+                                CopyChannel(values, colors, 0);
+                                break;
+
+                            case BlockCompressionFormat.BC5:
+                                DecompressAlphaBlock(block, values);
+                                CopyChannel(values, colors, 0);
+                                DecompressAlphaBlock(block + 8, values);
+                                CopyChannel(values, colors, 1);
+                                break;
+                        }
+
+                        for (var y = 0; y < BlockDimension && blockY * BlockDimension + y < height; y++)
+                        {
+                            for (var x = 0; x < BlockDimension && blockX * BlockDimension + x < width; x++)
+                            {
+                                var offset = ((blockY * BlockDimension + y) * width + blockX * BlockDimension + x) * 4;
+                                var pixel = (y * BlockDimension + x) * 4;
+
+                                result[offset] = colors[pixel];
+                                result[offset + 1] = colors[pixel + 1];
+                                result[offset + 2] = colors[pixel + 2];
+                                result[offset + 3] = colors[pixel + 3];
+                            }
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        // Pixels outside of the image repeat the last row and column so they do not pull the endpoints
+        private static unsafe void LoadBlock(byte* source, int width, int height, int blockX, int blockY, float* pixels)
+        {
+            for (var y = 0; y < BlockDimension; y++)
+            {
+                var sourceY = Math.Min(blockY * BlockDimension + y, height - 1);
+
+                for (var x = 0; x < BlockDimension; x++)
+                {
+                    var sourceX = Math.Min(blockX * BlockDimension + x, width - 1);
+                    var pixel = source + (sourceY * width + sourceX) * 4;
+                    var i = y * BlockDimension + x;
+
+                    pixels[i] = pixel[0];
+                    pixels[BlockPixelCount + i] = pixel[1];
+                    pixels[BlockPixelCount * 2 + i] = pixel[2];
+                    pixels[BlockPixelCount * 3 + i] = pixel[3];
+                }
+            }
+        }
+
+        private static unsafe void CompressColorBlock(float* pixels, BlockCompressionQuality quality, byte* destination)
+        {
+            var endpoints = stackalloc float[6];
+            var palette = stackalloc float[12];
+            var indices = stackalloc byte[BlockPixelCount];
+
+            if (quality == BlockCompressionQuality.Fast)
+            {
+                ComputeBoundingBoxEndpoints(pixels, endpoints);
+            }
+
+            else
+            {
+                ComputePrincipalAxisEndpoints(pixels, endpoints);
+            }
+
+            var color0 = QuantizeColor(endpoints[0], endpoints[1], endpoints[2]);
+            var color1 = QuantizeColor(endpoints[3], endpoints[4], endpoints[5]);
+            var error = EvaluateColorEndpoints(pixels, ref color0, ref color1, palette, indices);
+
+            if (quality == BlockCompressionQuality.High)
+            {
+                var candidateIndices = stackalloc byte[BlockPixelCount];
+
+                for (var i = 0; i < LeastSquaresIterationCount; i++)
+                {
+                    if (!RefineColorEndpoints(pixels, indices, endpoints))
+                    {
+                        break;
+                    }
+
+                    var candidateColor0 = QuantizeColor(endpoints[0], endpoints[1], endpoints[2]);
+                    var candidateColor1 = QuantizeColor(endpoints[3], endpoints[4], endpoints[5]);
+                    var candidateError = EvaluateColorEndpoints(pixels, ref candidateColor0, ref candidateColor1, palette, candidateIndices);
+
+                    if (candidateError >= error)
+                    {
+                        break;
+                    }
+
+                    error = candidateError;
+                    color0 = candidateColor0;
+                    color1 = candidateColor1;
+                    Buffer.MemoryCopy(candidateIndices, indices, BlockPixelCount, BlockPixelCount);
+                }
+            }
+
+            var packedIndices = 0u;
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                packedIndices |= (uint)indices[i] << (i * 2);
+            }
+
+            *(ushort*)destination = color0;
+            *(ushort*)(destination + 2) = color1;
+            *(uint*)(destination + 4) = packedIndices;
+        }
+
+        // Orders the endpoints for the four color mode and selects the indices, returns the squared error
+        private static unsafe float EvaluateColorEndpoints(float* pixels, ref ushort color0, ref ushort color1, float* palette, byte* indices)
+        {
+            if (color0 < color1)
+            {
+                var temp = color0;
+                color0 = color1;
+                color1 = temp;
+            }
+
+            // Equal endpoints give four identical palette entries so every pixel selects index 0
+            ExpandColor(color0, palette);
+            ExpandColor(color1, palette + 3);
+
+            for (var i = 0; i < 3; i++)
+            {
+                palette[6 + i] = (2.0f * palette[i] + palette[3 + i]) / 3.0f;
+                palette[9 + i] = (palette[i] + 2.0f * palette[3 + i]) / 3.0f;
+            }
+
+            return SelectIndices(pixels, 3, palette, 4, indices);
+        }
+
+        private static unsafe void ComputeBoundingBoxEndpoints(float* pixels, float* endpoints)
+        {
+            var mean = stackalloc float[3];
+
+            for (var c = 0; c < 3; c++)
+            {
+                var channel = pixels + c * BlockPixelCount;
+                var minValue = channel[0];
+                var maxValue = channel[0];
+                var sum = 0.0f;
+
+                for (var i = 0; i < BlockPixelCount; i++)
+                {
+                    minValue = MathF.Min(minValue, channel[i]);
+                    maxValue = MathF.Max(maxValue, channel[i]);
+                    sum += channel[i];
+                }
+
+                var inset = (maxValue - minValue) / 16.0f;
+
+                endpoints[c] = maxValue - inset;
+                endpoints[3 + c] = minValue + inset;
+                mean[c] = sum / BlockPixelCount;
+            }
+
+            // The box diagonal follows green, red and blue are swapped when they are anti-correlated with it
+            for (var c = 0; c < 3; c += 2)
+            {
+                var covariance = 0.0f;
+
+                for (var i = 0; i < BlockPixelCount; i++)
+                {
+                    covariance += (pixels[c * BlockPixelCount + i] - mean[c]) * (pixels[BlockPixelCount + i] - mean[1]);
+                }
+
+                if (covariance < 0.0f)
+                {
+                    var temp = endpoints[c];
+                    endpoints[c] = endpoints[3 + c];
+                    endpoints[3 + c] = temp;
+                }
+            }
+        }
+
+        private static unsafe void ComputePrincipalAxisEndpoints(float* pixels, float* endpoints)
+        {
+            var mean = stackalloc float[3];
+            var covariance = stackalloc float[6];
+
+            for (var c = 0; c < 3; c++)
+            {
+                var sum = 0.0f;
+
+                for (var i = 0; i < BlockPixelCount; i++)
+                {
+                    sum += pixels[c * BlockPixelCount + i];
+                }
+
+                mean[c] = sum / BlockPixelCount;
+            }
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                var r = pixels[i] - mean[0];
+                var g = pixels[BlockPixelCount + i] - mean[1];
+                var b = pixels[BlockPixelCount * 2 + i] - mean[2];
+
+                covariance[0] += r * r;
+                covariance[1] += r * g;
+                covariance[2] += r * b;
+                covariance[3] += g * g;
+                covariance[4] += g * b;
+                covariance[5] += b * b;
+            }
+
+            // Power iteration from the luminance direction
+            var axisR = 0.299f;
+            var axisG = 0.587f;
+            var axisB = 0.114f;
+
+            for (var i = 0; i < 8; i++)
+            {
+                var r = covariance[0] * axisR + covariance[1] * axisG + covariance[2] * axisB;
+                var g = covariance[1] * axisR + covariance[3] * axisG + covariance[4] * axisB;
+                var b = covariance[2] * axisR + covariance[4] * axisG + covariance[5] * axisB;
+                var length = MathF.Max(MathF.Abs(r), MathF.Max(MathF.Abs(g), MathF.Abs(b)));
+
+                if (length < 1e-6f)
+                {
+                    break;
+                }
+
+                axisR = r / length;
+                axisG = g / length;
+                axisB = b / length;
+            }
+
+            var axisLengthSquared = axisR * axisR + axisG * axisG + axisB * axisB;
+            var minProjection = float.MaxValue;
+            var maxProjection = float.MinValue;
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                var projection = (pixels[i] - mean[0]) * axisR + (pixels[BlockPixelCount + i] - mean[1]) * axisG + (pixels[BlockPixelCount * 2 + i] - mean[2]) * axisB;
+
+                minProjection = MathF.Min(minProjection, projection);
+                maxProjection = MathF.Max(maxProjection, projection);
+            }
+
+            var inset = (maxProjection - minProjection) / 16.0f;
+            maxProjection = (maxProjection - inset) / axisLengthSquared;
+            minProjection = (minProjection + inset) / axisLengthSquared;
+
+            endpoints[0] = mean[0] + axisR * maxProjection;
+            endpoints[1] = mean[1] + axisG * maxProjection;
+            endpoints[2] = mean[2] + axisB * maxProjection;
+            endpoints[3] = mean[0] + axisR * minProjection;
+            endpoints[4] = mean[1] + axisG * minProjection;
+            endpoints[5] = mean[2] + axisB * minProjection;
+        }
+
+        // Solves the least squares endpoints for the selected indices, returns false when the system is degenerate
+        private static unsafe bool RefineColorEndpoints(float* pixels, byte* indices, float* endpoints)
+        {
+            var weights0 = stackalloc float[] { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+            var sumWeight00 = 0.0f;
+            var sumWeight01 = 0.0f;
+            var sumWeight11 = 0.0f;
+            var sumColor0 = stackalloc float[3];
+            var sumColor1 = stackalloc float[3];
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                var weight0 = weights0[indices[i]];
+                var weight1 = 1.0f - weight0;
+
+                sumWeight00 += weight0 * weight0;
+                sumWeight01 += weight0 * weight1;
+                sumWeight11 += weight1 * weight1;
+
+                for (var c = 0; c < 3; c++)
+                {
+                    sumColor0[c] += weight0 * pixels[c * BlockPixelCount + i];
+                    sumColor1[c] += weight1 * pixels[c * BlockPixelCount + i];
+                }
+            }
+
+            var determinant = sumWeight00 * sumWeight11 - sumWeight01 * sumWeight01;
+
+            if (MathF.Abs(determinant) < 1e-6f)
+            {
+                return false;
+            }
+
+            for (var c = 0; c < 3; c++)
+            {
+                endpoints[c] = Math.Clamp((sumColor0[c] * sumWeight11 - sumColor1[c] * sumWeight01) / determinant, 0.0f, 255.0f);
+                endpoints[3 + c] = Math.Clamp((sumColor1[c] * sumWeight00 - sumColor0[c] * sumWeight01) / determinant, 0.0f, 255.0f);
+            }
+
+            return true;
+        }
+
+        private static ushort QuantizeColor(float r, float g, float b)
+        {
+            var quantizedR = (int)MathF.Round(Math.Clamp(r, 0.0f, 255.0f) * 31.0f / 255.0f);
+            var quantizedG = (int)MathF.Round(Math.Clamp(g, 0.0f, 255.0f) * 63.0f / 255.0f);
+            var quantizedB = (int)MathF.Round(Math.Clamp(b, 0.0f, 255.0f) * 31.0f / 255.0f);
+
+            return (ushort)((quantizedR << 11) | (quantizedG << 5) | quantizedB);
+        }
+
+        private static unsafe void ExpandColor(ushort color, float* destination)
+        {
+            var r = (color >> 11) & 0x1F;
+            var g = (color >> 5) & 0x3F;
+            var b = color & 0x1F;
+
+            destination[0] = (r << 3) | (r >> 2);
+            destination[1] = (g << 2) | (g >> 4);
+            destination[2] = (b << 3) | (b >> 2);
+        }
+
+        // Single channel block in the eight value mode
+        private static unsafe void CompressAlphaBlock(float* values, BlockCompressionQuality quality, byte* destination)
+        {
+            var palette = stackalloc float[8];
+            var indices = stackalloc byte[BlockPixelCount];
+            var candidateIndices = stackalloc byte[BlockPixelCount];
+
+            var minValue = values[0];
+            var maxValue = values[0];
+
+            for (var i = 1; i < BlockPixelCount; i++)
+            {
+                minValue = MathF.Min(minValue, values[i]);
+                maxValue = MathF.Max(maxValue, values[i]);
+            }
+
+            var endpoint0 = (int)maxValue;
+            var endpoint1 = (int)minValue;
+            var error = EvaluateAlphaEndpoints(values, endpoint0, endpoint1, palette, indices);
+
+            // Pulling the endpoints inwards trades the extremes for a finer ramp
+            if (quality == BlockCompressionQuality.High && endpoint0 > endpoint1)
+            {
+                var bestEndpoint0 = endpoint0;
+                var bestEndpoint1 = endpoint1;
+
+                for (var inset0 = 0; inset0 <= AlphaEndpointSearchRange; inset0++)
+                {
+                    for (var inset1 = 0; inset1 <= AlphaEndpointSearchRange; inset1++)
+                    {
+                        var candidateEndpoint0 = endpoint0 - inset0;
+                        var candidateEndpoint1 = endpoint1 + inset1;
+
+                        if ((inset0 == 0 && inset1 == 0) || candidateEndpoint0 <= candidateEndpoint1)
+                        {
+                            continue;
+                        }
+
+                        var candidateError = EvaluateAlphaEndpoints(values, candidateEndpoint0, candidateEndpoint1, palette, candidateIndices);
+
+                        if (candidateError < error)
+                        {
+                            error = candidateError;
+                            bestEndpoint0 = candidateEndpoint0;
+                            bestEndpoint1 = candidateEndpoint1;
+                            Buffer.MemoryCopy(candidateIndices, indices, BlockPixelCount, BlockPixelCount);
+                        }
+                    }
+                }
+
+                endpoint0 = bestEndpoint0;
+                endpoint1 = bestEndpoint1;
+            }
+
+            var packedIndices = 0ul;
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                packedIndices |= (ulong)indices[i] << (i * 3);
+            }
+
+            destination[0] = (byte)endpoint0;
+            destination[1] = (byte)endpoint1;
+
+            for (var i = 0; i < 6; i++)
+            {
+                destination[2 + i] = (byte)(packedIndices >> (i * 8));
+            }
+        }
+
+        private static unsafe float EvaluateAlphaEndpoints(float* values, int endpoint0, int endpoint1, float* palette, byte* indices)
+        {
+            palette[0] = endpoint0;
+            palette[1] = endpoint1;
+
+            for (var i = 1; i < 7; i++)
+            {
+                palette[i + 1] = ((7 - i) * endpoint0 + i * endpoint1) / 7.0f;
+            }
+
+            // Equal endpoints select the six value mode but every pixel then selects index 0
+            return SelectIndices(values, 1, palette, 8, indices);
+        }
+
+        // Writes the index of the closest palette entry of each pixel and returns the squared error of the block.
+        // The palette is entry major and the pixels channel major, the SIMD paths match the scalar path exactly.
+        private static unsafe float SelectIndices(float* pixels, int channelCount, float* palette, int paletteCount, byte* indices)
+        {
+            var error = 0.0f;
+
+            if (Avx.IsSupported)
+            {
+                var lanes = stackalloc float[8];
+
+                for (var i = 0; i < BlockPixelCount; i += 8)
+                {
+                    var bestDistance = Vector256.Create(float.MaxValue);
+                    var bestIndex = Vector256<float>.Zero;
+
+                    for (var j = 0; j < paletteCount; j++)
+                    {
+                        var distance = Vector256<float>.Zero;
+
+                        for (var c = 0; c < channelCount; c++)
+                        {
+                            var difference = Avx.Subtract(Avx.LoadVector256(pixels + c * BlockPixelCount + i), Vector256.Create(palette[j * channelCount + c]));
+                            distance = Avx.Add(distance, Avx.Multiply(difference, difference));
+                        }
+
+                        var isCloser = Avx.Compare(distance, bestDistance, FloatComparisonMode.OrderedLessThanNonSignaling);
+                        bestDistance = Avx.Min(distance, bestDistance);
+                        bestIndex = Avx.BlendVariable(bestIndex, Vector256.Create((float)j), isCloser);
+                    }
+
+                    Avx.Store(lanes, bestIndex);
+
+                    for (var k = 0; k < 8; k++)
+                    {
+                        indices[i + k] = (byte)lanes[k];
+                    }
+
+                    Avx.Store(lanes, bestDistance);
+
+                    for (var k = 0; k < 8; k++)
+                    {
+                        error += lanes[k];
+                    }
+                }
+            }
+
+            else if (Sse41.IsSupported)
+            {
+                var lanes = stackalloc float[4];
+
+                for (var i = 0; i < BlockPixelCount; i += 4)
+                {
+                    var bestDistance = Vector128.Create(float.MaxValue);
+                    var bestIndex = Vector128<float>.Zero;
+
+                    for (var j = 0; j < paletteCount; j++)
+                    {
+                        var distance = Vector128<float>.Zero;
+
+                        for (var c = 0; c < channelCount; c++)
+                        {
+                            var difference = Sse.Subtract(Sse.LoadVector128(pixels + c * BlockPixelCount + i), Vector128.Create(palette[j * channelCount + c]));
+                            distance = Sse.Add(distance, Sse.Multiply(difference, difference));
+                        }
+
+                        var isCloser = Sse.CompareLessThan(distance, bestDistance);
+                        bestDistance = Sse.Min(distance, bestDistance);
+                        bestIndex = Sse41.BlendVariable(bestIndex, Vector128.Create((float)j), isCloser);
+                    }
+
+                    Sse.Store(lanes, bestIndex);
+
+                    for (var k = 0; k < 4; k++)
+                    {
+                        indices[i + k] = (byte)lanes[k];
+                    }
+
+                    Sse.Store(lanes, bestDistance);
+
+                    for (var k = 0; k < 4; k++)
+                    {
+                        error += lanes[k];
+                    }
+                }
+            }
+
+            else
+            {
+                for (var i = 0; i < BlockPixelCount; i++)
+                {
+                    var bestDistance = float.MaxValue;
+                    var bestIndex = 0;
+
+                    for (var j = 0; j < paletteCount; j++)
+                    {
+                        var distance = 0.0f;
+
+                        for (var c = 0; c < channelCount; c++)
+                        {
+                            var difference = pixels[c * BlockPixelCount + i] - palette[j * channelCount + c];
+                            distance += difference * difference;
+                        }
+
+                        if (distance < bestDistance)
+                        {
+                            bestDistance = distance;
+                            bestIndex = j;
+                        }
+                    }
+
+                    indices[i] = (byte)bestIndex;
+                    error += bestDistance;
+                }
+            }
+
+            return error;
+        }
+
+        private static unsafe void DecompressColorBlock(byte* block, byte* colors, bool isOpaque)
+        {
+            var color0 = *(ushort*)block;
+            var color1 = *(ushort*)(block + 2);
+            var packedIndices = *(uint*)(block + 4);
+            var palette = stackalloc float[12];
+            var alpha3 = 255;
+
+            ExpandColor(color0, palette);
+            ExpandColor(color1, palette + 3);
+
+            for (var c = 0; c < 3; c++)
+            {
+                if (color0 > color1 || isOpaque)
+                {
+                    palette[6 + c] = (2.0f * palette[c] + palette[3 + c]) / 3.0f;
+                    palette[9 + c] = (palette[c] + 2.0f * palette[3 + c]) / 3.0f;
+                }
+
+                else
+                {
+                    palette[6 + c] = (palette[c] + palette[3 + c]) / 2.0f;
+                    palette[9 + c] = 0.0f;
+                    alpha3 = 0;
+                }
+            }
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                var index = (int)((packedIndices >> (i * 2)) & 0x3);
+
+                for (var c = 0; c < 3; c++)
+                {
+                    colors[i * 4 + c] = (byte)MathF.Round(palette[index * 3 + c]);
+                }
+
+                colors[i * 4 + 3] = (byte)((index == 3) ? alpha3 : 255);
+            }
+        }
+
+        private static unsafe void DecompressAlphaBlock(byte* block, byte* values)
+        {
+            var endpoint0 = block[0];
+            var endpoint1 = block[1];
+            var palette = stackalloc float[8];
+            var packedIndices = 0ul;
+
+            palette[0] = endpoint0;
+            palette[1] = endpoint1;
+
+            if (endpoint0 > endpoint1)
+            {
+                for (var i = 1; i < 7; i++)
+                {
+                    palette[i + 1] = ((7 - i) * endpoint0 + i * endpoint1) / 7.0f;
+                }
+            }
+
+            else
+            {
+                for (var i = 1; i < 5; i++)
+                {
+                    palette[i + 1] = ((5 - i) * endpoint0 + i * endpoint1) / 5.0f;
+                }
+
+                palette[6] = 0.0f;
+                palette[7] = 255.0f;
+            }
+
+            for (var i = 0; i < 6; i++)
+            {
+                packedIndices |= (ulong)block[2 + i] << (i * 8);
+            }
+
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                values[i] = (byte)MathF.Round(palette[(packedIndices >> (i * 3)) & 0x7]);
+            }
+        }
+
+        private static unsafe void CopyChannel(byte* values, byte* colors, int channel)
+        {
+            for (var i = 0; i < BlockPixelCount; i++)
+            {
+                colors[i * 4 + channel] = values[i];
+            }
+        }
+    }
+}
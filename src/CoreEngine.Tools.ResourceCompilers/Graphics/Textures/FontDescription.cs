@@ -0,0 +1,135 @@
+using System;
+using System.Collections.Generic;
+using System.Globalization;
+using System.IO;
+using YamlDotNet.RepresentationModel;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
+{
+    public readonly struct UnicodeRange
+    {
+        public UnicodeRange(int first, int last)
+        {
+            this.First = first;
+            this.Last = last;
+        }
+
+        public int First { get; }
+        public int Last { get; }
+
+        // Ranges are written as "0020-007E" or as a single code point "20AC"
+        public static UnicodeRange Parse(string value)
+        {
+            if (value == null)
+            {
+                throw new ArgumentNullException(nameof(value));
+            }
+
+            var separatorIndex = value.IndexOf('-', StringComparison.Ordinal);
+
+            if (separatorIndex < 0)
+            {
+                var codepoint = int.Parse(value.Trim(), NumberStyles.HexNumber, CultureInfo.InvariantCulture);
+                return new UnicodeRange(codepoint, codepoint);
+            }
+
+            var first = int.Parse(value.Substring(0, separatorIndex).Trim(), NumberStyles.HexNumber, CultureInfo.InvariantCulture);
+            var last = int.Parse(value.Substring(separatorIndex + 1).Trim(), NumberStyles.HexNumber, CultureInfo.InvariantCulture);
+
+            if (last < first)
+            {
+                throw new FormatException($"Invalid unicode range: {value}");
+            }
+
+            return new UnicodeRange(first, last);
+        }
+    }
+
+    // Describes the SDF atlas generated from a TrueType font. A .ttf file compiles with the default values, a .cefont
+    // file references the .ttf file and overrides them:
+    //
+    // Font:
+    //   Source: SystemFont.ttf
+    //   UnicodeRanges: [ "0020-007E", "00A0-00FF", "20AC" ]
+    //   GlyphSize: 32
+    //   DistanceRange: 4
+    public class FontDescription
+    {
+        public FontDescription()
+        {
+            this.UnicodeRanges = new List<UnicodeRange>
+            {
+                new UnicodeRange(0x20, 0x7E),
+                new UnicodeRange(0xA0, 0xFF)
+            };
+
+            this.GlyphSize = 32;
+            this.DistanceRange = 4.0f;
+        }
+
+        public string? Source { get; set; }
+        public IList<UnicodeRange> UnicodeRanges { get; }
+
+        // Em size of the glyphs in the atlas, in pixels
+        public int GlyphSize { get; set; }
+
+        // Distance in atlas pixels covered by the values of the field on each side of the glyph outline
+        public float DistanceRange { get; set; }
+
+        public static FontDescription Read(ReadOnlyMemory<byte> sourceData)
+        {
+            var result = new FontDescription();
+
+            using var reader = new StreamReader(new ReadOnlyMemoryStream(sourceData));
+            var yaml = new YamlStream();
+            yaml.Load(reader);
+
+            var rootNode = (YamlMappingNode)yaml.Documents[0].RootNode;
+
+            foreach (var node in rootNode.Children)
+            {
+                if (((YamlScalarNode)node.Key).Value != "Font")
+                {
+                    continue;
+                }
+
+                foreach (var subNode in ((YamlMappingNode)node.Value).Children)
+                {
+                    var key = ((YamlScalarNode)subNode.Key).Value;
+
+                    if (key == "Source")
+                    {
+                        result.Source = ((YamlScalarNode)subNode.Value).Value;
+                    }
+
+                    else if (key == "UnicodeRanges")
+                    {
+                        result.UnicodeRanges.Clear();
+
+                        foreach (var rangeNode in ((YamlSequenceNode)subNode.Value).Children)
+                        {
+                            result.UnicodeRanges.Add(UnicodeRange.Parse(((YamlScalarNode)rangeNode).Value));
+                        }
+                    }
+
+                    else if (key == "GlyphSize")
+                    {
+                        result.GlyphSize = int.Parse(((YamlScalarNode)subNode.Value).Value, CultureInfo.InvariantCulture);
+                    }
+
+                    else if (key == "DistanceRange")
+                    {
+                        result.DistanceRange = float.Parse(((YamlScalarNode)subNode.Value).Value, CultureInfo.InvariantCulture);
+                    }
+                }
+            }
+
+            if (result.GlyphSize <= 0 || result.DistanceRange <= 0)
+            {
+                throw new FormatException("GlyphSize and DistanceRange must be positive.");
+            }
+
+            return result;
+        }
+    }
+}
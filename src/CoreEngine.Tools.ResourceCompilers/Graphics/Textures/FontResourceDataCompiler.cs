@@ -1,27 +1,40 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Linq;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
 using SkiaSharp;
 
 namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
 {
+    // Metrics are in atlas pixels, the runtime scales them by the requested size divided by the glyph size
     public struct GlyphInfo
     {
-        public int AsciiCode { get; set; }
+        public int Codepoint { get; set; }
         public int Width { get; set; }
         public int Height { get; set; }
         public int BearingLeft { get; set; }
-        public int BearingRight { get; set; }
+        public int BearingTop { get; set; }
+        public float Advance { get; set; }
         public float TextureMinPointX { get; set; }
         public float TextureMinPointY { get; set; }
         public float TextureMaxPointX { get; set; }
         public float TextureMaxPointY { get; set; }
     }
 
+    // Fonts are compiled to a single channel signed distance field atlas so that one small texture renders sharp
+    // text at any size
     public class FontResourceDataCompiler : ResourceDataCompiler
     {
+        // The glyphs are rasterized at 4x the atlas resolution before the distance transform
+        private const int SuperSampling = 4;
+
+        // Space left between the packed glyphs so that bilinear filtering doesn't blend neighbours
+        private const int GlyphSpacing = 1;
+
+        private const int MaxAtlasSize = 16384;
+
         public override string Name
         {
             get
@@ -34,7 +47,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
         {
             get
             {
-                return new string[] { ".ttf" };
+                return new string[] { ".ttf", ".cefont" };
             }
         }
 
@@ -46,6 +59,17 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
             }
         }
 
+        public override IList<string> ReadDependencies(ReadOnlyMemory<byte> sourceData)
+        {
+            if (IsFontFile(sourceData.Span))
+            {
+                return Array.Empty<string>();
+            }
+
+            var fontDescription = FontDescription.Read(sourceData);
+            return (fontDescription.Source != null) ? new string[] { fontDescription.Source } : Array.Empty<string>();
+        }
+
         public override Task<ReadOnlyMemory<ResourceEntry>> CompileAsync(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             if (context == null)
@@ -53,117 +77,265 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 throw new ArgumentNullException(nameof(context));
             }
 
-            var version = 1;
-            var glyphCharacters = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-/\\\"'#&!., :$<>[]()";
+            var version = 2;
+            var fontDescription = new FontDescription();
+            var fontData = sourceData;
 
-            using var fontManager = SKFontManager.CreateDefault();
+            if (Path.GetExtension(context.SourceFilename) == ".cefont")
+            {
+                fontDescription = FontDescription.Read(sourceData);
 
-            using var data = SKData.CreateCopy(sourceData.Span);
-            var typeFace = fontManager.CreateTypeface(data);
+                if (fontDescription.Source == null)
+                {
+                    throw new InvalidDataException($"Font description {context.SourceFilename} has no Source.");
+                }
 
-            Logger.WriteMessage($"Font compiler (Width: {typeFace.FontWidth}, Height: {typeFace.FontStyle})");
+                fontData = File.ReadAllBytes(Path.Combine(context.InputDirectory, fontDescription.Source));
+            }
 
-            // TODO: Use premultiplied alpha
+            using var fontManager = SKFontManager.CreateDefault();
+            using var data = SKData.CreateCopy(fontData.Span);
+            using var typeface = fontManager.CreateTypeface(data);
 
-            var textureSize = 512;
+            if (typeface == null)
+            {
+                throw new InvalidDataException($"Font {context.SourceFilename} cannot be read.");
+            }
 
-            using var bitmap = new SKBitmap(textureSize, textureSize, SKImageInfo.PlatformColorType, SKAlphaType.Opaque);
-            using var canvas = new SKCanvas(bitmap);
+            var codepoints = ReadCodepoints(typeface, fontDescription.UnicodeRanges);
+            var glyphInfos = new GlyphInfo[codepoints.Count];
+            var glyphData = new byte[]?[codepoints.Count];
 
-            canvas.Clear(SKColors.Transparent);
+            using (BuildTracer.BeginSpan("RasterizeGlyphs", "Font"))
+            {
+                // SKTypeface is immutable, each glyph uses its own paint and bitmap
+                Parallel.For(0, codepoints.Count, i =>
+                {
+                    glyphData[i] = RasterizeGlyph(typeface, codepoints[i], fontDescription, out glyphInfos[i]);
+                });
+            }
 
-            using var paint1 = new SKPaint {
-                TextSize = 34.0f,
-                IsAntialias = true,
-                //LcdRenderText = true,
-                Color = SKColors.White,
-                Style = SKPaintStyle.Fill
+            using var paint = new SKPaint
+            {
+                Typeface = typeface,
+                TextSize = fontDescription.GlyphSize
             };
 
-            var lineSpacing = paint1.GetFontMetrics(out var fontMetrics);
-            var glyphWidths = paint1.GetGlyphWidths(glyphCharacters);
-            var glyphPositions = new SKPoint[glyphWidths.Length];
-            var currentXPosition = 0.0f;
-            var currentYPosition = 0.0f;
-
-            var glyphInfos = new GlyphInfo[glyphCharacters.Length];
+            var lineHeight = paint.GetFontMetrics(out var fontMetrics);
 
-            // TODO: Glyph Bearing needs to be taken into account
+            byte[] atlas;
+            int atlasWidth;
+            int atlasHeight;
 
-            for (var i = 0; i < glyphWidths.Length; i++)
+            using (BuildTracer.BeginSpan("PackGlyphs", "Font"))
             {
-                if (currentXPosition + glyphWidths[i] + 10 > textureSize)
-                {
-                    currentXPosition = 0;
-                    currentYPosition += fontMetrics.Descent - fontMetrics.Ascent + 10;
-                }
-
-                glyphInfos[i] = new GlyphInfo
-                {
-                    AsciiCode = glyphCharacters[i],
-                    Width = (int)glyphWidths[i],
-                    Height = (int)(fontMetrics.Descent - fontMetrics.Ascent),
-                    TextureMinPointX = currentXPosition / textureSize,
-                    TextureMinPointY = currentYPosition / textureSize,
-                    TextureMaxPointX = (currentXPosition + (int)glyphWidths[i]) / textureSize,
-                    TextureMaxPointY = (currentYPosition + (fontMetrics.Descent - fontMetrics.Ascent)) / textureSize
-                };
-
-                Logger.WriteMessage($"GlyphInfo for '{(char)glyphInfos[i].AsciiCode}': Width: {glyphInfos[i].Width} - Height: {glyphInfos[i].Height} - TexMin: ({glyphInfos[i].TextureMinPointX}, {glyphInfos[i].TextureMinPointY}) - TexMax: ({glyphInfos[i].TextureMaxPointX}, {glyphInfos[i].TextureMaxPointY})");
-
-                glyphPositions[i] = new SKPoint(currentXPosition, (currentYPosition - fontMetrics.Ascent));
-                currentXPosition += glyphWidths[i] + 10;
+                atlas = PackGlyphs(glyphInfos, glyphData, out atlasWidth, out atlasHeight);
             }
 
-            canvas.DrawPositionedText(glyphCharacters, glyphPositions, paint1);
-
+            Logger.WriteMessage($"Font compiler (Glyphs: {glyphInfos.Length}, Atlas: {atlasWidth}x{atlasHeight}, Glyph Size: {fontDescription.GlyphSize})");
 
-            var bitmapData = bitmap.Pixels; // TODO: Use the pixel span method
-            var imageDataSize = 4 * bitmap.Width * bitmap.Height;
-            
-            var destinationMemoryStream = new MemoryStream();
+            var destinationBuffer = new PooledBufferWriter(atlas.Length + glyphInfos.Length * 40 + 1024);
 
-            using var streamWriter = new BinaryWriter(destinationMemoryStream);
+            using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
             streamWriter.Write(new char[] { 'F', 'O', 'N', 'T' });
             streamWriter.Write(version);
 
+            streamWriter.Write(fontDescription.GlyphSize);
+            streamWriter.Write(fontDescription.DistanceRange);
+            streamWriter.Write(-fontMetrics.Ascent);
+            streamWriter.Write(fontMetrics.Descent);
+            streamWriter.Write(lineHeight);
+
             streamWriter.Write(glyphInfos.Length);
 
             for (var i = 0; i < glyphInfos.Length; i++)
             {
-                streamWriter.Write(glyphInfos[i].AsciiCode);
+                streamWriter.Write(glyphInfos[i].Codepoint);
                 streamWriter.Write(glyphInfos[i].Width);
                 streamWriter.Write(glyphInfos[i].Height);
                 streamWriter.Write(glyphInfos[i].BearingLeft);
-                streamWriter.Write(glyphInfos[i].BearingRight);
+                streamWriter.Write(glyphInfos[i].BearingTop);
+                streamWriter.Write(glyphInfos[i].Advance);
                 streamWriter.Write(glyphInfos[i].TextureMinPointX);
                 streamWriter.Write(glyphInfos[i].TextureMinPointY);
                 streamWriter.Write(glyphInfos[i].TextureMaxPointX);
                 streamWriter.Write(glyphInfos[i].TextureMaxPointY);
             }
 
-            streamWriter.Write(bitmap.Width);
-            streamWriter.Write(bitmap.Height);
-            // TODO: Write format
-            // TODO: Write mips info
-            streamWriter.Write(imageDataSize);
-            
-            for (var i = 0; i < bitmapData.Length; i++)
+            // Distance fields are magnified and minified smoothly by bilinear filtering so the atlas has no mips
+            streamWriter.Write(atlasWidth);
+            streamWriter.Write(atlasHeight);
+            streamWriter.Write((int)TextureFormat.R8Unorm);
+            streamWriter.Write(1);
+            streamWriter.Write(atlas.Length);
+            streamWriter.Write(atlas);
+
+            streamWriter.Flush();
+
+            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", destinationBuffer);
+
+            return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry }));
+        }
+
+        // TrueType, OpenType and font collection signatures
+        private static bool IsFontFile(ReadOnlySpan<byte> data)
+        {
+            if (data.Length < 4)
             {
-                streamWriter.Write((byte)255);
-                streamWriter.Write((byte)255);
-                streamWriter.Write((byte)255);
-                streamWriter.Write(bitmapData[i].Alpha);
+                return false;
             }
 
-            streamWriter.Flush();
+            return (data[0] == 0 && data[1] == 1 && data[2] == 0 && data[3] == 0) ||
+                   (data[0] == 't' && data[1] == 'r' && data[2] == 'u' && data[3] == 'e') ||
+                   (data[0] == 'O' && data[1] == 'T' && data[2] == 'T' && data[3] == 'O') ||
+                   (data[0] == 't' && data[1] == 't' && data[2] == 'c' && data[3] == 'f');
+        }
+
+        // Code points missing from the font are skipped instead of being rendered with the missing glyph
+        private static IList<int> ReadCodepoints(SKTypeface typeface, IList<UnicodeRange> unicodeRanges)
+        {
+            var result = new SortedSet<int>();
+
+            foreach (var unicodeRange in unicodeRanges)
+            {
+                for (var codepoint = unicodeRange.First; codepoint <= unicodeRange.Last; codepoint++)
+                {
+                    if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+                    {
+                        continue;
+                    }
+
+                    var glyphs = typeface.GetGlyphs(char.ConvertFromUtf32(codepoint));
+
+                    if (glyphs.Length > 0 && glyphs[0] != 0)
+                    {
+                        result.Add(codepoint);
+                    }
+                }
+            }
+
+            return result.ToList();
+        }
 
-            destinationMemoryStream.Flush();
+        private static byte[]? RasterizeGlyph(SKTypeface typeface, int codepoint, FontDescription fontDescription, out GlyphInfo glyphInfo)
+        {
+            var text = char.ConvertFromUtf32(codepoint);
+
+            using var paint = new SKPaint
+            {
+                Typeface = typeface,
+                TextSize = fontDescription.GlyphSize * SuperSampling,
+                IsAntialias = true,
+                Color = SKColors.White,
+                Style = SKPaintStyle.Fill
+            };
+
+            var advances = paint.GetGlyphWidths(text, out var bounds);
+
+            glyphInfo = new GlyphInfo
+            {
+                Codepoint = codepoint,
+                Advance = advances[0] / SuperSampling
+            };
+
+            if (bounds[0].Width <= 0 || bounds[0].Height <= 0)
+            {
+                return null;
+            }
 
-            var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", resourceData);
+            // The quad is aligned on atlas pixels and extends past the outline by the distance range
+            var padding = (int)Math.Ceiling(fontDescription.DistanceRange) + 1;
+            var left = (int)Math.Floor(bounds[0].Left / SuperSampling) - padding;
+            var top = (int)Math.Floor(bounds[0].Top / SuperSampling) - padding;
+            var right = (int)Math.Ceiling(bounds[0].Right / SuperSampling) + padding;
+            var bottom = (int)Math.Ceiling(bounds[0].Bottom / SuperSampling) + padding;
+
+            glyphInfo.Width = right - left;
+            glyphInfo.Height = bottom - top;
+            glyphInfo.BearingLeft = left;
+            glyphInfo.BearingTop = top;
+
+            using var bitmap = new SKBitmap(new SKImageInfo(glyphInfo.Width * SuperSampling, glyphInfo.Height * SuperSampling, SKColorType.Alpha8, SKAlphaType.Premul));
+            using var canvas = new SKCanvas(bitmap);
+
+            canvas.Clear(SKColors.Transparent);
+            canvas.DrawText(text, -left * SuperSampling, -top * SuperSampling, paint);
+            canvas.Flush();
+
+            Logger.WriteMessage(LogMessageTypes.Debug, "Glyph U+{0:X4}: {1}x{2}", codepoint, glyphInfo.Width, glyphInfo.Height);
+
+            return SignedDistanceField.Generate(bitmap.GetPixelSpan(), bitmap.Width, bitmap.Height, bitmap.RowBytes, SuperSampling, fontDescription.DistanceRange);
+        }
+
+        // The atlas width is the power of two closest to a square atlas and its height is cropped to the packed glyphs
+        private static byte[] PackGlyphs(GlyphInfo[] glyphInfos, byte[]?[] glyphData, out int atlasWidth, out int atlasHeight)
+        {
+            var packedArea = 0;
+            var maxGlyphWidth = 0;
+
+            for (var i = 0; i < glyphInfos.Length; i++)
+            {
+                if (glyphData[i] != null)
+                {
+                    packedArea += (glyphInfos[i].Width + GlyphSpacing) * (glyphInfos[i].Height + GlyphSpacing);
+                    maxGlyphWidth = Math.Max(maxGlyphWidth, glyphInfos[i].Width + GlyphSpacing);
+                }
+            }
+
+            atlasWidth = 4;
+
+            while (atlasWidth < MaxAtlasSize && (atlasWidth * atlasWidth < packedArea || atlasWidth < maxGlyphWidth))
+            {
+                atlasWidth *= 2;
+            }
+
+            var packer = new SkylinePacker(atlasWidth, MaxAtlasSize);
+            var glyphPositions = new (int X, int Y)[glyphInfos.Length];
+
+            var packOrder = Enumerable.Range(0, glyphInfos.Length)
+                                      .Where(i => glyphData[i] != null)
+                                      .OrderByDescending(i => glyphInfos[i].Height)
+                                      .ThenByDescending(i => glyphInfos[i].Width);
+
+            foreach (var i in packOrder)
+            {
+                if (!packer.TryPack(glyphInfos[i].Width + GlyphSpacing, glyphInfos[i].Height + GlyphSpacing, out var x, out var y))
+                {
+                    throw new InvalidDataException("The font glyphs don't fit in the maximum atlas size.");
+                }
+
+                glyphPositions[i] = (x, y);
+            }
+
+            // Block aligned height so that the atlas can be block compressed later
+            atlasHeight = Math.Max(4, (packer.UsedHeight + 3) & ~3);
+            var atlas = new byte[atlasWidth * atlasHeight];
+
+            for (var i = 0; i < glyphInfos.Length; i++)
+            {
+                var data = glyphData[i];
+
+                if (data == null)
+                {
+                    continue;
+                }
+
+                var width = glyphInfos[i].Width;
+                var height = glyphInfos[i].Height;
+                var (x, y) = glyphPositions[i];
+
+                for (var row = 0; row < height; row++)
+                {
+                    Array.Copy(data, row * width, atlas, (y + row) * atlasWidth + x, width);
+                }
+
+                glyphInfos[i].TextureMinPointX = (float)x / atlasWidth;
+                glyphInfos[i].TextureMinPointY = (float)y / atlasHeight;
+                glyphInfos[i].TextureMaxPointX = (float)(x + width) / atlasWidth;
+                glyphInfos[i].TextureMaxPointY = (float)(y + height) / atlasHeight;
+            }
 
-            return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry }));
+            return atlas;
         }
     }
-}
\ No newline at end of file
+}
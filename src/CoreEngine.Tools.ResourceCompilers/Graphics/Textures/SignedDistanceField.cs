@@ -0,0 +1,143 @@
+using System;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
+{
+    // Converts a supersampled coverage image into a single channel signed distance field. The exact euclidean distance
+    // transform of Felzenszwalb and Huttenlocher is computed on the supersampled image and averaged down so that the
+    // outline position keeps a subpixel precision.
+    public static class SignedDistanceField
+    {
+        private const double Infinity = 1e20;
+
+        // The values are 0.5 on the outline, they increase inside the glyph and reach 0 and 1 at distanceRange pixels
+        // of the outline (in destination pixels)
+        public static byte[] Generate(ReadOnlySpan<byte> coverage, int width, int height, int rowBytes, int downsampleFactor, float distanceRange)
+        {
+            if (width % downsampleFactor != 0 || height % downsampleFactor != 0)
+            {
+                throw new ArgumentException("The coverage size must be a multiple of the downsample factor.", nameof(downsampleFactor));
+            }
+
+            var outsideDistances = new double[width * height];
+            var insideDistances = new double[width * height];
+
+            for (var y = 0; y < height; y++)
+            {
+                for (var x = 0; x < width; x++)
+                {
+                    var isInside = coverage[y * rowBytes + x] >= 128;
+
+                    outsideDistances[y * width + x] = isInside ? 0.0 : Infinity;
+                    insideDistances[y * width + x] = isInside ? Infinity : 0.0;
+                }
+            }
+
+            ComputeDistanceTransform(outsideDistances, width, height);
+            ComputeDistanceTransform(insideDistances, width, height);
+
+            var destinationWidth = width / downsampleFactor;
+            var destinationHeight = height / downsampleFactor;
+            var result = new byte[destinationWidth * destinationHeight];
+            var sampleScale = 1.0 / (downsampleFactor * downsampleFactor * downsampleFactor);
+
+            for (var y = 0; y < destinationHeight; y++)
+            {
+                for (var x = 0; x < destinationWidth; x++)
+                {
+                    var distance = 0.0;
+
+                    for (var j = 0; j < downsampleFactor; j++)
+                    {
+                        var rowOffset = (y * downsampleFactor + j) * width + x * downsampleFactor;
+
+                        for (var i = 0; i < downsampleFactor; i++)
+                        {
+                            // The outline lies between the pixel centers of the inside and outside pixels
+                            var outsideDistance = Math.Sqrt(outsideDistances[rowOffset + i]);
+                            var insideDistance = Math.Sqrt(insideDistances[rowOffset + i]);
+
+                            distance += (outsideDistance > 0.0) ? outsideDistance - 0.5 : 0.5 - insideDistance;
+                        }
+                    }
+
+                    // Distances are converted from supersampled pixels to destination pixels
+                    var value = 0.5 - distance * sampleScale / (2.0 * distanceRange);
+                    result[y * destinationWidth + x] = (byte)Math.Round(Math.Clamp(value, 0.0, 1.0) * 255.0);
+                }
+            }
+
+            return result;
+        }
+
+        // Squared distances to the nearest zero value, the columns are transformed and then the rows
+        private static void ComputeDistanceTransform(double[] data, int width, int height)
+        {
+            var length = Math.Max(width, height);
+            var values = new double[length];
+            var distances = new double[length];
+            var parabolaPositions = new int[length];
+            var boundaries = new double[length + 1];
+
+            for (var x = 0; x < width; x++)
+            {
+                for (var y = 0; y < height; y++)
+                {
+                    values[y] = data[y * width + x];
+                }
+
+                ComputeDistanceTransform(values, distances, height, parabolaPositions, boundaries);
+
+                for (var y = 0; y < height; y++)
+                {
+                    data[y * width + x] = distances[y];
+                }
+            }
+
+            for (var y = 0; y < height; y++)
+            {
+                Array.Copy(data, y * width, values, 0, width);
+                ComputeDistanceTransform(values, distances, width, parabolaPositions, boundaries);
+                Array.Copy(distances, 0, data, y * width, width);
+            }
+        }
+
+        // Lower envelope of the parabolas rooted at each sample
+        private static void ComputeDistanceTransform(double[] values, double[] distances, int length, int[] parabolaPositions, double[] boundaries)
+        {
+            var k = 0;
+            parabolaPositions[0] = 0;
+            boundaries[0] = -Infinity;
+            boundaries[1] = Infinity;
+
+            for (var q = 1; q < length; q++)
+            {
+                double intersection;
+
+                do
+                {
+                    var p = parabolaPositions[k];
+                    intersection = ((values[q] + q * q) - (values[p] + p * p)) / (2.0 * (q - p));
+                }
+                while (intersection <= boundaries[k] && --k >= 0);
+
+                k++;
+                parabolaPositions[k] = q;
+                boundaries[k] = intersection;
+                boundaries[k + 1] = Infinity;
+            }
+
+            k = 0;
+
+            for (var q = 0; q < length; q++)
+            {
+                while (boundaries[k + 1] < q)
+                {
+                    k++;
+                }
+
+                var p = parabolaPositions[k];
+                distances[q] = (q - p) * (q - p) + values[p];
+            }
+        }
+    }
+}
@@ -0,0 +1,148 @@
+using System;
+using System.Collections.Generic;
+
+namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
+{
+    // Packs rectangles in a texture with the skyline bottom-left heuristic: the top edge of the packed rectangles is
+    // kept as a list of horizontal segments and each rectangle is placed where its top edge is the lowest. Rectangles
+    // should be packed from the tallest to the smallest.
+    public class SkylinePacker
+    {
+        private struct SkylineNode
+        {
+            public SkylineNode(int x, int y, int width)
+            {
+                this.X = x;
+                this.Y = y;
+                this.Width = width;
+            }
+
+            public int X;
+            public int Y;
+            public int Width;
+        }
+
+        private readonly List<SkylineNode> skyline = new List<SkylineNode>();
+
+        public SkylinePacker(int width, int height)
+        {
+            if (width <= 0 || height <= 0)
+            {
+                throw new ArgumentOutOfRangeException(nameof(width), "The packer size must be positive.");
+            }
+
+            this.Width = width;
+            this.Height = height;
+            this.skyline.Add(new SkylineNode(0, 0, width));
+        }
+
+        public int Width { get; }
+        public int Height { get; }
+
+        // Bottom edge of the lowest packed rectangle, the texture can be cropped to this height once the packing is done
+        public int UsedHeight { get; private set; }
+
+        public bool TryPack(int width, int height, out int x, out int y)
+        {
+            x = 0;
+            y = 0;
+
+            var bestIndex = -1;
+            var bestBottom = int.MaxValue;
+            var bestWidth = int.MaxValue;
+
+            for (var i = 0; i < this.skyline.Count; i++)
+            {
+                if (!TryFit(i, width, height, out var nodeY))
+                {
+                    continue;
+                }
+
+                // Ties are broken with the narrowest segment so that wide segments stay available for wide rectangles
+                if (nodeY + height < bestBottom || (nodeY + height == bestBottom && this.skyline[i].Width < bestWidth))
+                {
+                    bestIndex = i;
+                    bestBottom = nodeY + height;
+                    bestWidth = this.skyline[i].Width;
+                    x = this.skyline[i].X;
+                    y = nodeY;
+                }
+            }
+
+            if (bestIndex < 0)
+            {
+                return false;
+            }
+
+            AddNode(bestIndex, x, y + height, width);
+            this.UsedHeight = Math.Max(this.UsedHeight, y + height);
+
+            return true;
+        }
+
+        // The rectangle rests on the highest segment it spans starting at the segment index
+        private bool TryFit(int index, int width, int height, out int y)
+        {
+            y = 0;
+
+            if (this.skyline[index].X + width > this.Width)
+            {
+                return false;
+            }
+
+            var remainingWidth = width;
+
+            for (var i = index; remainingWidth > 0; i++)
+            {
+                y = Math.Max(y, this.skyline[i].Y);
+
+                if (y + height > this.Height)
+                {
+                    return false;
+                }
+
+                remainingWidth -= this.skyline[i].Width;
+            }
+
+            return true;
+        }
+
+        private void AddNode(int index, int x, int y, int width)
+        {
+            this.skyline.Insert(index, new SkylineNode(x, y, width));
+
+            // The segments covered by the new one are shrunk or removed
+            var i = index + 1;
+
+            while (i < this.skyline.Count)
+            {
+                var previous = this.skyline[i - 1];
+                var node = this.skyline[i];
+                var overlap = previous.X + previous.Width - node.X;
+
+                if (overlap <= 0)
+                {
+                    break;
+                }
+
+                if (overlap < node.Width)
+                {
+                    this.skyline[i] = new SkylineNode(node.X + overlap, node.Y, node.Width - overlap);
+                    break;
+                }
+
+                this.skyline.RemoveAt(i);
+            }
+
+            for (i = 0; i < this.skyline.Count - 1; i++)
+            {
+                if (this.skyline[i].Y == this.skyline[i + 1].Y)
+                {
+                    this.skyline[i] = new SkylineNode(this.skyline[i].X, this.skyline[i].Y, this.skyline[i].Width + this.skyline[i + 1].Width);
+                    this.skyline.RemoveAt(i + 1);
+                    i--;
+                }
+            }
+        }
+    }
+}
@@ -1,6 +1,7 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
+using System.Numerics;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
 using SkiaSharp;
@@ -24,11 +25,16 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
         BC5,
         BC6,
         BC7Srgb,
-        Rgba32Float
+        Rgba32Float,
+        R8Unorm
     }
 
     public class TextureResourceDataCompiler : ResourceDataCompiler
     {
+        // Mips outside of the mip tail start on a page so they can be read with unbuffered positioned reads
+        private const int MipAlignment = 4096;
+        private const int MipTailAlignment = 16;
+
         public override string Name
         {
             get
@@ -53,6 +59,13 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
             }
         }
 
+        public override long EstimateMemoryUsage(long sourceDataLength)
+        {
+            // Decoded surfaces, the mip chain and the float working buffers of the compressor
+            // are far bigger than the compressed source image
+            return sourceDataLength * 16;
+        }
+
         public unsafe override Task<ReadOnlyMemory<ResourceEntry>> CompileAsync(ReadOnlyMemory<byte> sourceData, CompilerContext context)
         {
             if (context == null)
@@ -60,7 +73,9 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 throw new ArgumentNullException(nameof(context));
             }
 
-            var version = 1;
+            // Version 2: a table of mip offsets follows the header, small mips are packed in a mip tail after the table
+            // and the other mips are aligned on MipAlignment
+            var version = 2;
 
             bool isNormalMap = context.SourceFilename.Contains("ddn") || context.SourceFilename.ToLower().Contains("normal");
             bool isBumpMap = context.SourceFilename.Contains("bump");
@@ -69,6 +84,11 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
             bool isHdr = Path.GetExtension(context.SourceFilename) == ".hdr";
             bool isCubeMap = context.SourceFilename.Contains("cubemap");
 
+            // Iteration builds trade quality for latency, full builds encode in shipping quality
+            var isIterationBuild = context.BuildProfile == BuildProfile.Iteration;
+            var mipMapFilter = isIterationBuild ? ImageFilter.Box : ImageFilter.CatmullRom;
+            var compressionQuality = isIterationBuild ? BlockCompressionQuality.Fast : BlockCompressionQuality.High;
+
             Logger.WriteMessage($"NormalMap: {isNormalMap}");
             Logger.WriteMessage($"BumpMap: {isBumpMap}");
             Logger.WriteMessage($"Hdr: {isHdr}");
@@ -79,17 +99,22 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] {}));
             }
 
-            using var memoryStream = new MemoryStream(sourceData.ToArray());
+            using var sourceStream = new ReadOnlyMemoryStream(sourceData);
             DDSContainer? compressedImage = null;
 
+            // Mip chains of each face, block compressed in the in-tree encoder or copied from Teximp
+            var faces = new List<IList<byte[]>>();
+            var width = 0;
+            var height = 0;
+
             if (Path.GetExtension(context.SourceFilename) == ".ddsold")
             {
-                compressedImage = DDSFile.Read(memoryStream);
+                compressedImage = DDSFile.Read(sourceStream);
             }
 
             else if (isCubeMap)
             {
-                var image = Surface.LoadFromStream(memoryStream);
+                var image = Surface.LoadFromStream(sourceStream);
                 image.FlipVertically();
                 var result = image.ConvertTo(ImageConversion.ToRGBAF);
                 Logger.WriteMessage($"Conversion: {result}");
@@ -103,7 +128,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                     faceImage.SaveToFile(ImageFormat.EXR, $"Master{i}.hdr");
 
                     var faceMipMaps = new List<Surface>();
-                    faceImage.GenerateMipMaps(faceMipMaps, ImageFilter.CatmullRom);
+                    faceImage.GenerateMipMaps(faceMipMaps, mipMapFilter);
 
                     var mipChainItem = new MipChain();
                     compressedImage.MipChains.Add(mipChainItem);
@@ -111,7 +136,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                     var counter = 0;
                     foreach (var mipLevel in faceMipMaps)
                     {
-                        Logger.WriteMessage($"{mipLevel.Width} {mipLevel.Height}");
+                        Logger.WriteMessage(LogMessageTypes.Debug, "{0} {1}", mipLevel.Width, mipLevel.Height);
                         mipChainItem.Add(new MipData(mipLevel.Width, mipLevel.Height, mipLevel.Pitch, mipLevel.DataPtr));
                         mipLevel.SaveToFile(ImageFormat.EXR, $"MipLevel{i}_{counter}.hdr");
 
@@ -120,9 +145,15 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 }
             }
 
-            else
+            else if (!isHdr)
             {
-                var image = Surface.LoadFromStream(memoryStream);
+                Surface image;
+
+                using (BuildTracer.BeginSpan("DecodeImage", "Texture"))
+                {
+                    image = Surface.LoadFromStream(sourceStream);
+                }
+
                 image.FlipVertically();
                 Logger.WriteMessage($"IsTransparent: {image.IsTransparent}");
 
@@ -164,26 +195,56 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 //     }
                 // }
 
-                using var compressor = new Compressor();
-                compressor.Input.GenerateMipmaps = true;
-                compressor.Input.MipmapFilter = MipmapFilter.Kaiser;
-                compressor.Input.SetData(image);
+                image.ConvertTo(ImageConversion.To32Bits);
 
-                if (image.IsTransparent)
+                var blockCompressionFormat = GetBlockCompressionFormat(context.SourceFilename);
+                var mipLevels = new List<Surface>();
+
+                using (BuildTracer.BeginSpan("GenerateMipMaps", "Texture"))
                 {
-                    compressor.Input.AlphaMode = AlphaMode.Transparency;
+                    image.GenerateMipMaps(mipLevels, mipMapFilter);
                 }
 
-                if (isNormalMap)
+                width = image.Width;
+                height = image.Height;
+
+                var mipChain = new List<byte[]>();
+                faces.Add(mipChain);
+
+                using (var compressSpan = BuildTracer.BeginSpan("BlockCompress", "Texture"))
                 {
-                    compressor.Input.IsNormalMap = true;
+                    compressSpan.SetArgument("format", blockCompressionFormat.ToString());
+                    compressSpan.SetArgument("quality", compressionQuality.ToString());
+
+                    foreach (var mipLevel in mipLevels)
+                    {
+                        var rgbaData = ReadRgbaData(mipLevel, isNormalMap);
+                        mipChain.Add(BlockCompressor.Compress(rgbaData, mipLevel.Width, mipLevel.Height, blockCompressionFormat, compressionQuality));
+                        mipLevel.Dispose();
+                    }
                 }
 
-                compressor.Compression.Format = isNormalMap ? CompressionFormat.BC5 : (isBumpMap ? CompressionFormat.BC4 : (isHdr ? CompressionFormat.BC6 : CompressionFormat.BC3));
+                image.Dispose();
+            }
+
+            else
+            {
+                var image = Surface.LoadFromStream(sourceStream);
+                image.FlipVertically();
+
+                using var compressor = new Compressor();
+                compressor.Input.GenerateMipmaps = true;
+                compressor.Input.MipmapFilter = isIterationBuild ? MipmapFilter.Box : MipmapFilter.Kaiser;
+                compressor.Input.SetData(image);
+                compressor.Compression.Format = CompressionFormat.BC6;
+                compressor.Compression.Quality = isIterationBuild ? CompressionQuality.Fastest : CompressionQuality.Normal;
                 compressor.Output.OutputFileFormat = OutputFileFormat.DDS10;
                 compressor.Output.IsSRGBColorSpace = true;
 
-                compressor.Process(out compressedImage);
+                using (BuildTracer.BeginSpan("TeximpCompress", "Texture"))
+                {
+                    compressor.Process(out compressedImage);
+                }
 
                 if (compressedImage != null)
                 {
@@ -196,46 +257,193 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 }
             }
 
-            Logger.WriteMessage($"Texture compiler (Width: {compressedImage.MipChains[0][0].Width}, Height: {compressedImage.MipChains[0][0].Height})");
+            if (compressedImage != null)
+            {
+                width = compressedImage.MipChains[0][0].Width;
+                height = compressedImage.MipChains[0][0].Height;
+
+                foreach (var mipChainItem in compressedImage.MipChains)
+                {
+                    var mipChain = new List<byte[]>();
+                    faces.Add(mipChain);
+
+                    foreach (var mipData in mipChainItem)
+                    {
+                        mipChain.Add(new Span<byte>(mipData.Data.ToPointer(), mipData.SizeInBytes).ToArray());
+                    }
+                }
+            }
+
+            Logger.WriteMessage($"Texture compiler (Width: {width}, Height: {height})");
 
-            var destinationMemoryStream = new MemoryStream();
+            using var writeSpan = BuildTracer.BeginSpan("WriteTexture", "Texture");
+            var destinationBuffer = new PooledBufferWriter();
 
-            using var streamWriter = new BinaryWriter(destinationMemoryStream);
+            using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
             streamWriter.Write(new char[] { 'T', 'E', 'X', 'T', 'U', 'R', 'E' });
             streamWriter.Write(version);
-            streamWriter.Write(compressedImage.MipChains[0][0].Width);
-            streamWriter.Write(compressedImage.MipChains[0][0].Height);
+            streamWriter.Write(width);
+            streamWriter.Write(height);
             streamWriter.Write(isNormalMap ? (int)TextureFormat.BC5 : isBumpMap ? (int)TextureFormat.BC4 : isCubeMap ? (int)TextureFormat.Rgba32Float : (int)TextureFormat.BC3Srgb);
 
-            var faceCount = compressedImage.MipChains.Count;
-            var mipLevels = compressedImage.MipChains[0].Count;
+            var faceCount = faces.Count;
+            var mipLevelCount = faces[0].Count;
 
             Logger.WriteMessage($"Face Count: {faceCount}");
-            Logger.WriteMessage($"Mip Levels: {mipLevels}");
+            Logger.WriteMessage($"Mip Levels: {mipLevelCount}");
             streamWriter.Write(faceCount);
-            streamWriter.Write(mipLevels);
+            streamWriter.Write(mipLevelCount);
+
+            // Mips smaller than a page would mostly be padding so they are packed together and the runtime
+            // loads the whole tail with the header in one read
+            var mipTailLevel = 0;
+
+            while (mipTailLevel < mipLevelCount && faces[0][mipTailLevel].Length >= MipAlignment)
+            {
+                mipTailLevel++;
+            }
+
+            var mipOffsets = new long[faceCount, mipLevelCount];
+            var headerSize = destinationBuffer.WrittenCount + sizeof(int) + sizeof(long) + sizeof(int) + faceCount * mipLevelCount * (sizeof(long) + sizeof(int));
+            var mipTailOffset = AlignOffset(headerSize, MipTailAlignment);
+            var offset = mipTailOffset;
 
             for (var i = 0; i < faceCount; i++)
             {
-                for (var j = 0; j < mipLevels; j++)
+                for (var j = mipTailLevel; j < mipLevelCount; j++)
                 {
-                    var mipData = compressedImage.MipChains[i][j];
-                    var mipRawData = new Span<byte>(mipData.Data.ToPointer(), mipData.SizeInBytes);
+                    offset = AlignOffset(offset, MipTailAlignment);
+                    mipOffsets[i, j] = offset;
+                    offset += faces[i][j].Length;
+                }
+            }
 
-                    streamWriter.Write(mipData.SizeInBytes);
-                    streamWriter.Write(mipRawData);
+            var mipTailSize = (int)(offset - mipTailOffset);
+
+            // Mips are ordered from the smallest to the largest so that streaming reads move forward in the file
+            for (var j = mipTailLevel - 1; j >= 0; j--)
+            {
+                for (var i = 0; i < faceCount; i++)
+                {
+                    offset = AlignOffset(offset, MipAlignment);
+                    mipOffsets[i, j] = offset;
+                    offset += faces[i][j].Length;
+                }
+            }
+
+            Logger.WriteMessage($"Mip Tail: level {mipTailLevel}, {mipTailSize} bytes");
+            streamWriter.Write(mipTailLevel);
+            streamWriter.Write(mipTailOffset);
+            streamWriter.Write(mipTailSize);
+
+            for (var i = 0; i < faceCount; i++)
+            {
+                for (var j = 0; j < mipLevelCount; j++)
+                {
+                    streamWriter.Write(mipOffsets[i, j]);
+                    streamWriter.Write(faces[i][j].Length);
+                }
+            }
+
+            for (var i = 0; i < faceCount; i++)
+            {
+                for (var j = mipTailLevel; j < mipLevelCount; j++)
+                {
+                    WritePadding(streamWriter, mipOffsets[i, j]);
+                    streamWriter.Write(faces[i][j]);
+                }
+            }
+
+            for (var j = mipTailLevel - 1; j >= 0; j--)
+            {
+                for (var i = 0; i < faceCount; i++)
+                {
+                    WritePadding(streamWriter, mipOffsets[i, j]);
+                    streamWriter.Write(faces[i][j]);
                 }
             }
 
             streamWriter.Flush();
-            destinationMemoryStream.Flush();
 
-            var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", resourceData);
+            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", destinationBuffer);
 
             return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry }));
         }
 
+        public static BlockCompressionFormat GetBlockCompressionFormat(string sourceFilename)
+        {
+            if (sourceFilename == null)
+            {
+                throw new ArgumentNullException(nameof(sourceFilename));
+            }
+
+            if (sourceFilename.Contains("ddn") || sourceFilename.ToLower().Contains("normal"))
+            {
+                return BlockCompressionFormat.BC5;
+            }
+
+            return sourceFilename.Contains("bump") ? BlockCompressionFormat.BC4 : BlockCompressionFormat.BC3;
+        }
+
+        // Copies a 32-bit BGRA surface to tightly packed RGBA, normal maps are renormalized because
+        // filtered mip levels shorten the normals
+        public static unsafe byte[] ReadRgbaData(Surface surface, bool isNormalMap)
+        {
+            if (surface == null)
+            {
+                throw new ArgumentNullException(nameof(surface));
+            }
+
+            var result = new byte[surface.Width * surface.Height * 4];
+
+            for (var y = 0; y < surface.Height; y++)
+            {
+                var sourceRow = (byte*)surface.DataPtr.ToPointer() + y * surface.Pitch;
+
+                for (var x = 0; x < surface.Width; x++)
+                {
+                    var source = sourceRow + x * 4;
+                    var offset = (y * surface.Width + x) * 4;
+
+                    result[offset] = source[2];
+                    result[offset + 1] = source[1];
+                    result[offset + 2] = source[0];
+                    result[offset + 3] = source[3];
+
+                    if (isNormalMap)
+                    {
+                        var normal = new Vector3(source[2], source[1], source[0]) / 127.5f - Vector3.One;
+
+                        if (normal.LengthSquared() > 0.0f)
+                        {
+                            normal = Vector3.Normalize(normal);
+                        }
+
+                        result[offset] = (byte)MathF.Round(Math.Clamp(normal.X * 127.5f + 127.5f, 0.0f, 255.0f));
+                        result[offset + 1] = (byte)MathF.Round(Math.Clamp(normal.Y * 127.5f + 127.5f, 0.0f, 255.0f));
+                        result[offset + 2] = (byte)MathF.Round(Math.Clamp(normal.Z * 127.5f + 127.5f, 0.0f, 255.0f));
+                    }
+                }
+            }
+
+            return result;
+        }
+
+        private static long AlignOffset(long offset, int alignment)
+        {
+            return (offset + alignment - 1) / alignment * alignment;
+        }
+
+        private static void WritePadding(BinaryWriter writer, long offset)
+        {
+            writer.Flush();
+
+            while (writer.BaseStream.Position < offset)
+            {
+                writer.Write((byte)0);
+            }
+        }
+
         private static int PixelOffset(int x, int y, int width, int height, int pixelSize = 1)
         {
             if (x < 0)
@@ -312,7 +520,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                     }
                 }
 
-                Console.WriteLine($"On pass {i}/{N}");
+                Logger.WriteMessage(LogMessageTypes.Debug, "On pass {0}/{1}", i, N);
             }
 
             float lo = float.PositiveInfinity, hi = float.NegativeInfinity;
@@ -328,7 +536,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Graphics.Textures
                 }
             }
 
-            Console.WriteLine($"Hi: {hi} - Lo: {lo}");
+            Logger.WriteMessage(LogMessageTypes.Debug, "Hi: {0} - Lo: {1}", hi, lo);
 
             for (int x = 0; x < width; ++x) 
             {
@@ -0,0 +1,194 @@
+using System;
+using System.Buffers;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    // Growable output buffer rented from the resource buffer pool, the buffer is returned when the writer is disposed
+    public sealed class PooledBufferWriter : IBufferWriter<byte>, IMemoryOwner<byte>
+    {
+        private const int DefaultInitialCapacity = 64 * 1024;
+
+        private byte[] buffer;
+        private int writtenCount;
+
+        public PooledBufferWriter(int initialCapacity = DefaultInitialCapacity)
+        {
+            this.buffer = ResourceBufferPool.Shared.Rent(Math.Max(initialCapacity, 1));
+        }
+
+        public int WrittenCount
+        {
+            get
+            {
+                return this.writtenCount;
+            }
+        }
+
+        public ReadOnlyMemory<byte> WrittenMemory
+        {
+            get
+            {
+                return new ReadOnlyMemory<byte>(this.buffer, 0, this.writtenCount);
+            }
+        }
+
+        public Memory<byte> Memory
+        {
+            get
+            {
+                return new Memory<byte>(this.buffer, 0, this.writtenCount);
+            }
+        }
+
+        public void Advance(int count)
+        {
+            if (count < 0 || this.writtenCount + count > this.buffer.Length)
+            {
+                throw new ArgumentOutOfRangeException(nameof(count));
+            }
+
+            this.writtenCount += count;
+        }
+
+        public Memory<byte> GetMemory(int sizeHint = 0)
+        {
+            EnsureCapacity(sizeHint);
+            return new Memory<byte>(this.buffer, this.writtenCount, this.buffer.Length - this.writtenCount);
+        }
+
+        public Span<byte> GetSpan(int sizeHint = 0)
+        {
+            EnsureCapacity(sizeHint);
+            return new Span<byte>(this.buffer, this.writtenCount, this.buffer.Length - this.writtenCount);
+        }
+
+        // Write only stream over the writer for the compilers using a BinaryWriter, disposing it keeps the buffer
+        public Stream AsStream()
+        {
+            return new BufferWriterStream(this);
+        }
+
+        public void Dispose()
+        {
+            if (this.buffer.Length > 0)
+            {
+                ResourceBufferPool.Shared.Return(this.buffer);
+                this.buffer = Array.Empty<byte>();
+                this.writtenCount = 0;
+            }
+        }
+
+        private void EnsureCapacity(int sizeHint)
+        {
+            if (this.buffer.Length == 0)
+            {
+                throw new ObjectDisposedException(nameof(PooledBufferWriter));
+            }
+
+            sizeHint = Math.Max(sizeHint, 1);
+
+            if (this.buffer.Length - this.writtenCount >= sizeHint)
+            {
+                return;
+            }
+
+            var newBuffer = ResourceBufferPool.Shared.Rent(Math.Max(this.buffer.Length * 2, this.writtenCount + sizeHint));
+            Buffer.BlockCopy(this.buffer, 0, newBuffer, 0, this.writtenCount);
+
+            ResourceBufferPool.Shared.Return(this.buffer);
+            this.buffer = newBuffer;
+        }
+
+        private class BufferWriterStream : Stream
+        {
+            private readonly PooledBufferWriter writer;
+
+            public BufferWriterStream(PooledBufferWriter writer)
+            {
+                this.writer = writer;
+            }
+
+            public override bool CanRead
+            {
+                get
+                {
+                    return false;
+                }
+            }
+
+            public override bool CanSeek
+            {
+                get
+                {
+                    return false;
+                }
+            }
+
+            public override bool CanWrite
+            {
+                get
+                {
+                    return true;
+                }
+            }
+
+            public override long Length
+            {
+                get
+                {
+                    return this.writer.WrittenCount;
+                }
+            }
+
+            public override long Position
+            {
+                get
+                {
+                    return this.writer.WrittenCount;
+                }
+
+                set
+                {
+                    throw new NotSupportedException();
+                }
+            }
+
+            public override void Write(byte[] buffer, int offset, int count)
+            {
+                Write(new ReadOnlySpan<byte>(buffer, offset, count));
+            }
+
+            public override void Write(ReadOnlySpan<byte> buffer)
+            {
+                buffer.CopyTo(this.writer.GetSpan(buffer.Length));
+                this.writer.Advance(buffer.Length);
+            }
+
+            public override void WriteByte(byte value)
+            {
+                this.writer.GetSpan(1)[0] = value;
+                this.writer.Advance(1);
+            }
+
+            public override void Flush()
+            {
+            }
+
+            public override int Read(byte[] buffer, int offset, int count)
+            {
+                throw new NotSupportedException();
+            }
+
+            public override long Seek(long offset, SeekOrigin origin)
+            {
+                throw new NotSupportedException();
+            }
+
+            public override void SetLength(long value)
+            {
+                throw new NotSupportedException();
+            }
+        }
+    }
+}
@@ -0,0 +1,114 @@
+using System;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    // Read only stream over source data so readers expecting a stream don't need a copy of the data
+    public class ReadOnlyMemoryStream : Stream
+    {
+        private readonly ReadOnlyMemory<byte> data;
+        private int position;
+
+        public ReadOnlyMemoryStream(ReadOnlyMemory<byte> data)
+        {
+            this.data = data;
+        }
+
+        public override bool CanRead
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public override bool CanSeek
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public override bool CanWrite
+        {
+            get
+            {
+                return false;
+            }
+        }
+
+        public override long Length
+        {
+            get
+            {
+                return this.data.Length;
+            }
+        }
+
+        public override long Position
+        {
+            get
+            {
+                return this.position;
+            }
+
+            set
+            {
+                if (value < 0 || value > this.data.Length)
+                {
+                    throw new ArgumentOutOfRangeException(nameof(value));
+                }
+
+                this.position = (int)value;
+            }
+        }
+
+        public override int Read(byte[] buffer, int offset, int count)
+        {
+            return Read(new Span<byte>(buffer, offset, count));
+        }
+
+        public override int Read(Span<byte> buffer)
+        {
+            var readLength = Math.Min(buffer.Length, this.data.Length - this.position);
+
+            this.data.Span.Slice(this.position, readLength).CopyTo(buffer);
+            this.position += readLength;
+
+            return readLength;
+        }
+
+        public override int ReadByte()
+        {
+            if (this.position >= this.data.Length)
+            {
+                return -1;
+            }
+
+            return this.data.Span[this.position++];
+        }
+
+        public override long Seek(long offset, SeekOrigin origin)
+        {
+            var basePosition = (origin == SeekOrigin.Begin) ? 0 : (origin == SeekOrigin.Current) ? this.position : this.data.Length;
+            this.Position = basePosition + offset;
+
+            return this.position;
+        }
+
+        public override void Flush()
+        {
+        }
+
+        public override void SetLength(long value)
+        {
+            throw new NotSupportedException();
+        }
+
+        public override void Write(byte[] buffer, int offset, int count)
+        {
+            throw new NotSupportedException();
+        }
+    }
+}
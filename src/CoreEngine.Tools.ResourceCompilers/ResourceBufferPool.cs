@@ -0,0 +1,13 @@
+using System.Buffers;
+
+namespace CoreEngine.Tools.ResourceCompilers
+{
+    // The shared array pool doesn't keep arrays bigger than 1 MB, source files and compiled
+    // resources are often larger so they use their own pool
+    public static class ResourceBufferPool
+    {
+        private const int MaxArrayLength = 256 * 1024 * 1024;
+
+        public static ArrayPool<byte> Shared { get; } = ArrayPool<byte>.Create(MaxArrayLength, 16);
+    }
+}
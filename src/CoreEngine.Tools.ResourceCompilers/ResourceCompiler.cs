@@ -1,5 +1,6 @@
 using System;
 using System.Collections.Generic;
+using System.Globalization;
 using System.IO;
 using System.Reflection;
 using System.Threading.Tasks;
@@ -9,6 +10,8 @@ namespace CoreEngine.Tools.ResourceCompilers
 {
     public class ResourceCompiler
     {
+        private static readonly Lazy<string> compilerAssemblyHash = new Lazy<string>(() => XxHash64.HashFile(typeof(ResourceCompiler).Assembly.Location).ToString("x16", CultureInfo.InvariantCulture));
+
         private IDictionary<string, List<ResourceDataCompiler>> dataCompilers;
 
         public ResourceCompiler()
@@ -18,13 +21,80 @@ namespace CoreEngine.Tools.ResourceCompilers
             AddInternalDataCompilers();
         }
 
+        // The hash of the compiler assembly changes with any modification of the compilers code
+        internal static string CompilerAssemblyHash
+        {
+            get
+            {
+                return compilerAssemblyHash.Value;
+            }
+        }
+
         public IList<string> GetSupportedSourceFileExtensions()
         {
             return new List<string>(this.dataCompilers.Keys);
         }
 
+        public bool SupportsConcurrentCompilation(string inputPath)
+        {
+            var sourceFileExtension = Path.GetExtension(inputPath);
+
+            if (!this.dataCompilers.ContainsKey(sourceFileExtension))
+            {
+                return true;
+            }
+
+            foreach (var dataCompiler in this.dataCompilers[sourceFileExtension])
+            {
+                if (!dataCompiler.SupportsConcurrentCompilation)
+                {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        public long EstimateMemoryUsage(string inputPath, long sourceDataLength)
+        {
+            var sourceFileExtension = Path.GetExtension(inputPath);
+            var result = sourceDataLength;
+
+            if (this.dataCompilers.ContainsKey(sourceFileExtension))
+            {
+                foreach (var dataCompiler in this.dataCompilers[sourceFileExtension])
+                {
+                    result = Math.Max(result, dataCompiler.EstimateMemoryUsage(sourceDataLength));
+                }
+            }
+
+            return result;
+        }
+
+        public IList<string> ReadDependencies(string inputPath, ReadOnlyMemory<byte> sourceData)
+        {
+            var sourceFileExtension = Path.GetExtension(inputPath);
+            var result = new List<string>();
+
+            if (this.dataCompilers.ContainsKey(sourceFileExtension))
+            {
+                foreach (var dataCompiler in this.dataCompilers[sourceFileExtension])
+                {
+                    foreach (var dependency in dataCompiler.ReadDependencies(sourceData))
+                    {
+                        if (!result.Contains(dependency))
+                        {
+                            result.Add(dependency);
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }
+
         // TODO: Replace parameters by structs
-        public async ValueTask<Memory<string>> CompileFileAsync(string inputPath, CompilerContext context)
+        public async ValueTask<Memory<string>> CompileFileAsync(string inputPath, CompilerContext context, CompileCache? cache = null)
         {
             if (context == null)
             {
@@ -40,21 +110,81 @@ namespace CoreEngine.Tools.ResourceCompilers
 
             var dataCompilers = this.dataCompilers[sourceFileExtension];
 
+            byte[]? inputBuffer = null;
+            var outputResources = new List<ResourceEntry>();
+
+            using var fileSpan = BuildTracer.BeginSpan(context.SourceFilename, "File");
+            fileSpan.SetArgument("path", inputPath);
+
             try
             {
-                // TODO: Find a way to avoid copy data when using FileStream?
-                var inputData = new ReadOnlyMemory<byte>(await File.ReadAllBytesAsync(inputPath));
-                var outputResources = new List<ResourceEntry>();
+                // The source file is read in a pooled buffer and the compilers get a view on it, the buffer is only
+                // valid during the compilation so resources must not reference it
+                int inputLength;
+
+                using (var readSpan = BuildTracer.BeginSpan("ReadSource", "IO"))
+                using (var inputStream = new FileStream(inputPath, FileMode.Open, FileAccess.Read, FileShare.Read, 1, FileOptions.Asynchronous | FileOptions.SequentialScan))
+                {
+                    if (inputStream.Length > int.MaxValue)
+                    {
+                        throw new NotSupportedException($"Source file {inputPath} is larger than 2 GB");
+                    }
+
+                    inputBuffer = ResourceBufferPool.Shared.Rent((int)inputStream.Length);
+                    inputLength = 0;
+
+                    while (inputLength < inputStream.Length)
+                    {
+                        var readLength = await inputStream.ReadAsync(inputBuffer.AsMemory(inputLength, (int)inputStream.Length - inputLength));
+
+                        if (readLength == 0)
+                        {
+                            break;
+                        }
+
+                        inputLength += readLength;
+                    }
+                }
+
+                var inputData = new ReadOnlyMemory<byte>(inputBuffer, 0, inputLength);
+                string? cacheKey = null;
+
+                fileSpan.SetArgument("bytesIn", (long)inputLength);
+
+                if (cache != null)
+                {
+                    string[]? cachedResult;
+
+                    using (var cacheSpan = BuildTracer.BeginSpan("CacheLookup", "Cache"))
+                    {
+                        cacheKey = CompileCache.ComputeKey(GetCompilerIdentifiers(dataCompilers), inputData.Span, context);
+                        cachedResult = cache.TryRestore(cacheKey, context.OutputDirectory);
+                    }
+
+                    fileSpan.SetArgument("cacheHit", cachedResult != null);
+
+                    if (cachedResult != null)
+                    {
+                        Logger.WriteMessage("Restored from compile cache", LogMessageTypes.Debug);
+                        return cachedResult;
+                    }
+                }
 
                 foreach (var dataCompiler in dataCompilers)
                 {
+                    using var compilerSpan = BuildTracer.BeginSpan(dataCompiler.Name, "Compiler");
                     var output = await dataCompiler.CompileAsync(inputData, context);
-                    outputResources.AddRange(output.ToArray());
+
+                    for (var i = 0; i < output.Length; i++)
+                    {
+                        outputResources.Add(output.Span[i]);
+                    }
                 }
                 
                 if (outputResources.Count > 0)
                 {
                     var result = new string[outputResources.Count];
+                    var outputLength = 0L;
 
                     if (!Directory.Exists(context.OutputDirectory))
                     {
@@ -67,7 +197,26 @@ namespace CoreEngine.Tools.ResourceCompilers
                         var outputPath = Path.Combine(context.OutputDirectory, outputResource.Filename);
                         result[i] = outputPath;
 
-                        await File.WriteAllBytesAsync(outputPath, outputResource.Data.ToArray());
+                        // The previous output may be a hard link to a compile cache entry so it must not be overwritten in place
+                        if (File.Exists(outputPath))
+                        {
+                            File.Delete(outputPath);
+                        }
+
+                        // The data is written directly from the compiler buffer, the stream doesn't need its own buffer
+                        using var writeSpan = BuildTracer.BeginSpan("WriteResource", "IO");
+                        using var outputStream = new FileStream(outputPath, FileMode.CreateNew, FileAccess.Write, FileShare.None, 1, FileOptions.Asynchronous);
+                        await outputStream.WriteAsync(outputResource.Data);
+
+                        outputLength += outputResource.Data.Length;
+                    }
+
+                    fileSpan.SetArgument("bytesOut", outputLength);
+
+                    if (cache != null && cacheKey != null)
+                    {
+                        using var cacheSpan = BuildTracer.BeginSpan("CacheStore", "Cache");
+                        cache.Store(cacheKey, outputResources);
                     }
 
                     return result;
@@ -79,9 +228,32 @@ namespace CoreEngine.Tools.ResourceCompilers
                 Logger.WriteMessage($"Error: {e.ToString()}", LogMessageTypes.Error);
             }
 
+            finally
+            {
+                foreach (var outputResource in outputResources)
+                {
+                    outputResource.Dispose();
+                }
+
+                if (inputBuffer != null)
+                {
+                    ResourceBufferPool.Shared.Return(inputBuffer);
+                }
+            }
+
             return new Memory<string>();
         }
 
+        private static IEnumerable<string> GetCompilerIdentifiers(List<ResourceDataCompiler> dataCompilers)
+        {
+            yield return CompilerAssemblyHash;
+
+            foreach (var dataCompiler in dataCompilers)
+            {
+                yield return dataCompiler.GetType().FullName!;
+            }
+        }
+
         private void AddInternalDataCompilers()
         {
             var assembly = Assembly.GetExecutingAssembly();
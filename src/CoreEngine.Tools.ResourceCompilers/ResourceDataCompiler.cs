@@ -30,6 +30,24 @@ namespace CoreEngine.Tools.ResourceCompilers
             }
         }
 
+        public virtual bool SupportsConcurrentCompilation
+        {
+            get
+            {
+                return true;
+            }
+        }
+
+        public virtual long EstimateMemoryUsage(long sourceDataLength)
+        {
+            return sourceDataLength * 4;
+        }
+
+        public virtual IList<string> ReadDependencies(ReadOnlyMemory<byte> sourceData)
+        {
+            return Array.Empty<string>();
+        }
+
         public abstract Task<ReadOnlyMemory<ResourceEntry>> CompileAsync(ReadOnlyMemory<byte> sourceData, CompilerContext context);
     }
 }
@@ -1,16 +1,42 @@
 using System;
+using System.Buffers;
 
 namespace CoreEngine.Tools.ResourceCompilers
 {
-    public class ResourceEntry
+    public class ResourceEntry : IDisposable
     {
+        private IMemoryOwner<byte>? dataOwner;
+
         public ResourceEntry(string filename, ReadOnlyMemory<byte> data)
         {
             this.Filename = filename;
             this.Data = data;
         }
 
+        // The pooled buffer of the data is released once the resource has been written
+        public ResourceEntry(string filename, PooledBufferWriter dataWriter)
+        {
+            if (dataWriter == null)
+            {
+                throw new ArgumentNullException(nameof(dataWriter));
+            }
+
+            this.Filename = filename;
+            this.Data = dataWriter.WrittenMemory;
+            this.dataOwner = dataWriter;
+        }
+
         public string Filename { get; }
-        public ReadOnlyMemory<byte> Data { get; }
+        public ReadOnlyMemory<byte> Data { get; private set; }
+
+        public void Dispose()
+        {
+            if (this.dataOwner != null)
+            {
+                this.Data = ReadOnlyMemory<byte>.Empty;
+                this.dataOwner.Dispose();
+                this.dataOwner = null;
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,173 @@
+using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers.Scenes
+{
+    public enum ComponentFieldType
+    {
+        Bool,
+        Float,
+
+        // Index in the string table of the scene
+        String
+    }
+
+    public class ComponentField
+    {
+        public ComponentField(string name, ComponentFieldType fieldType, int elementCount)
+        {
+            this.Name = name;
+            this.FieldType = fieldType;
+            this.ElementCount = elementCount;
+        }
+
+        public string Name { get; }
+        public ComponentFieldType FieldType { get; }
+
+        // Float arrays are vectors and matrices, the other types have one element
+        public int ElementCount { get; }
+        public int Offset { get; set; }
+
+        public int Size
+        {
+            get
+            {
+                return (this.FieldType == ComponentFieldType.Bool) ? sizeof(bool) : this.ElementCount * sizeof(float);
+            }
+        }
+
+        public int Alignment
+        {
+            get
+            {
+                return (this.FieldType == ComponentFieldType.Bool) ? sizeof(bool) : sizeof(float);
+            }
+        }
+    }
+
+    // Layout of a component type, built from the values of all its instances in the scene. Fields are laid out
+    // sequentially with their natural alignment like the runtime component structs, values missing from an entity
+    // are zero.
+    public class ComponentSchema
+    {
+        private readonly Dictionary<string, ComponentField> fieldsByName = new Dictionary<string, ComponentField>(StringComparer.Ordinal);
+
+        public ComponentSchema(string componentType)
+        {
+            this.ComponentType = componentType;
+        }
+
+        public string ComponentType { get; }
+        public List<ComponentField> Fields { get; } = new List<ComponentField>();
+        public int Size { get; private set; }
+
+        public void AddValues(ComponentDescription component)
+        {
+            if (component == null)
+            {
+                throw new ArgumentNullException(nameof(component));
+            }
+
+            foreach (var componentValue in component.ComponentValues)
+            {
+                var (fieldType, elementCount) = GetFieldType(componentValue.Value);
+
+                if (this.fieldsByName.TryGetValue(componentValue.Key, out var field))
+                {
+                    if (field.FieldType != fieldType || field.ElementCount != elementCount)
+                    {
+                        throw new InvalidDataException($"{this.ComponentType}.{componentValue.Key} has values of different types.");
+                    }
+
+                    continue;
+                }
+
+                field = new ComponentField(componentValue.Key, fieldType, elementCount);
+                this.fieldsByName.Add(field.Name, field);
+                this.Fields.Add(field);
+            }
+        }
+
+        // Called once all the components of the scene have been added
+        public void ComputeLayout()
+        {
+            var offset = 0;
+            var structAlignment = 1;
+
+            foreach (var field in this.Fields)
+            {
+                offset = (offset + field.Alignment - 1) & ~(field.Alignment - 1);
+                field.Offset = offset;
+                offset += field.Size;
+                structAlignment = Math.Max(structAlignment, field.Alignment);
+            }
+
+            this.Size = (offset + structAlignment - 1) & ~(structAlignment - 1);
+        }
+
+        public void WriteComponent(ComponentDescription component, Span<byte> destination, StringTable stringTable)
+        {
+            if (component == null)
+            {
+                throw new ArgumentNullException(nameof(component));
+            }
+
+            if (stringTable == null)
+            {
+                throw new ArgumentNullException(nameof(stringTable));
+            }
+
+            foreach (var componentValue in component.ComponentValues)
+            {
+                var field = this.fieldsByName[componentValue.Key];
+                var fieldData = destination.Slice(field.Offset, field.Size);
+
+                switch (componentValue.Value)
+                {
+                    case bool boolValue:
+                        fieldData[0] = boolValue ? (byte)1 : (byte)0;
+                        break;
+
+                    case float floatValue:
+                        BinaryPrimitives.WriteInt32LittleEndian(fieldData, BitConverter.SingleToInt32Bits(floatValue));
+                        break;
+
+                    case float[] floatArray:
+                        for (var i = 0; i < floatArray.Length; i++)
+                        {
+                            BinaryPrimitives.WriteInt32LittleEndian(fieldData.Slice(i * sizeof(float)), BitConverter.SingleToInt32Bits(floatArray[i]));
+                        }
+
+                        break;
+
+                    case string stringValue:
+                        BinaryPrimitives.WriteInt32LittleEndian(fieldData, stringTable.GetIndex(stringValue));
+                        break;
+                }
+            }
+        }
+
+        private (ComponentFieldType, int) GetFieldType(object value)
+        {
+            switch (value)
+            {
+                case bool _:
+                    return (ComponentFieldType.Bool, 1);
+
+                case float _:
+                    return (ComponentFieldType.Float, 1);
+
+                case float[] floatArray when floatArray.Length > 0:
+                    return (ComponentFieldType.Float, floatArray.Length);
+
+                case string _:
+                    return (ComponentFieldType.String, 1);
+
+                default:
+                    throw new InvalidDataException($"{this.ComponentType} has a value of an unsupported type: {value}.");
+            }
+        }
+    }
+}
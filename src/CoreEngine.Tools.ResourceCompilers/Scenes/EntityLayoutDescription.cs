@@ -10,7 +10,6 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
             this.Types = new List<string>();
         }
 
-        public int HashCode { get; set; }
         public List<string> Types { get; set; }
     }
 }
\ No newline at end of file
@@ -1,11 +1,15 @@
 using System;
 using System.Collections.Generic;
 using System.Globalization;
+using System.IO;
 
 namespace CoreEngine.Tools.ResourceCompilers.Scenes
 {
     public class SceneDescription
     {
+        // Layouts are identified by their sorted component types
+        private readonly Dictionary<string, int> entityLayoutIndices = new Dictionary<string, int>(StringComparer.Ordinal);
+
         public List<EntityLayoutDescription> EntityLayouts { get; } = new List<EntityLayoutDescription>();
         public List<EntityDescription> Entities { get; } = new List<EntityDescription>();
 
@@ -16,36 +20,26 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
                 throw new ArgumentNullException(nameof(entityLayout));
             }
 
-            var index = -1;
-
-            var result = 0;
-            var sortedList = new SortedList<int, string>();
+            entityLayout.Types.Sort(StringComparer.Ordinal);
 
-            for (var i = 0; i < entityLayout.Types.Count; i++)
+            for (var i = 1; i < entityLayout.Types.Count; i++)
             {
-                var typeHashCode = entityLayout.Types[i].GetHashCode();
-                sortedList.Add(typeHashCode, entityLayout.Types[i]);
-                result |= typeHashCode;
-            }
-
-            entityLayout.Types = new List<string>(sortedList.Values);
-
-            for (var i = 0; i < this.EntityLayouts.Count; i++)
-            {
-                if (this.EntityLayouts[i].HashCode == result)
+                if (entityLayout.Types[i] == entityLayout.Types[i - 1])
                 {
-                    index = i;
+                    throw new InvalidDataException($"Component {entityLayout.Types[i]} is used more than once by an entity.");
                 }
             }
 
-            if (index == -1)
+            var key = string.Join("\n", entityLayout.Types);
+
+            if (!this.entityLayoutIndices.TryGetValue(key, out var index))
             {
                 index = this.EntityLayouts.Count;
-                entityLayout.HashCode = result;
+                this.entityLayoutIndices.Add(key, index);
                 this.EntityLayouts.Add(entityLayout);
             }
 
             return index;
         }
     }
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 using System;
+using System.Buffers.Binary;
 using System.Collections.Generic;
 using System.Globalization;
 using System.IO;
@@ -13,8 +14,31 @@ using YamlDotNet.Serialization.NamingConventions;
 
 namespace CoreEngine.Tools.ResourceCompilers.Scenes
 {
+    // Entities are stored in chunks of entities that have the same layout. In a chunk, the entity name indices and the
+    // components of each type are contiguous arrays in their runtime layout so that the chunks are loaded by copies.
     public class SceneResourceDataCompiler : ResourceDataCompiler
     {
+        private readonly struct SceneChunk
+        {
+            public SceneChunk(int layoutIndex, int firstEntity, int entityCount, int dataOffset)
+            {
+                this.LayoutIndex = layoutIndex;
+                this.FirstEntity = firstEntity;
+                this.EntityCount = entityCount;
+                this.DataOffset = dataOffset;
+            }
+
+            public int LayoutIndex { get; }
+
+            // Index of the first entity of the chunk in the entities of its layout
+            public int FirstEntity { get; }
+            public int EntityCount { get; }
+            public int DataOffset { get; }
+        }
+
+        private const int ChunkSize = 16 * 1024;
+        private const int ChunkDataAlignment = 16;
+
         public SceneResourceDataCompiler()
         {
 
@@ -51,19 +75,102 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
                 throw new ArgumentNullException(nameof(context));
             }
 
-            var version = 1;
+            var version = 2;
 
             var sceneDescription = ParseYamlFile(sourceData);
             Logger.WriteMessage($"Scene Entity Count: {sceneDescription.Entities.Count}", LogMessageTypes.Debug);
 
-            var destinationMemoryStream = new MemoryStream();
+            var stringTable = new StringTable();
+            var componentSchemas = BuildComponentSchemas(sceneDescription, out var componentSchemaIndices);
+
+            Logger.BeginAction("Writing Scene data");
+
+            // Entities are grouped by layout in source order, each group is split in chunks of ChunkSize bytes
+            var layoutEntities = new List<EntityDescription>[sceneDescription.EntityLayouts.Count];
+
+            for (var i = 0; i < layoutEntities.Length; i++)
+            {
+                layoutEntities[i] = new List<EntityDescription>();
+            }
+
+            foreach (var entity in sceneDescription.Entities)
+            {
+                layoutEntities[entity.EntityLayoutIndex].Add(entity);
+            }
+
+            var chunks = new List<SceneChunk>();
+            var dataSize = 0;
+
+            for (var i = 0; i < layoutEntities.Length; i++)
+            {
+                var entitySize = sizeof(int);
+
+                foreach (var componentType in sceneDescription.EntityLayouts[i].Types)
+                {
+                    entitySize += componentSchemas[componentSchemaIndices[componentType]].Size;
+                }
+
+                var chunkCapacity = Math.Max(1, ChunkSize / entitySize);
 
-            using var streamWriter = new BinaryWriter(destinationMemoryStream);
+                for (var j = 0; j < layoutEntities[i].Count; j += chunkCapacity)
+                {
+                    var chunk = new SceneChunk(i, j, Math.Min(chunkCapacity, layoutEntities[i].Count - j), dataSize);
+                    dataSize += GetChunkSize(chunk, sceneDescription.EntityLayouts[i], componentSchemas, componentSchemaIndices);
+                    chunks.Add(chunk);
+                }
+            }
+
+            var chunkData = new byte[dataSize];
+
+            foreach (var chunk in chunks)
+            {
+                WriteChunk(chunk, layoutEntities[chunk.LayoutIndex], sceneDescription.EntityLayouts[chunk.LayoutIndex], componentSchemas, componentSchemaIndices, stringTable, chunkData);
+            }
+
+            Logger.EndAction();
+
+            var destinationBuffer = new PooledBufferWriter(dataSize + 4096);
+
+            using var streamWriter = new BinaryWriter(destinationBuffer.AsStream());
             streamWriter.Write(new char[] { 'S', 'C', 'E', 'N', 'E'});
             streamWriter.Write(version);
 
+            // The names of the schema are interned before the table is written, the chunk strings already are
+            var schemaNameIndices = new int[componentSchemas.Count][];
+
+            for (var i = 0; i < componentSchemas.Count; i++)
+            {
+                schemaNameIndices[i] = new int[componentSchemas[i].Fields.Count + 1];
+                schemaNameIndices[i][0] = stringTable.GetIndex(componentSchemas[i].ComponentType);
+
+                for (var j = 0; j < componentSchemas[i].Fields.Count; j++)
+                {
+                    schemaNameIndices[i][j + 1] = stringTable.GetIndex(componentSchemas[i].Fields[j].Name);
+                }
+            }
+
+            stringTable.Write(streamWriter);
+
+            streamWriter.Write(componentSchemas.Count);
+
+            for (var i = 0; i < componentSchemas.Count; i++)
+            {
+                var componentSchema = componentSchemas[i];
+
+                streamWriter.Write(schemaNameIndices[i][0]);
+                streamWriter.Write(componentSchema.Size);
+                streamWriter.Write(componentSchema.Fields.Count);
+
+                for (var j = 0; j < componentSchema.Fields.Count; j++)
+                {
+                    streamWriter.Write(schemaNameIndices[i][j + 1]);
+                    streamWriter.Write((int)componentSchema.Fields[j].FieldType);
+                    streamWriter.Write(componentSchema.Fields[j].ElementCount);
+                    streamWriter.Write(componentSchema.Fields[j].Offset);
+                }
+            }
+
             streamWriter.Write(sceneDescription.EntityLayouts.Count);
-            streamWriter.Write(sceneDescription.Entities.Count);
 
             foreach (var entityLayout in sceneDescription.EntityLayouts)
             {
@@ -71,73 +178,111 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
 
                 foreach (var type in entityLayout.Types)
                 {
-                    streamWriter.Write(type);
+                    streamWriter.Write(componentSchemaIndices[type]);
                 }
             }
 
-            Logger.BeginAction("Writing Scene data");
-            
-            foreach (var entity in sceneDescription.Entities)
+            streamWriter.Write(sceneDescription.Entities.Count);
+            streamWriter.Write(chunks.Count);
+
+            foreach (var chunk in chunks)
             {
-                streamWriter.Write(entity.Name);
-                streamWriter.Write(entity.EntityLayoutIndex);
-                streamWriter.Write(entity.Components.Count);
+                streamWriter.Write(chunk.LayoutIndex);
+                streamWriter.Write(chunk.EntityCount);
+                streamWriter.Write(chunk.DataOffset);
+            }
+
+            // The chunk data offsets are relative to the 16 bytes aligned start of the data
+            streamWriter.Write(dataSize);
+            streamWriter.Flush();
+
+            streamWriter.Write(new byte[AlignChunkData(destinationBuffer.WrittenCount) - destinationBuffer.WrittenCount]);
+            streamWriter.Write(chunkData);
+            streamWriter.Flush();
 
+            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", destinationBuffer);
+
+            return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry }));
+        }
+
+        // Schemas are ordered by the first use of their component type
+        private static List<ComponentSchema> BuildComponentSchemas(SceneDescription sceneDescription, out Dictionary<string, int> componentSchemaIndices)
+        {
+            var result = new List<ComponentSchema>();
+            componentSchemaIndices = new Dictionary<string, int>(StringComparer.Ordinal);
+
+            foreach (var entity in sceneDescription.Entities)
+            {
                 foreach (var component in entity.Components)
                 {
-                    streamWriter.Write(component.ComponentType);
-                    streamWriter.Write(component.ComponentValues.Count);
-
-                    foreach (var componentValue in component.ComponentValues)
+                    if (!componentSchemaIndices.TryGetValue(component.ComponentType, out var index))
                     {
-                        streamWriter.Write(componentValue.Key);
-                        streamWriter.Write(componentValue.Value.GetType().ToString());
+                        index = result.Count;
+                        componentSchemaIndices.Add(component.ComponentType, index);
+                        result.Add(new ComponentSchema(component.ComponentType));
+                    }
 
-                        if (componentValue.Value.GetType() == typeof(string))
-                        {
-                            streamWriter.Write((string)componentValue.Value);
-                        }
+                    result[index].AddValues(component);
+                }
+            }
 
-                        else if (componentValue.Value.GetType() == typeof(bool))
-                        {
-                            streamWriter.Write((bool)componentValue.Value);
-                        }
+            foreach (var componentSchema in result)
+            {
+                componentSchema.ComputeLayout();
+            }
 
-                        else if (componentValue.Value.GetType() == typeof(float))
-                        {
-                            streamWriter.Write((float)componentValue.Value);
-                        }
+            return result;
+        }
 
-                        else if (componentValue.Value.GetType() == typeof(float[]))
-                        {
-                            var floatArray = (float[])componentValue.Value;
+        private static int AlignChunkData(int offset)
+        {
+            return (offset + ChunkDataAlignment - 1) & ~(ChunkDataAlignment - 1);
+        }
 
-                            streamWriter.Write(floatArray.Length);
+        private static int GetChunkSize(SceneChunk chunk, EntityLayoutDescription entityLayout, List<ComponentSchema> componentSchemas, Dictionary<string, int> componentSchemaIndices)
+        {
+            var result = AlignChunkData(chunk.EntityCount * sizeof(int));
 
-                            foreach (var floatValue in floatArray)
-                            {
-                                streamWriter.Write(floatValue);
-                            }
-                        }
-                    }
-                }
+            foreach (var componentType in entityLayout.Types)
+            {
+                result += AlignChunkData(chunk.EntityCount * componentSchemas[componentSchemaIndices[componentType]].Size);
             }
 
-            Logger.EndAction();
+            return result;
+        }
 
-            streamWriter.Flush();
-            destinationMemoryStream.Flush();
+        private static void WriteChunk(SceneChunk chunk, List<EntityDescription> entities, EntityLayoutDescription entityLayout, List<ComponentSchema> componentSchemas, Dictionary<string, int> componentSchemaIndices, StringTable stringTable, byte[] chunkData)
+        {
+            var offset = chunk.DataOffset;
 
-            var resourceData = new Memory<byte>(destinationMemoryStream.GetBuffer(), 0, (int)destinationMemoryStream.Length);
-            var resourceEntry = new ResourceEntry($"{Path.GetFileNameWithoutExtension(context.SourceFilename)}{this.DestinationExtension}", resourceData);
+            for (var i = 0; i < chunk.EntityCount; i++)
+            {
+                BinaryPrimitives.WriteInt32LittleEndian(chunkData.AsSpan(offset + i * sizeof(int)), stringTable.GetIndex(entities[chunk.FirstEntity + i].Name));
+            }
 
-            return Task.FromResult(new ReadOnlyMemory<ResourceEntry>(new ResourceEntry[] { resourceEntry }));
+            offset += AlignChunkData(chunk.EntityCount * sizeof(int));
+
+            // The layout types are sorted so the components of an entity are found by type
+            foreach (var componentType in entityLayout.Types)
+            {
+                var componentSchema = componentSchemas[componentSchemaIndices[componentType]];
+
+                for (var i = 0; i < chunk.EntityCount; i++)
+                {
+                    var entity = entities[chunk.FirstEntity + i];
+                    var component = entity.Components.Find(x => x.ComponentType == componentType);
+
+                    componentSchema.WriteComponent(component, chunkData.AsSpan(offset + i * componentSchema.Size, componentSchema.Size), stringTable);
+                }
+
+                offset += AlignChunkData(chunk.EntityCount * componentSchema.Size);
+            }
         }
 
         private SceneDescription ParseYamlFile(ReadOnlyMemory<byte> sourceData)
         {
             var sceneDescription = new SceneDescription();
-            using var reader = new StreamReader(new MemoryStream(sourceData.ToArray()));
+            using var reader = new StreamReader(new ReadOnlyMemoryStream(sourceData));
             var yaml = new YamlStream();
             yaml.Load(reader);
 
@@ -160,7 +305,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
             {
                 var entityName = ((YamlScalarNode)node.Children.First(x => ((YamlScalarNode)x.Key).Value == "Entity").Value).Value;
 
-                Logger.BeginAction($"Reading Entity: {entityName}");
+                Logger.WriteMessage(LogMessageTypes.Debug, "Reading Entity: {0}", entityName);
 
                 var entityDescription = new EntityDescription(entityName);
                 sceneDescription.Entities.Add(entityDescription);
@@ -181,8 +326,6 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
                     }
                 }
 
-                Logger.EndAction();
-
                 entityDescription.EntityLayoutIndex = sceneDescription.AddEntityLayoutDescription(entityLayoutDescription);
             }
         }
@@ -194,7 +337,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
             foreach (var node in componentsData)
             {
                 var nodeKey = ((YamlScalarNode)node.Key).Value;
-                Logger.WriteMessage($"{node.Key} - {node.Value} ({node.Value.NodeType})", LogMessageTypes.Debug);
+                Logger.WriteMessage(LogMessageTypes.Debug, "{0} - {1} ({2})", node.Key, node.Value, node.Value.NodeType);
 
                 if (nodeKey == "Component")
                 {
@@ -207,7 +350,7 @@ namespace CoreEngine.Tools.ResourceCompilers.Scenes
                     {
                         var scalarNode = (YamlScalarNode)node.Value;
 
-                        Logger.WriteMessage($"Scalar node style: {scalarNode.Style}");
+                        Logger.WriteMessage(LogMessageTypes.Debug, "Scalar node style: {0}", scalarNode.Style);
 
                         if (scalarNode.Style == ScalarStyle.Plain)
                         {
@@ -0,0 +1,53 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+
+namespace CoreEngine.Tools.ResourceCompilers.Scenes
+{
+    // Strings of a scene (names, types and string values) are written once and referenced by their index
+    public class StringTable
+    {
+        private readonly Dictionary<string, int> indices = new Dictionary<string, int>(StringComparer.Ordinal);
+        private readonly List<string> strings = new List<string>();
+
+        public int Count
+        {
+            get
+            {
+                return this.strings.Count;
+            }
+        }
+
+        public int GetIndex(string value)
+        {
+            if (value == null)
+            {
+                throw new ArgumentNullException(nameof(value));
+            }
+
+            if (!this.indices.TryGetValue(value, out var index))
+            {
+                index = this.strings.Count;
+                this.indices.Add(value, index);
+                this.strings.Add(value);
+            }
+
+            return index;
+        }
+
+        public void Write(BinaryWriter writer)
+        {
+            if (writer == null)
+            {
+                throw new ArgumentNullException(nameof(writer));
+            }
+
+            writer.Write(this.strings.Count);
+
+            foreach (var value in this.strings)
+            {
+                writer.Write(value);
+            }
+        }
+    }
+}
@@ -0,0 +1,172 @@
+using System;
+using System.Collections.Generic;
+using System.Threading;
+using System.Threading.Tasks;
+
+namespace CoreEngine.Compiler
+{
+    public class BuildScheduler
+    {
+        private class BuildJob
+        {
+            public BuildJob(Func<Task> action, long estimatedMemory, int[] dependencies)
+            {
+                this.Action = action;
+                this.EstimatedMemory = estimatedMemory;
+                this.Dependencies = dependencies;
+            }
+
+            public Func<Task> Action { get; }
+            public long EstimatedMemory { get; }
+            public int[] Dependencies { get; }
+        }
+
+        private readonly List<BuildJob> jobs;
+        private readonly SemaphoreSlim parallelismSemaphore;
+        private readonly MemoryBudget memoryBudget;
+
+        public BuildScheduler(int maxDegreeOfParallelism, long memoryBudget)
+        {
+            if (maxDegreeOfParallelism < 1)
+            {
+                throw new ArgumentOutOfRangeException(nameof(maxDegreeOfParallelism));
+            }
+
+            this.jobs = new List<BuildJob>();
+            this.parallelismSemaphore = new SemaphoreSlim(maxDegreeOfParallelism, maxDegreeOfParallelism);
+            this.memoryBudget = new MemoryBudget(memoryBudget);
+        }
+
+        public int JobCount
+        {
+            get
+            {
+                return this.jobs.Count;
+            }
+        }
+
+        public int AddJob(Func<Task> action, long estimatedMemory, params int[] dependencies)
+        {
+            if (action == null)
+            {
+                throw new ArgumentNullException(nameof(action));
+            }
+
+            foreach (var dependency in dependencies)
+            {
+                if (dependency < 0 || dependency >= this.jobs.Count)
+                {
+                    throw new ArgumentOutOfRangeException(nameof(dependencies), "A job can only depend on previously added jobs.");
+                }
+            }
+
+            this.jobs.Add(new BuildJob(action, estimatedMemory, dependencies));
+            return this.jobs.Count - 1;
+        }
+
+        public Task RunAsync()
+        {
+            var jobTasks = new Task[this.jobs.Count];
+
+            // Jobs are only allowed to depend on previous jobs so the graph is always acyclic
+            for (var i = 0; i < this.jobs.Count; i++)
+            {
+                var job = this.jobs[i];
+                var dependencyTasks = new Task[job.Dependencies.Length];
+
+                for (var j = 0; j < job.Dependencies.Length; j++)
+                {
+                    dependencyTasks[j] = jobTasks[job.Dependencies[j]];
+                }
+
+                jobTasks[i] = RunJobAsync(job, dependencyTasks);
+            }
+
+            this.jobs.Clear();
+            return Task.WhenAll(jobTasks);
+        }
+
+        private async Task RunJobAsync(BuildJob job, Task[] dependencyTasks)
+        {
+            if (dependencyTasks.Length > 0)
+            {
+                await Task.WhenAll(dependencyTasks);
+            }
+
+            await this.parallelismSemaphore.WaitAsync();
+
+            try
+            {
+                var reservedMemory = await this.memoryBudget.ReserveAsync(job.EstimatedMemory);
+
+                try
+                {
+                    // Jobs are queued on the thread pool which uses per-thread work-stealing queues
+                    await Task.Run(job.Action);
+                }
+
+                finally
+                {
+                    this.memoryBudget.Release(reservedMemory);
+                }
+            }
+
+            finally
+            {
+                this.parallelismSemaphore.Release();
+            }
+        }
+
+        private class MemoryBudget
+        {
+            private readonly long totalMemory;
+            private readonly Queue<(long Memory, TaskCompletionSource<bool> Completion)> waitingReservations;
+            private long availableMemory;
+
+            public MemoryBudget(long totalMemory)
+            {
+                this.totalMemory = Math.Max(totalMemory, 1);
+                this.availableMemory = this.totalMemory;
+                this.waitingReservations = new Queue<(long, TaskCompletionSource<bool>)>();
+            }
+
+            public async Task<long> ReserveAsync(long memory)
+            {
+                // A job bigger than the whole budget is allowed to run but only on its own
+                memory = Math.Clamp(memory, 0, this.totalMemory);
+                TaskCompletionSource<bool> completion;
+
+                lock (this.waitingReservations)
+                {
+                    if (this.waitingReservations.Count == 0 && memory <= this.availableMemory)
+                    {
+                        this.availableMemory -= memory;
+                        return memory;
+                    }
+
+                    completion = new TaskCompletionSource<bool>(TaskCreationOptions.RunContinuationsAsynchronously);
+                    this.waitingReservations.Enqueue((memory, completion));
+                }
+
+                await completion.Task;
+                return memory;
+            }
+
+            public void Release(long memory)
+            {
+                lock (this.waitingReservations)
+                {
+                    this.availableMemory += memory;
+
+                    // Reservations are granted in FIFO order so that big jobs cannot starve
+                    while (this.waitingReservations.Count > 0 && this.waitingReservations.Peek().Memory <= this.availableMemory)
+                    {
+                        var reservation = this.waitingReservations.Dequeue();
+                        this.availableMemory -= reservation.Memory;
+                        reservation.Completion.SetResult(true);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -1,59 +1,100 @@
 using System;
 using System.Collections.Generic;
 using System.IO;
-using System.Security.Cryptography;
-using System.Threading.Tasks;
+using CoreEngine.Tools.Common;
 
 namespace CoreEngine.Compiler
 {
     public class FileTracker
     {
-        private Dictionary<string, long> fileTracker;
-        private Dictionary<string, string[]> destinationFiles;
+        private class FileEntry
+        {
+            public long LastWriteTime { get; set; }
+            public long Length { get; set; }
+            public ulong ContentHash { get; set; }
+            public string[] Dependencies { get; set; } = Array.Empty<string>();
+            public string[] DestinationFiles { get; set; } = Array.Empty<string>();
+        }
+
+        private const int FileVersion = 2;
+        private static readonly byte[] fileSignature = new byte[] { (byte)'F', (byte)'T', (byte)'R', (byte)'K' };
+
+        private Dictionary<string, FileEntry> fileEntries;
 
         public FileTracker()
         {
-            this.fileTracker = new Dictionary<string, long>();
-            this.destinationFiles = new Dictionary<string, string[]>();
+            this.fileEntries = new Dictionary<string, FileEntry>();
         }
 
         public bool HasFileChanged(string path)
         {
-            var lastWriteTime = File.GetLastWriteTime(path).ToBinary();
+            var fileInfo = new FileInfo(path);
 
-            if (this.fileTracker.ContainsKey(path) && lastWriteTime <= (this.fileTracker[path]))
+            if (!fileInfo.Exists)
             {
-                return false;
+                return true;
             }
 
-            if (!this.fileTracker.ContainsKey(path))
+            var lastWriteTime = fileInfo.LastWriteTimeUtc.ToBinary();
+            var length = fileInfo.Length;
+
+            if (!this.fileEntries.TryGetValue(path, out var fileEntry))
             {
-                this.fileTracker.Add(path, lastWriteTime);
+                fileEntry = new FileEntry();
+                fileEntry.LastWriteTime = lastWriteTime;
+                fileEntry.Length = length;
+                fileEntry.ContentHash = XxHash64.HashFile(path);
+
+                this.fileEntries.Add(path, fileEntry);
+                return true;
             }
 
-            else
+            // Only hash the content when the file metadata has changed
+            if (fileEntry.LastWriteTime == lastWriteTime && fileEntry.Length == length)
             {
-                this.fileTracker[path] = lastWriteTime;
+                return false;
             }
 
-            return true;
+            var contentHash = XxHash64.HashFile(path);
+            var hasContentChanged = (contentHash != fileEntry.ContentHash);
+
+            fileEntry.LastWriteTime = lastWriteTime;
+            fileEntry.Length = length;
+            fileEntry.ContentHash = contentHash;
+
+            return hasContentChanged;
+        }
+
+        public void RemoveFile(string path)
+        {
+            this.fileEntries.Remove(path);
         }
 
         public void AddDestinationFiles(string path, string[] destinationFiles)
         {
-            if (this.destinationFiles.ContainsKey(path))
+            GetOrCreateFileEntry(path).DestinationFiles = destinationFiles;
+        }
+
+        public string[] GetDestinationFiles(string path)
+        {
+            if (this.fileEntries.TryGetValue(path, out var fileEntry))
             {
-                this.destinationFiles.Remove(path);
+                return fileEntry.DestinationFiles;
             }
 
-            this.destinationFiles.Add(path, destinationFiles);
+            return Array.Empty<string>();
         }
 
-        public string[] GetDestinationFiles(string path)
+        public void SetDependencies(string path, string[] dependencies)
         {
-            if (this.destinationFiles.ContainsKey(path))
+            GetOrCreateFileEntry(path).Dependencies = dependencies;
+        }
+
+        public string[] GetDependencies(string path)
+        {
+            if (this.fileEntries.TryGetValue(path, out var fileEntry))
             {
-                return this.destinationFiles[path];
+                return fileEntry.Dependencies;
             }
 
             return Array.Empty<string>();
@@ -61,69 +102,146 @@ namespace CoreEngine.Compiler
 
         public void ReadFile(string path)
         {
-            if (File.Exists(path))
+            if (!File.Exists(path))
             {
-                this.fileTracker.Clear();
+                return;
+            }
 
-                using var stream = new FileStream(path, FileMode.Open);
-                using var reader = new BinaryReader(stream);
+            this.fileEntries.Clear();
 
-                var count = reader.ReadInt32();
+            using var stream = new MemoryStream(File.ReadAllBytes(path));
+            using var reader = new BinaryReader(stream);
 
-                for (var i = 0; i < count; i++)
-                {
-                    var key = reader.ReadString();
-                    var value = reader.ReadInt64();
+            // Trackers written by an older version are discarded which triggers a full rebuild
+            if (stream.Length < fileSignature.Length + sizeof(int) || !reader.ReadBytes(fileSignature.Length).AsSpan().SequenceEqual(fileSignature) || reader.ReadInt32() != FileVersion)
+            {
+                Logger.WriteMessage("File tracker format has changed, all files will be recompiled.", LogMessageTypes.Warning);
+                return;
+            }
 
-                    this.fileTracker.Add(key, value);
-                }
+            var stringCount = reader.ReadInt32();
+            var strings = new string[stringCount];
 
-                count = reader.ReadInt32();
+            for (var i = 0; i < stringCount; i++)
+            {
+                strings[i] = reader.ReadString();
+            }
 
-                for (var i = 0; i < count; i++)
-                {
-                    var key = reader.ReadString();
+            var entryCount = reader.ReadInt32();
+            this.fileEntries = new Dictionary<string, FileEntry>(entryCount);
 
-                    var valueCount = reader.ReadInt32();
-                    var values = new string[valueCount];
+            for (var i = 0; i < entryCount; i++)
+            {
+                var key = strings[reader.ReadInt32()];
+                var fileEntry = new FileEntry();
 
-                    for (var j = 0; j < valueCount; j++)
-                    {
-                        values[j] = reader.ReadString();
-                    }
+                fileEntry.LastWriteTime = reader.ReadInt64();
+                fileEntry.Length = reader.ReadInt64();
+                fileEntry.ContentHash = reader.ReadUInt64();
+                fileEntry.Dependencies = ReadStringReferences(reader, strings);
+                fileEntry.DestinationFiles = ReadStringReferences(reader, strings);
 
-                    this.destinationFiles.Add(key, values);
-                }
+                this.fileEntries.Add(key, fileEntry);
             }
         }
 
         public void WriteFile(string path)
         {
+            // Paths are stored once in a string table because dependencies and destination files
+            // are shared by a lot of entries
+            var stringTable = new Dictionary<string, int>();
+            var strings = new List<string>();
+
+            foreach (var item in this.fileEntries)
+            {
+                AddString(stringTable, strings, item.Key);
+
+                foreach (var dependency in item.Value.Dependencies)
+                {
+                    AddString(stringTable, strings, dependency);
+                }
+
+                foreach (var destinationFile in item.Value.DestinationFiles)
+                {
+                    AddString(stringTable, strings, destinationFile);
+                }
+            }
+
             using var stream = new FileStream(path, FileMode.Create);
             using var writer = new BinaryWriter(stream);
-            
-            writer.Write(this.fileTracker.Count);
 
-            foreach (var item in this.fileTracker)
+            writer.Write(fileSignature);
+            writer.Write(FileVersion);
+            writer.Write(strings.Count);
+
+            foreach (var value in strings)
             {
-                writer.Write(item.Key);
-                writer.Write(item.Value);
+                writer.Write(value);
             }
 
-            writer.Write(this.destinationFiles.Count);
+            writer.Write(this.fileEntries.Count);
 
-            foreach (var item in this.destinationFiles)
+            foreach (var item in this.fileEntries)
             {
-                writer.Write(item.Key);
+                writer.Write(stringTable[item.Key]);
+                writer.Write(item.Value.LastWriteTime);
                 writer.Write(item.Value.Length);
+                writer.Write(item.Value.ContentHash);
 
-                foreach (var value in item.Value)
-                {
-                    writer.Write(value);
-                }
+                WriteStringReferences(writer, stringTable, item.Value.Dependencies);
+                WriteStringReferences(writer, stringTable, item.Value.DestinationFiles);
             }
 
             writer.Flush();
         }
+
+        private FileEntry GetOrCreateFileEntry(string path)
+        {
+            if (!this.fileEntries.TryGetValue(path, out var fileEntry))
+            {
+                fileEntry = new FileEntry();
+                this.fileEntries.Add(path, fileEntry);
+            }
+
+            return fileEntry;
+        }
+
+        private static void AddString(Dictionary<string, int> stringTable, List<string> strings, string value)
+        {
+            if (!stringTable.ContainsKey(value))
+            {
+                stringTable.Add(value, strings.Count);
+                strings.Add(value);
+            }
+        }
+
+        private static string[] ReadStringReferences(BinaryReader reader, string[] strings)
+        {
+            var count = reader.ReadInt32();
+
+            if (count == 0)
+            {
+                return Array.Empty<string>();
+            }
+
+            var values = new string[count];
+
+            for (var i = 0; i < count; i++)
+            {
+                values[i] = strings[reader.ReadInt32()];
+            }
+
+            return values;
+        }
+
+        private static void WriteStringReferences(BinaryWriter writer, Dictionary<string, int> stringTable, string[] values)
+        {
+            writer.Write(values.Length);
+
+            foreach (var value in values)
+            {
+                writer.Write(stringTable[value]);
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -1,4 +1,6 @@
 ﻿using System;
+using System.Globalization;
+using System.IO;
 using System.Threading;
 using System.Threading.Tasks;
 using CoreEngine.Tools.Common;
@@ -8,9 +10,9 @@ namespace CoreEngine.Compiler
 {
     class Program
     {
-        private static async Task RunCompilePass(ResourceCompiler resourceCompiler, string input, string? searchPattern, bool isWatchMode, bool rebuildAll)
+        private static async Task RunCompilePass(ResourceCompiler resourceCompiler, string input, ProjectCompilerOptions options)
         {
-            if (!isWatchMode)
+            if (!options.IsWatchMode)
             {
                 Logger.WriteMessage($"Compiling '{input}'...", LogMessageTypes.Important);
             }
@@ -18,7 +20,7 @@ namespace CoreEngine.Compiler
             try
             {
                 var projectCompiler = new ProjectCompiler(resourceCompiler);
-                await projectCompiler.CompileProject(input, searchPattern, isWatchMode, rebuildAll);
+                await projectCompiler.CompileProject(input, options);
             }
 
             catch (Exception e)
@@ -27,9 +29,132 @@ namespace CoreEngine.Compiler
             }
         }
 
+        private static ProjectCompilerOptions? ParseOptions(string[] args)
+        {
+            var options = new ProjectCompilerOptions();
+
+            for (var i = 1; i < args.Length; i++)
+            {
+                var argument = args[i];
+
+                if (argument == "--watch")
+                {
+                    options.IsWatchMode = true;
+                }
+
+                else if (argument == "--verbose")
+                {
+                    Logger.EnabledMessageTypes = LogMessageTypes.All;
+                }
+
+                else if (argument == "--rebuild")
+                {
+                    options.RebuildAll = true;
+                }
+
+                else if (argument == "-j")
+                {
+                    if (i + 1 >= args.Length || !int.TryParse(args[++i], NumberStyles.Integer, CultureInfo.InvariantCulture, out var maxDegreeOfParallelism) || maxDegreeOfParallelism < 1)
+                    {
+                        Logger.WriteMessage("The -j parameter expects a positive number of jobs.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.MaxDegreeOfParallelism = maxDegreeOfParallelism;
+                }
+
+                else if (argument == "--memory-budget")
+                {
+                    if (i + 1 >= args.Length || !long.TryParse(args[++i], NumberStyles.Integer, CultureInfo.InvariantCulture, out var memoryBudget) || memoryBudget < 1)
+                    {
+                        Logger.WriteMessage("The --memory-budget parameter expects a positive size in MB.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.MemoryBudget = memoryBudget * 1024 * 1024;
+                }
+
+                else if (argument == "--cache")
+                {
+                    if (i + 1 >= args.Length)
+                    {
+                        Logger.WriteMessage("The --cache parameter expects a directory.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.CacheDirectory = args[++i];
+                }
+
+                else if (argument == "--cache-size")
+                {
+                    if (i + 1 >= args.Length || !long.TryParse(args[++i], NumberStyles.Integer, CultureInfo.InvariantCulture, out var cacheMaxSize) || cacheMaxSize < 1)
+                    {
+                        Logger.WriteMessage("The --cache-size parameter expects a positive size in MB.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.CacheMaxSize = cacheMaxSize * 1024 * 1024;
+                }
+
+                else if (argument == "--cache-hardlinks")
+                {
+                    options.UseCacheHardLinks = true;
+                }
+
+                else if (argument == "--no-cache")
+                {
+                    options.IsCacheEnabled = false;
+                }
+
+                else if (argument == "--bundle")
+                {
+                    if (i + 1 >= args.Length)
+                    {
+                        Logger.WriteMessage("The --bundle parameter expects a file path.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.BundlePath = Path.GetFullPath(args[++i]);
+                }
+
+                else if (argument == "--trace")
+                {
+                    if (i + 1 >= args.Length)
+                    {
+                        Logger.WriteMessage("The --trace parameter expects a file path.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.TracePath = Path.GetFullPath(args[++i]);
+                }
+
+                else if (argument == "--profile")
+                {
+                    if (i + 1 >= args.Length || !Enum.TryParse<BuildProfile>(args[++i], true, out var buildProfile) || !Enum.IsDefined(typeof(BuildProfile), buildProfile))
+                    {
+                        Logger.WriteMessage("The --profile parameter expects 'full' or 'iteration'.", LogMessageTypes.Error);
+                        return null;
+                    }
+
+                    options.BuildProfile = buildProfile;
+                }
+
+                else if (!argument.StartsWith("-"))
+                {
+                    options.SearchPattern = argument;
+                }
+            }
+
+            if (options.IsWatchMode)
+            {
+                options.SearchPattern = null;
+            }
+
+            return options;
+        }
+
         static async Task Main(string[] args)
         {
-            // TODO: Add verbose parameter
             // TODO: Add help parameter
             // TODO: Add version number
 
@@ -41,31 +166,42 @@ namespace CoreEngine.Compiler
             if (args.Length > 0)
             {
                 var input = args[0];
-                var isWatchMode = (args.Length > 1 && args[1] == "--watch");
-                var rebuildAll = (args.Length > 1 && args[1] == "--rebuild");
-                string? searchPattern = null;
-                
-                if (args.Length > 1 && !args[1].StartsWith("--"))
+                var options = ParseOptions(args);
+
+                if (options == null)
                 {
-                    searchPattern = args[1];
+                    return;
                 }
 
-                if (!isWatchMode)
+                if (!options.IsWatchMode)
                 {
-                    await RunCompilePass(resourceCompiler, input, searchPattern, isWatchMode, rebuildAll);
+                    await RunCompilePass(resourceCompiler, input, options);
                 }
 
                 else
                 {
                     Logger.WriteMessage("Entering watch mode...", LogMessageTypes.Action);
 
-                    while (true)
+                    using var cancellationTokenSource = new CancellationTokenSource();
+                    using var projectWatcher = new ProjectWatcher(resourceCompiler, input, options);
+
+                    Console.CancelKeyPress += (sender, e) =>
+                    {
+                        e.Cancel = true;
+                        cancellationTokenSource.Cancel();
+                    };
+
+                    try
+                    {
+                        await projectWatcher.RunAsync(cancellationTokenSource.Token);
+                    }
+
+                    catch (Exception e)
                     {
-                        await RunCompilePass(resourceCompiler, input, null, isWatchMode, rebuildAll);
-                        Thread.Sleep(1000);
+                        Logger.WriteMessage($"Error: {e.Message}", LogMessageTypes.Error);
                     }
                 }
             }
         }
     }
-}
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 using System;
+using CoreEngine.Tools.ResourceCompilers;
 
 namespace CoreEngine.Compiler
 {
@@ -7,8 +8,16 @@ namespace CoreEngine.Compiler
         public Project()
         {
             this.OutputDirectory = ".";
+            this.BuildProfile = BuildProfile.Full;
         }
         
         public string OutputDirectory { get; set; }
+        public BuildProfile BuildProfile { get; set; }
+
+        // Optional resource bundle path relative to the project file
+        public string? BundlePath { get; set; }
+
+        // Compiles the materials of .mtl and .fbx files to one material table per file
+        public bool MaterialTables { get; set; }
     }
 }
\ No newline at end of file
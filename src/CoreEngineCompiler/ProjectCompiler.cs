@@ -15,15 +15,55 @@ namespace CoreEngine.Compiler
 {
     public class ProjectCompiler
     {
+        private const int SlowestAssetCount = 10;
+
+        private class SourceFileCompilation
+        {
+            public SourceFileCompilation(string sourceFile, string destinationPath)
+            {
+                this.SourceFile = sourceFile;
+                this.DestinationPath = destinationPath;
+            }
+
+            public string SourceFile { get; }
+            public string DestinationPath { get; }
+            public Memory<string> Result { get; set; }
+        }
+
         private readonly ResourceCompiler resourceCompiler;
 
+        // State kept between compile passes so that watch mode doesn't need to reload the project
+        private ProjectCompilerOptions? options;
+        private string? inputDirectory;
+        private string? outputDirectory;
+        private string? fileTrackerPath;
+        private BuildProfile buildProfile;
+        private bool useMaterialTables;
+        private FileTracker? fileTracker;
+        private CompileCache? compileCache;
+        private ResourceBundle? resourceBundle;
+        private List<string>? sourceFiles;
+
         public ProjectCompiler(ResourceCompiler resourceCompiler)
         {
             this.resourceCompiler = resourceCompiler;
         }
 
-        public async Task CompileProject(string path, string? searchPattern, bool isWatchMode, bool rebuildAll)
+        public string? InputDirectory
         {
+            get
+            {
+                return this.inputDirectory;
+            }
+        }
+
+        public async Task CompileProject(string path, ProjectCompilerOptions options)
+        {
+            if (options == null)
+            {
+                throw new ArgumentNullException(nameof(options));
+            }
+
             var project = OpenProject(path);
 
             var inputDirectory = Path.GetDirectoryName(Path.GetFullPath(path));
@@ -47,43 +87,258 @@ namespace CoreEngine.Compiler
                 Directory.CreateDirectory(inputObjDirectory);
             }
 
-            var fileTrackerPath = Path.Combine(inputObjDirectory, "FileTracker");
-            var fileTracker = new FileTracker();
+            // Each compile pass starts a new trace, watch mode passes replace the trace of the previous pass
+            if (options.TracePath != null)
+            {
+                BuildTracer.Start();
+            }
 
-            if (!rebuildAll || isWatchMode)
+            using (BuildTracer.BeginSpan("CompileProject", "Project"))
             {
-                fileTracker.ReadFile(fileTrackerPath);
+                this.options = options;
+                this.inputDirectory = inputDirectory;
+                this.outputDirectory = outputDirectory;
+                this.fileTrackerPath = Path.Combine(inputObjDirectory, "FileTracker");
+                this.fileTracker = new FileTracker();
+                this.buildProfile = options.BuildProfile ?? project.BuildProfile;
+                this.useMaterialTables = project.MaterialTables;
+
+                // The output directory only holds the outputs of one profile so switching profiles compiles every file again,
+                // the cache keys include the profile so unchanged files are restored from the outputs of an earlier build
+                var buildProfilePath = Path.Combine(inputObjDirectory, "BuildProfile");
+                var hasBuildProfileChanged = ReadBuildProfile(buildProfilePath) != this.buildProfile;
+
+                // Material tables replace the material files of the sources so switching them has the same effect
+                var materialTablesPath = Path.Combine(inputObjDirectory, "MaterialTables");
+                var haveMaterialTablesChanged = File.Exists(materialTablesPath) != this.useMaterialTables;
+
+                if (hasBuildProfileChanged || haveMaterialTablesChanged)
+                {
+                    Logger.WriteMessage($"Build profile changed to {this.buildProfile} (Material Tables: {this.useMaterialTables}), compiling all files.", LogMessageTypes.Debug);
+
+                    // An interrupted build must not leave a file tracker that matches the outputs of the previous profile
+                    File.Delete(buildProfilePath);
+                    File.Delete(materialTablesPath);
+                    File.Delete(this.fileTrackerPath);
+                }
+
+                else if (!options.RebuildAll || options.IsWatchMode)
+                {
+                    this.fileTracker.ReadFile(this.fileTrackerPath);
+                }
+
+                this.compileCache = null;
+                this.resourceBundle = null;
+
+                var bundlePath = options.BundlePath ?? ((project.BundlePath != null) ? Path.GetFullPath(Path.Combine(inputDirectory, project.BundlePath)) : null);
+
+                if (bundlePath != null)
+                {
+                    this.resourceBundle = new ResourceBundle(bundlePath);
+                }
+
+                if (options.IsCacheEnabled)
+                {
+                    this.compileCache = new CompileCache(options.CacheDirectory ?? Path.Combine(inputObjDirectory, "Cache"), options.CacheMaxSize, options.UseCacheHardLinks);
+                    this.compileCache.IsRestoreEnabled = !options.RebuildAll;
+                }
+
+                if (!options.IsWatchMode)
+                {
+                    Logger.WriteMessage($"InputPath: {inputDirectory}", LogMessageTypes.Debug);
+                    Logger.WriteMessage($"OutputPath: {outputDirectory}", LogMessageTypes.Debug);
+                    Logger.WriteMessage($"BuildProfile: {this.buildProfile}", LogMessageTypes.Debug);
+                }
+
+                this.sourceFiles = SearchSupportedSourceFiles(inputDirectory, options.SearchPattern);
+                var remainingDestinationFiles = new List<string>(Directory.GetFiles(outputDirectory, "*", SearchOption.AllDirectories));
+
+                if (options.SearchPattern != null)
+                {
+                    remainingDestinationFiles.Clear();
+                }
+
+                var stopwatch = new Stopwatch();
+                stopwatch.Start();
+
+                var allocatedBytes = GC.GetTotalAllocatedBytes();
+                HashSet<string> outOfDateFiles;
+
+                using (BuildTracer.BeginSpan("ComputeOutOfDateFiles", "Project"))
+                {
+                    outOfDateFiles = ComputeOutOfDateFiles(this.fileTracker, this.sourceFiles);
+                }
+
+                var compiledFilesCount = await CompileSourceFiles(this.sourceFiles, outOfDateFiles, options.SearchPattern != null, remainingDestinationFiles);
+
+                stopwatch.Stop();
+
+                if (compiledFilesCount > 0)
+                {
+                    Logger.WriteLine();
+                    Logger.WriteMessage($"Success: Compiled {compiledFilesCount} file(s) in {stopwatch.Elapsed}.", LogMessageTypes.Success);
+                    Logger.WriteMessage($"Managed allocations: {(GC.GetTotalAllocatedBytes() - allocatedBytes) / (1024 * 1024)} MB.", LogMessageTypes.Debug);
+                }
+
+                if (this.compileCache != null)
+                {
+                    var lookupCount = this.compileCache.HitCount + this.compileCache.MissCount;
+
+                    if (lookupCount > 0)
+                    {
+                        var hitRate = (double)this.compileCache.HitCount / lookupCount;
+                        Logger.WriteMessage($"Compile cache: {this.compileCache.HitCount} hit(s), {this.compileCache.MissCount} miss(es) ({hitRate.ToString("P0", CultureInfo.InvariantCulture)}), {this.compileCache.RestoredBytes / 1024} KB restored, {this.compileCache.StoredBytes / 1024} KB stored.", LogMessageTypes.Debug);
+                    }
+
+                    this.compileCache.Trim();
+                }
+
+                // TODO: Remove deleted files from file tracker
+                CleanupOutputDirectory(outputDirectory, remainingDestinationFiles);
+                UpdateResourceBundle(outputDirectory);
+                this.fileTracker.WriteFile(this.fileTrackerPath);
+                File.WriteAllText(buildProfilePath, this.buildProfile.ToString());
+
+                if (this.useMaterialTables)
+                {
+                    File.WriteAllText(materialTablesPath, string.Empty);
+                }
             }
 
-            if (!isWatchMode)
+            WriteBuildTrace();
+        }
+
+        // Compiles the files affected by a set of changed paths using the state of the previous CompileProject call.
+        // Returns the number of compiled files.
+        public async Task<int> CompileChangedFiles(IEnumerable<string> changedPaths)
+        {
+            if (changedPaths == null)
             {
-                Logger.WriteMessage($"InputPath: {inputDirectory}", LogMessageTypes.Debug);
-                Logger.WriteMessage($"OutputPath: {outputDirectory}", LogMessageTypes.Debug);
+                throw new ArgumentNullException(nameof(changedPaths));
             }
 
-            var sourceFiles = SearchSupportedSourceFiles(inputDirectory, searchPattern);
-            var remainingDestinationFiles = new List<string>(Directory.GetFiles(outputDirectory, "*", SearchOption.AllDirectories));
-            var compiledFilesCount = 0;
+            if (this.options == null || this.inputDirectory == null || this.outputDirectory == null || this.fileTrackerPath == null || this.fileTracker == null || this.sourceFiles == null)
+            {
+                throw new InvalidOperationException("CompileProject must be called before CompileChangedFiles.");
+            }
 
-            if (searchPattern != null)
+            var supportedExtensions = new HashSet<string>(this.resourceCompiler.GetSupportedSourceFileExtensions());
+            var knownSourceFiles = new HashSet<string>(this.sourceFiles);
+            var changedSourceFiles = new HashSet<string>();
+
+            foreach (var changedPath in changedPaths)
             {
-                remainingDestinationFiles.Clear();
+                if (Directory.Exists(changedPath))
+                {
+                    // Directories created or moved into the project
+                    foreach (var sourceFile in SearchSupportedSourceFiles(changedPath, null))
+                    {
+                        changedSourceFiles.Add(sourceFile);
+                    }
+                }
+
+                else if (supportedExtensions.Contains(Path.GetExtension(changedPath)))
+                {
+                    changedSourceFiles.Add(changedPath);
+                }
+
+                else
+                {
+                    // Directories deleted or moved out of the project
+                    var directoryPrefix = changedPath + Path.DirectorySeparatorChar;
+
+                    foreach (var sourceFile in this.sourceFiles)
+                    {
+                        if (sourceFile.StartsWith(directoryPrefix, StringComparison.Ordinal))
+                        {
+                            changedSourceFiles.Add(sourceFile);
+                        }
+                    }
+                }
             }
 
-            var stopwatch = new Stopwatch();
-            stopwatch.Start();
+            var remainingDestinationFiles = new List<string>();
+            var hasSourceListChanged = false;
 
-            // TODO: Remove this hack
-            bool overrideMetalFiles = false;
+            foreach (var changedSourceFile in changedSourceFiles)
+            {
+                if (File.Exists(changedSourceFile))
+                {
+                    if (knownSourceFiles.Add(changedSourceFile))
+                    {
+                        hasSourceListChanged = true;
+                    }
+                }
 
-            if (sourceFiles.Where(item => (Path.GetExtension(item) == ".h" && fileTracker.HasFileChanged(item))).Any())
+                else if (knownSourceFiles.Remove(changedSourceFile))
+                {
+                    remainingDestinationFiles.AddRange(this.fileTracker.GetDestinationFiles(changedSourceFile));
+                    this.fileTracker.RemoveFile(changedSourceFile);
+                    hasSourceListChanged = true;
+                }
+            }
+
+            if (hasSourceListChanged)
+            {
+                this.sourceFiles = new List<string>(knownSourceFiles);
+                this.sourceFiles.Sort(StringComparer.Ordinal);
+            }
+
+            // Only the changed files and the files that include them need to be checked
+            var outOfDateFiles = ComputeOutOfDateFiles(this.fileTracker, this.sourceFiles, changedSourceFiles);
+            var affectedSourceFiles = new List<string>();
+
+            foreach (var sourceFile in this.sourceFiles)
+            {
+                if (outOfDateFiles.Contains(sourceFile))
+                {
+                    affectedSourceFiles.Add(sourceFile);
+                    remainingDestinationFiles.AddRange(this.fileTracker.GetDestinationFiles(sourceFile));
+                }
+            }
+
+            if (affectedSourceFiles.Count == 0 && remainingDestinationFiles.Count == 0)
+            {
+                return 0;
+            }
+
+            if (this.options.TracePath != null)
+            {
+                BuildTracer.Start();
+            }
+
+            var compiledFilesCount = await CompileSourceFiles(affectedSourceFiles, outOfDateFiles, false, remainingDestinationFiles);
+
+            CleanupOutputDirectory(this.outputDirectory, remainingDestinationFiles);
+            UpdateResourceBundle(this.outputDirectory);
+            this.fileTracker.WriteFile(this.fileTrackerPath);
+
+            WriteBuildTrace();
+            return compiledFilesCount;
+        }
+
+        private async Task<int> CompileSourceFiles(IList<string> sourceFiles, HashSet<string> outOfDateFiles, bool forceCompilation, List<string> remainingDestinationFiles)
+        {
+            if (this.options == null || this.inputDirectory == null || this.outputDirectory == null || this.fileTracker == null)
             {
-                overrideMetalFiles = true;
+                throw new InvalidOperationException("The project is not opened.");
             }
 
+            var inputDirectory = this.inputDirectory;
+            var outputDirectory = this.outputDirectory;
+            var fileTracker = this.fileTracker;
+            var compileCache = this.compileCache;
+
+            using var compileSpan = BuildTracer.BeginSpan("CompileSourceFiles", "Project");
+            var buildScheduler = new BuildScheduler(this.options.MaxDegreeOfParallelism, this.options.MemoryBudget);
+            var compiledSourceFiles = new List<SourceFileCompilation>();
+            var lastJobPerOutput = new Dictionary<string, int>();
+            var lastNonConcurrentJob = -1;
+            var compiledFilesCount = 0;
+
             foreach (var sourceFile in sourceFiles)
             {
-                var hasFileChanged = fileTracker.HasFileChanged(sourceFile) || searchPattern != null || (Path.GetExtension(sourceFile) == ".metal" && Path.GetFileName(sourceFile).StartsWith("Render") && overrideMetalFiles);
+                var hasFileChanged = outOfDateFiles.Contains(sourceFile) || forceCompilation;
                 var destinationFiles = fileTracker.GetDestinationFiles(sourceFile);
 
                 var sourceFileAbsoluteDirectory = ConstructSourceFileAbsoluteDirectory(inputDirectory, sourceFile);
@@ -108,23 +363,43 @@ namespace CoreEngine.Compiler
                         continue;
                     }
 
-                    if (isWatchMode)
+                    if (this.options.IsWatchMode)
                     {
                         Logger.WriteMessage($"{DateTime.Now.ToString(CultureInfo.InvariantCulture)} - Detected file change for '{sourceFile}'");
                     }
-                    
-                    var result = await CompileSourceFile(sourceFileAbsoluteDirectory, sourceFile, destinationPath, outputDirectory);
-                    var resultDestinationFiles = new string[result.Length];
 
-                    for (var i = 0; i < result.Span.Length; i++)
+                    // Sources that can write the same output file are chained so the last writer stays the same as a sequential build
+                    var dependencies = new List<int>();
+                    var outputKey = Path.Combine(destinationPath, Path.GetFileNameWithoutExtension(sourceFile));
+                    var isConcurrentJob = this.resourceCompiler.SupportsConcurrentCompilation(sourceFile);
+
+                    if (lastJobPerOutput.TryGetValue(outputKey, out var previousJob))
                     {
-                        var destinationFile = Path.Combine(destinationPath, result.Span[i]);
-                        resultDestinationFiles[i] = destinationFile;
-                        remainingDestinationFiles.Remove(destinationFile);
+                        dependencies.Add(previousJob);
                     }
 
-                    fileTracker.AddDestinationFiles(sourceFile, resultDestinationFiles);
-                    compiledFilesCount += result.Length;
+                    if (!isConcurrentJob && lastNonConcurrentJob != -1)
+                    {
+                        dependencies.Add(lastNonConcurrentJob);
+                    }
+
+                    var compiledSourceFile = new SourceFileCompilation(sourceFile, destinationPath);
+                    var sourceFileDependencies = GetTransitiveDependencies(fileTracker, sourceFile);
+                    var estimatedMemory = this.resourceCompiler.EstimateMemoryUsage(sourceFile, new FileInfo(sourceFile).Length);
+
+                    var jobIndex = buildScheduler.AddJob(async () =>
+                    {
+                        compiledSourceFile.Result = await CompileSourceFile(sourceFileAbsoluteDirectory, sourceFile, destinationPath, outputDirectory, sourceFileDependencies, compileCache);
+                    }, estimatedMemory, dependencies.ToArray());
+
+                    lastJobPerOutput[outputKey] = jobIndex;
+
+                    if (!isConcurrentJob)
+                    {
+                        lastNonConcurrentJob = jobIndex;
+                    }
+
+                    compiledSourceFiles.Add(compiledSourceFile);
                 }
 
                 else 
@@ -136,17 +411,156 @@ namespace CoreEngine.Compiler
                 }
             }
 
-            stopwatch.Stop();
+            await buildScheduler.RunAsync();
 
-            if (compiledFilesCount > 0)
+            // Results are applied in source order so the output and the file tracker don't depend on the completion order
+            foreach (var compiledSourceFile in compiledSourceFiles)
             {
-                Logger.WriteLine();
-                Logger.WriteMessage($"Success: Compiled {compiledFilesCount} file(s) in {stopwatch.Elapsed}.", LogMessageTypes.Success);
+                var result = compiledSourceFile.Result;
+                var resultDestinationFiles = new string[result.Length];
+
+                for (var i = 0; i < result.Span.Length; i++)
+                {
+                    var destinationFile = Path.Combine(compiledSourceFile.DestinationPath, result.Span[i]);
+                    resultDestinationFiles[i] = destinationFile;
+                    remainingDestinationFiles.Remove(destinationFile);
+                }
+
+                fileTracker.AddDestinationFiles(compiledSourceFile.SourceFile, resultDestinationFiles);
+                compiledFilesCount += result.Length;
+            }
+
+            return compiledFilesCount;
+        }
+
+        private HashSet<string> ComputeOutOfDateFiles(FileTracker fileTracker, IList<string> sourceFiles, ICollection<string>? candidateFiles = null)
+        {
+            var changedFiles = new Dictionary<string, bool>();
+
+            bool HasFileChanged(string path)
+            {
+                if (!changedFiles.TryGetValue(path, out var hasChanged))
+                {
+                    hasChanged = fileTracker.HasFileChanged(path);
+                    changedFiles.Add(path, hasChanged);
+                }
+
+                return hasChanged;
+            }
+
+            // Includes are only scanned again when the content of a file has changed
+            foreach (var sourceFile in candidateFiles ?? sourceFiles)
+            {
+                if (HasFileChanged(sourceFile) && File.Exists(sourceFile))
+                {
+                    var dependencies = this.resourceCompiler.ReadDependencies(sourceFile, File.ReadAllBytes(sourceFile));
+                    var resolvedDependencies = new List<string>();
+
+                    foreach (var dependency in dependencies)
+                    {
+                        var dependencyPath = ResolveDependencyPath(sourceFile, dependency, sourceFiles);
+
+                        if (dependencyPath != null)
+                        {
+                            resolvedDependencies.Add(dependencyPath);
+                        }
+
+                        else
+                        {
+                            Logger.WriteMessage($"Cannot resolve dependency '{dependency}' of '{sourceFile}'.", LogMessageTypes.Debug);
+                        }
+                    }
+
+                    fileTracker.SetDependencies(sourceFile, resolvedDependencies.ToArray());
+                }
             }
 
-            // TODO: Remove deleted files from file tracker
-            CleanupOutputDirectory(outputDirectory, remainingDestinationFiles);
-            fileTracker.WriteFile(fileTrackerPath);
+            // A file is out of date when it or one of its transitive dependencies has changed
+            var result = new HashSet<string>();
+            var visitedFiles = new HashSet<string>();
+
+            bool IsOutOfDate(string path)
+            {
+                if (!visitedFiles.Add(path))
+                {
+                    return result.Contains(path);
+                }
+
+                // Files outside of the candidates are known to be unchanged
+                var isOutOfDate = (candidateFiles == null || candidateFiles.Contains(path)) && HasFileChanged(path);
+
+                foreach (var dependency in fileTracker.GetDependencies(path))
+                {
+                    isOutOfDate |= IsOutOfDate(dependency);
+                }
+
+                if (isOutOfDate)
+                {
+                    result.Add(path);
+                }
+
+                return isOutOfDate;
+            }
+
+            foreach (var sourceFile in sourceFiles)
+            {
+                IsOutOfDate(sourceFile);
+            }
+
+            return result;
+        }
+
+        private static string[] GetTransitiveDependencies(FileTracker fileTracker, string sourceFile)
+        {
+            var result = new List<string>();
+            var visitedFiles = new HashSet<string>() { sourceFile };
+            var filesToVisit = new Stack<string>();
+
+            filesToVisit.Push(sourceFile);
+
+            while (filesToVisit.Count > 0)
+            {
+                foreach (var dependency in fileTracker.GetDependencies(filesToVisit.Pop()))
+                {
+                    if (visitedFiles.Add(dependency))
+                    {
+                        result.Add(dependency);
+                        filesToVisit.Push(dependency);
+                    }
+                }
+            }
+
+            // The order is part of the compile cache key
+            result.Sort(StringComparer.Ordinal);
+            return result.ToArray();
+        }
+
+        private static string? ResolveDependencyPath(string sourceFile, string dependency, IList<string> sourceFiles)
+        {
+            var sourceDirectory = Path.GetDirectoryName(sourceFile);
+
+            if (sourceDirectory != null)
+            {
+                var dependencyPath = Path.GetFullPath(Path.Combine(sourceDirectory, dependency));
+
+                if (File.Exists(dependencyPath))
+                {
+                    return dependencyPath;
+                }
+            }
+
+            // Fallback for files found through include directories (like Lib/*.hlsl)
+            var dependencySuffix = Path.DirectorySeparatorChar + dependency.Replace('/', Path.DirectorySeparatorChar).Replace('\\', Path.DirectorySeparatorChar);
+
+            foreach (var projectFile in sourceFiles)
+            {
+                if (projectFile.EndsWith(dependencySuffix, StringComparison.Ordinal))
+                {
+                    return projectFile;
+                }
+            }
+
+            return null;
         }
 
         private static Project OpenProject(string path)
@@ -171,7 +585,18 @@ namespace CoreEngine.Compiler
             return deserializer.Deserialize<Project>(input);
         }
 
-        private string[] SearchSupportedSourceFiles(string inputDirectory, string? searchPattern)
+        // Outputs of compilers older than the build profiles were all built with the full profile
+        private static BuildProfile ReadBuildProfile(string path)
+        {
+            if (!File.Exists(path) || !Enum.TryParse<BuildProfile>(File.ReadAllText(path).Trim(), out var result))
+            {
+                return BuildProfile.Full;
+            }
+
+            return result;
+        }
+
+        private List<string> SearchSupportedSourceFiles(string inputDirectory, string? searchPattern)
         {
             var sourceFileExtensions = this.resourceCompiler.GetSupportedSourceFileExtensions();
             var sourceFiles = new List<string>();
@@ -193,7 +618,9 @@ namespace CoreEngine.Compiler
                 sourceFiles.AddRange(sourceFilesForExtension);
             }
 
-            return sourceFiles.ToArray();
+            // Directory enumeration order depends on the file system so sort it to keep builds deterministic
+            sourceFiles.Sort(StringComparer.Ordinal);
+            return sourceFiles;
         }
 
         private static string ConstructSourceFileAbsoluteDirectory(string inputDirectory, string sourceFile)
@@ -215,7 +642,7 @@ namespace CoreEngine.Compiler
             return sourceFileAbsoluteDirectory;
         }
 
-        private async ValueTask<Memory<string>> CompileSourceFile(string sourceFileAbsoluteDirectory, string sourceFile, string outputDirectory, string rootOutputDirectory)
+        private async ValueTask<Memory<string>> CompileSourceFile(string sourceFileAbsoluteDirectory, string sourceFile, string outputDirectory, string rootOutputDirectory, IList<string> dependencies, CompileCache? compileCache)
         {
             Logger.BeginAction($"Compiling '{Path.Combine(sourceFileAbsoluteDirectory, Path.GetFileName(sourceFile))}'");
             
@@ -233,10 +660,14 @@ namespace CoreEngine.Compiler
             }
 
             var resourceCompilerContext = new CompilerContext(targetPlatform, Path.GetFileName(sourceFile), Path.GetDirectoryName(sourceFile), outputDirectory, rootOutputDirectory);
-            
+            resourceCompilerContext.Dependencies = dependencies;
+            resourceCompilerContext.BuildProfile = this.buildProfile;
+            resourceCompilerContext.UseMaterialTables = this.useMaterialTables;
+            resourceCompilerContext.Cache = compileCache;
+
             try
             {
-                var result = await this.resourceCompiler.CompileFileAsync(sourceFile, resourceCompilerContext);
+                var result = await this.resourceCompiler.CompileFileAsync(sourceFile, resourceCompilerContext, compileCache);
 
                 if (result.Length > 0)
                 {
@@ -258,6 +689,55 @@ namespace CoreEngine.Compiler
             }
         }
 
+        private void UpdateResourceBundle(string outputDirectory)
+        {
+            if (this.resourceBundle != null)
+            {
+                using var bundleSpan = BuildTracer.BeginSpan("UpdateResourceBundle", "Project");
+                this.resourceBundle.Update(outputDirectory);
+            }
+        }
+
+        // Prints the slowest assets and the time spent in each compiler then writes the trace of the compile pass
+        private void WriteBuildTrace()
+        {
+            if (this.options?.TracePath == null || !BuildTracer.IsEnabled)
+            {
+                return;
+            }
+
+            var traceEvents = BuildTracer.GetEvents();
+            var slowestFileEvents = traceEvents.Where(x => x.Category == "File").OrderByDescending(x => x.Duration).Take(SlowestAssetCount).ToList();
+
+            if (slowestFileEvents.Count > 0)
+            {
+                Logger.WriteLine();
+                Logger.WriteMessage("Slowest assets:", LogMessageTypes.Important);
+
+                foreach (var fileEvent in slowestFileEvents)
+                {
+                    var path = fileEvent.GetArgument("path") as string;
+                    var displayPath = (path != null && this.inputDirectory != null) ? Path.GetRelativePath(this.inputDirectory, path) : fileEvent.Name;
+                    var bytesIn = fileEvent.GetArgument("bytesIn") as long? ?? 0;
+                    var bytesOut = fileEvent.GetArgument("bytesOut") as long? ?? 0;
+                    var cacheHit = fileEvent.GetArgument("cacheHit") as bool? ?? false;
+
+                    Logger.WriteMessage($"{fileEvent.Duration.TotalMilliseconds.ToString("0.0", CultureInfo.InvariantCulture)} ms - {displayPath} ({bytesIn / 1024} KB in, {bytesOut / 1024} KB out{(cacheHit ? ", cache hit" : string.Empty)})");
+                }
+
+                Logger.WriteMessage("Time per compiler:", LogMessageTypes.Important);
+
+                foreach (var compilerEvents in traceEvents.Where(x => x.Category == "Compiler").GroupBy(x => x.Name).OrderByDescending(x => x.Sum(y => y.Duration.TotalMilliseconds)))
+                {
+                    var totalMilliseconds = compilerEvents.Sum(x => x.Duration.TotalMilliseconds);
+                    Logger.WriteMessage($"{compilerEvents.Key}: {totalMilliseconds.ToString("0.0", CultureInfo.InvariantCulture)} ms ({compilerEvents.Count()} file(s))");
+                }
+            }
+
+            BuildTracer.WriteTrace(this.options.TracePath);
+            Logger.WriteMessage($"Build trace written to '{this.options.TracePath}'.", LogMessageTypes.Debug);
+        }
+
         private static void CleanupOutputDirectory(string outputDirectory, List<string> remainingDestinationFiles)
         {
             foreach (var remainingDestinationFile in remainingDestinationFiles)
@@ -0,0 +1,39 @@
+using System;
+using CoreEngine.Tools.ResourceCompilers;
+
+namespace CoreEngine.Compiler
+{
+    public class ProjectCompilerOptions
+    {
+        public ProjectCompilerOptions()
+        {
+            this.MaxDegreeOfParallelism = Environment.ProcessorCount;
+
+            // The GC only reports the available memory once a collection has happened
+            var availableMemory = GC.GetGCMemoryInfo().TotalAvailableMemoryBytes;
+            this.MemoryBudget = (availableMemory > 0) ? availableMemory / 2 : 4L * 1024 * 1024 * 1024;
+
+            this.IsCacheEnabled = true;
+            this.CacheMaxSize = 2L * 1024 * 1024 * 1024;
+        }
+
+        public string? SearchPattern { get; set; }
+        public bool IsWatchMode { get; set; }
+        public bool RebuildAll { get; set; }
+        public int MaxDegreeOfParallelism { get; set; }
+        public long MemoryBudget { get; set; }
+        public bool IsCacheEnabled { get; set; }
+        public string? CacheDirectory { get; set; }
+        public long CacheMaxSize { get; set; }
+        public bool UseCacheHardLinks { get; set; }
+
+        // Overrides the build profile of the project
+        public BuildProfile? BuildProfile { get; set; }
+
+        // Overrides the resource bundle path of the project
+        public string? BundlePath { get; set; }
+
+        // Writes a Chrome trace of the compile passes to this path
+        public string? TracePath { get; set; }
+    }
+}
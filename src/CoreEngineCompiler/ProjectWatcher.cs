@@ -0,0 +1,212 @@
+using System;
+using System.Collections.Generic;
+using System.Diagnostics;
+using System.Globalization;
+using System.IO;
+using System.Threading;
+using System.Threading.Tasks;
+using CoreEngine.Tools.Common;
+using CoreEngine.Tools.ResourceCompilers;
+
+namespace CoreEngine.Compiler
+{
+    public class ProjectWatcher : IDisposable
+    {
+        // Editors usually save a file with several events (truncate, write, rename) so changes are
+        // coalesced until the file system has been quiet for a short time
+        private static readonly TimeSpan quietPeriod = TimeSpan.FromMilliseconds(100);
+        private static readonly TimeSpan maxDebounceDelay = TimeSpan.FromSeconds(1);
+
+        private readonly ProjectCompiler projectCompiler;
+        private readonly string projectPath;
+        private readonly ProjectCompilerOptions options;
+        private readonly object syncObject = new object();
+        private readonly SemaphoreSlim changeSignal = new SemaphoreSlim(0);
+        private FileSystemWatcher? fileSystemWatcher;
+        private HashSet<string> pendingChanges = new HashSet<string>();
+        private long firstChangeTimestamp;
+        private long lastChangeTimestamp;
+        private bool isFullRescanNeeded;
+
+        public ProjectWatcher(ResourceCompiler resourceCompiler, string projectPath, ProjectCompilerOptions options)
+        {
+            this.projectCompiler = new ProjectCompiler(resourceCompiler);
+            this.projectPath = projectPath;
+            this.options = options;
+        }
+
+        public async Task RunAsync(CancellationToken cancellationToken)
+        {
+            await this.projectCompiler.CompileProject(this.projectPath, this.options);
+
+            var inputDirectory = this.projectCompiler.InputDirectory;
+
+            if (inputDirectory == null)
+            {
+                return;
+            }
+
+            StartFileSystemWatcher(inputDirectory);
+
+            Logger.WriteMessage("Waiting for file changes...", LogMessageTypes.Debug);
+
+            while (!cancellationToken.IsCancellationRequested)
+            {
+                try
+                {
+                    await this.changeSignal.WaitAsync(cancellationToken);
+                    await WaitForQuietPeriod(cancellationToken);
+                }
+
+                catch (OperationCanceledException)
+                {
+                    break;
+                }
+
+                HashSet<string> changes;
+                long firstChangeTimestamp;
+                bool isFullRescanNeeded;
+
+                lock (this.syncObject)
+                {
+                    // Drain the signals of the events coalesced in this batch, an event racing with
+                    // the swap at worst produces an extra empty batch
+                    while (this.changeSignal.CurrentCount > 0)
+                    {
+                        this.changeSignal.Wait(0);
+                    }
+
+                    changes = this.pendingChanges;
+                    firstChangeTimestamp = this.firstChangeTimestamp;
+                    isFullRescanNeeded = this.isFullRescanNeeded;
+
+                    this.pendingChanges = new HashSet<string>();
+                    this.isFullRescanNeeded = false;
+                }
+
+                if (changes.Count == 0 && !isFullRescanNeeded)
+                {
+                    continue;
+                }
+
+                try
+                {
+                    var compiledFilesCount = 0;
+
+                    if (isFullRescanNeeded)
+                    {
+                        Logger.WriteMessage("File system events were lost, rescanning the project...", LogMessageTypes.Warning);
+                        await this.projectCompiler.CompileProject(this.projectPath, this.options);
+                    }
+
+                    else
+                    {
+                        compiledFilesCount = await this.projectCompiler.CompileChangedFiles(changes);
+                    }
+
+                    if (compiledFilesCount > 0)
+                    {
+                        var latency = TimeSpan.FromSeconds((double)(Stopwatch.GetTimestamp() - firstChangeTimestamp) / Stopwatch.Frequency);
+                        Logger.WriteMessage($"Success: Compiled {compiledFilesCount} file(s), edit-to-output latency: {latency.TotalMilliseconds.ToString("0", CultureInfo.InvariantCulture)} ms.", LogMessageTypes.Success);
+                    }
+                }
+
+                catch (Exception e)
+                {
+                    Logger.WriteMessage($"Error: {e.Message}", LogMessageTypes.Error);
+                }
+            }
+        }
+
+        public void Dispose()
+        {
+            if (this.fileSystemWatcher != null)
+            {
+                this.fileSystemWatcher.Dispose();
+                this.fileSystemWatcher = null;
+            }
+
+            this.changeSignal.Dispose();
+        }
+
+        private void StartFileSystemWatcher(string inputDirectory)
+        {
+            var objDirectory = Path.Combine(inputDirectory, ".coreengine") + Path.DirectorySeparatorChar;
+
+            this.fileSystemWatcher = new FileSystemWatcher(inputDirectory);
+            this.fileSystemWatcher.IncludeSubdirectories = true;
+            this.fileSystemWatcher.NotifyFilter = NotifyFilters.FileName | NotifyFilters.DirectoryName | NotifyFilters.LastWrite | NotifyFilters.Size;
+
+            // The default buffer overflows quickly when a lot of files are copied at once
+            this.fileSystemWatcher.InternalBufferSize = 64 * 1024;
+
+            void OnFileSystemEvent(string path)
+            {
+                if (!path.StartsWith(objDirectory, StringComparison.Ordinal))
+                {
+                    AddPendingChange(path, false);
+                }
+            }
+
+            this.fileSystemWatcher.Changed += (sender, e) => OnFileSystemEvent(e.FullPath);
+            this.fileSystemWatcher.Created += (sender, e) => OnFileSystemEvent(e.FullPath);
+            this.fileSystemWatcher.Deleted += (sender, e) => OnFileSystemEvent(e.FullPath);
+            this.fileSystemWatcher.Renamed += (sender, e) =>
+            {
+                OnFileSystemEvent(e.OldFullPath);
+                OnFileSystemEvent(e.FullPath);
+            };
+
+            this.fileSystemWatcher.Error += (sender, e) => AddPendingChange(null, true);
+            this.fileSystemWatcher.EnableRaisingEvents = true;
+        }
+
+        private void AddPendingChange(string? path, bool isFullRescanNeeded)
+        {
+            var timestamp = Stopwatch.GetTimestamp();
+
+            lock (this.syncObject)
+            {
+                if (this.pendingChanges.Count == 0 && !this.isFullRescanNeeded)
+                {
+                    this.firstChangeTimestamp = timestamp;
+                }
+
+                if (path != null)
+                {
+                    this.pendingChanges.Add(path);
+                }
+
+                this.isFullRescanNeeded |= isFullRescanNeeded;
+                this.lastChangeTimestamp = timestamp;
+            }
+
+            this.changeSignal.Release();
+        }
+
+        private async Task WaitForQuietPeriod(CancellationToken cancellationToken)
+        {
+            while (true)
+            {
+                TimeSpan elapsedSinceFirstChange;
+                TimeSpan elapsedSinceLastChange;
+
+                lock (this.syncObject)
+                {
+                    var timestamp = Stopwatch.GetTimestamp();
+
+                    elapsedSinceFirstChange = TimeSpan.FromSeconds((double)(timestamp - this.firstChangeTimestamp) / Stopwatch.Frequency);
+                    elapsedSinceLastChange = TimeSpan.FromSeconds((double)(timestamp - this.lastChangeTimestamp) / Stopwatch.Frequency);
+                }
+
+                // A continuous stream of events must not delay the compilation indefinitely
+                if (elapsedSinceLastChange >= quietPeriod || elapsedSinceFirstChange >= maxDebounceDelay)
+                {
+                    return;
+                }
+
+                await Task.Delay(quietPeriod - elapsedSinceLastChange, cancellationToken);
+            }
+        }
+    }
+}
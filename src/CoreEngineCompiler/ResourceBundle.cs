@@ -0,0 +1,441 @@
+using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Text;
+using CoreEngine.Tools.Common;
+
+namespace CoreEngine.Compiler
+{
+    // Packs the compiled resources of a project in a single file that the runtime can map in memory.
+    //
+    // The table of contents at the start of the file is made of a header, an open addressing hash table of entry indices
+    // (linear probing on the xxHash64 of the UTF-8 resource path, -1 for an empty bucket), the entries and the UTF-8 paths.
+    // Resource paths are relative to the output directory and start with '/' like the paths of a resource:/ reference.
+    // Each payload starts on a page and has a page aligned capacity, only the table of contents and the payloads that
+    // changed are written when the bundle is updated.
+    //
+    // Updates never overwrite a payload referenced by the table of contents on disk: changed payloads are written in
+    // the free space and the table of contents is written last, so an interrupted update leaves the previous bundle
+    // valid. The header stores the hash of the table of contents so a partially written table is detected and the
+    // bundle is written again.
+    public class ResourceBundle
+    {
+        private class BundleEntry
+        {
+            public BundleEntry(string path)
+            {
+                this.Path = path;
+                this.PathHash = XxHash64.Hash(Encoding.UTF8.GetBytes(path));
+            }
+
+            public string Path { get; }
+            public ulong PathHash { get; }
+            public long Offset { get; set; }
+            public long Size { get; set; }
+            public long Capacity { get; set; }
+            public ulong ContentHash { get; set; }
+            public long LastWriteTime { get; set; }
+        }
+
+        private const int FileVersion = 2;
+        private const int PageSize = 4096;
+        private const int HeaderSize = 40;
+        private const int EntrySize = 56;
+        private static readonly byte[] fileSignature = new byte[] { (byte)'B', (byte)'N', (byte)'D', (byte)'L' };
+
+        private readonly string path;
+        private readonly string temporaryPath;
+
+        public ResourceBundle(string path)
+        {
+            if (path == null)
+            {
+                throw new ArgumentNullException(nameof(path));
+            }
+
+            this.path = Path.GetFullPath(path);
+            this.temporaryPath = this.path + ".tmp";
+        }
+
+        // Synchronizes the bundle with the files of the output directory
+        public void Update(string outputDirectory)
+        {
+            if (outputDirectory == null)
+            {
+                throw new ArgumentNullException(nameof(outputDirectory));
+            }
+
+            var entries = ReadTableOfContents(out var tableSize);
+            var updatedEntries = new Dictionary<string, BundleEntry>();
+            var changedEntries = new List<BundleEntry>();
+            var payloads = new Dictionary<BundleEntry, byte[]>();
+
+            foreach (var file in Directory.GetFiles(outputDirectory, "*", SearchOption.AllDirectories))
+            {
+                // A bundle written in the output directory must not be packed into itself
+                if (Path.GetFileName(file)[0] == '.' || IsBundleFile(file))
+                {
+                    continue;
+                }
+
+                var resourcePath = "/" + Path.GetRelativePath(outputDirectory, file).Replace('\\', '/');
+                var fileInfo = new FileInfo(file);
+                var lastWriteTime = fileInfo.LastWriteTimeUtc.ToBinary();
+
+                if (!entries.TryGetValue(resourcePath, out var entry))
+                {
+                    entry = new BundleEntry(resourcePath);
+                }
+
+                else if (entry.Size == fileInfo.Length && entry.LastWriteTime == lastWriteTime)
+                {
+                    updatedEntries.Add(resourcePath, entry);
+                    continue;
+                }
+
+                var data = File.ReadAllBytes(file);
+                var contentHash = XxHash64.Hash(data);
+
+                // Outputs restored from the compile cache have a new write time but the same content
+                if (entry.Capacity == 0 || entry.ContentHash != contentHash || entry.Size != data.Length)
+                {
+                    changedEntries.Add(entry);
+                    payloads.Add(entry, data);
+                }
+
+                entry.ContentHash = contentHash;
+                entry.LastWriteTime = lastWriteTime;
+                updatedEntries.Add(resourcePath, entry);
+            }
+
+            var removedEntryCount = 0;
+
+            foreach (var entry in entries.Values)
+            {
+                if (!updatedEntries.ContainsKey(entry.Path))
+                {
+                    removedEntryCount++;
+                }
+            }
+
+            if (changedEntries.Count == 0 && removedEntryCount == 0 && tableSize > 0)
+            {
+                WriteTableOfContents(updatedEntries, tableSize);
+                return;
+            }
+
+            var sortedEntries = new List<BundleEntry>(updatedEntries.Values);
+            sortedEntries.Sort((a, b) => string.CompareOrdinal(a.Path, b.Path));
+
+            if (tableSize == 0 || ComputeTableOfContentsSize(sortedEntries) > tableSize || !UpdateInPlace(sortedEntries, entries.Values, changedEntries, payloads, tableSize))
+            {
+                WriteBundle(outputDirectory, sortedEntries, payloads);
+                Logger.WriteMessage($"Resource bundle: wrote {sortedEntries.Count} resource(s) to '{this.path}'.", LogMessageTypes.Debug);
+                return;
+            }
+
+            Logger.WriteMessage($"Resource bundle: updated {changedEntries.Count} resource(s), removed {removedEntryCount} resource(s).", LogMessageTypes.Debug);
+        }
+
+        // Writes the changed payloads in the space that is not used by the payloads of the current table of contents.
+        // Returns false when the bundle wastes too much space and should be written again.
+        private bool UpdateInPlace(List<BundleEntry> entries, IEnumerable<BundleEntry> currentEntries, List<BundleEntry> changedEntries, Dictionary<BundleEntry, byte[]> payloads, int tableSize)
+        {
+            var changedEntrySet = new HashSet<BundleEntry>(changedEntries);
+            var allocatedRanges = new List<(long Offset, long Capacity)>();
+            var usedSize = 0L;
+
+            // The payloads of the current table of contents, including the removed and changed ones, stay valid until
+            // the new table of contents is written
+            foreach (var entry in currentEntries)
+            {
+                allocatedRanges.Add((entry.Offset, entry.Capacity));
+            }
+
+            foreach (var entry in entries)
+            {
+                usedSize += changedEntrySet.Contains(entry) ? AlignToPage(payloads[entry].Length) : entry.Capacity;
+            }
+
+            allocatedRanges.Sort((a, b) => a.Offset.CompareTo(b.Offset));
+
+            var fileLength = new FileInfo(this.path).Length;
+
+            if (fileLength - tableSize > 2 * usedSize + PageSize)
+            {
+                return false;
+            }
+
+            using var stream = new FileStream(this.path, FileMode.Open, FileAccess.ReadWrite, FileShare.Read);
+
+            foreach (var entry in changedEntries)
+            {
+                var data = payloads[entry];
+
+                entry.Capacity = AlignToPage(data.Length);
+                entry.Offset = AllocateRange(allocatedRanges, tableSize, entry.Capacity);
+                entry.Size = data.Length;
+
+                stream.Position = entry.Offset;
+                stream.Write(data, 0, data.Length);
+            }
+
+            // The payloads must be on disk before the table of contents references them
+            stream.Flush(true);
+
+            stream.Position = 0;
+            stream.Write(BuildTableOfContents(entries, tableSize));
+            stream.Flush(true);
+
+            // The file is only truncated once nothing references the space at its end
+            var endOffset = (long)tableSize;
+
+            foreach (var entry in entries)
+            {
+                endOffset = Math.Max(endOffset, entry.Offset + entry.Capacity);
+            }
+
+            stream.SetLength(endOffset);
+
+            return true;
+        }
+
+        private void WriteBundle(string outputDirectory, List<BundleEntry> entries, Dictionary<BundleEntry, byte[]> payloads)
+        {
+            // The table of contents gets room to grow so adding resources doesn't write the whole bundle again
+            var tableSize = (int)AlignToPage(ComputeTableOfContentsSize(entries) * 2);
+            var offset = (long)tableSize;
+
+            foreach (var entry in entries)
+            {
+                var size = payloads.TryGetValue(entry, out var payload) ? payload.Length : new FileInfo(Path.Combine(outputDirectory, entry.Path.Substring(1))).Length;
+
+                entry.Offset = offset;
+                entry.Size = size;
+                entry.Capacity = AlignToPage(size);
+                offset += entry.Capacity;
+            }
+
+            using (var stream = new FileStream(this.temporaryPath, FileMode.Create, FileAccess.Write))
+            {
+                stream.Write(BuildTableOfContents(entries, tableSize));
+
+                foreach (var entry in entries)
+                {
+                    var data = payloads.TryGetValue(entry, out var payload) ? payload : File.ReadAllBytes(Path.Combine(outputDirectory, entry.Path.Substring(1)));
+
+                    stream.Position = entry.Offset;
+                    stream.Write(data, 0, data.Length);
+                }
+
+                stream.SetLength(offset);
+                stream.Flush(true);
+            }
+
+            File.Move(this.temporaryPath, this.path, true);
+        }
+
+        private void WriteTableOfContents(Dictionary<string, BundleEntry> entries, int tableSize)
+        {
+            var sortedEntries = new List<BundleEntry>(entries.Values);
+            sortedEntries.Sort((a, b) => string.CompareOrdinal(a.Path, b.Path));
+
+            using var stream = new FileStream(this.path, FileMode.Open, FileAccess.Write, FileShare.Read);
+            stream.Write(BuildTableOfContents(sortedEntries, tableSize));
+            stream.Flush(true);
+        }
+
+        private bool IsBundleFile(string file)
+        {
+            var fullPath = Path.GetFullPath(file);
+            return string.Equals(fullPath, this.path, StringComparison.OrdinalIgnoreCase) || string.Equals(fullPath, this.temporaryPath, StringComparison.OrdinalIgnoreCase);
+        }
+
+        private Dictionary<string, BundleEntry> ReadTableOfContents(out int tableSize)
+        {
+            var result = new Dictionary<string, BundleEntry>();
+            tableSize = 0;
+
+            if (!File.Exists(this.path))
+            {
+                return result;
+            }
+
+            using var stream = new FileStream(this.path, FileMode.Open, FileAccess.Read, FileShare.ReadWrite);
+            using var reader = new BinaryReader(stream);
+
+            // Bundles written by an older version are written again
+            if (stream.Length < HeaderSize || !reader.ReadBytes(fileSignature.Length).AsSpan().SequenceEqual(fileSignature) || reader.ReadInt32() != FileVersion || reader.ReadInt32() != PageSize)
+            {
+                return result;
+            }
+
+            var storedTableSize = reader.ReadInt32();
+            var bucketCount = reader.ReadInt32();
+            var entryCount = reader.ReadInt32();
+            var stringTableOffset = reader.ReadInt32();
+            var stringTableSize = reader.ReadInt32();
+            var tableHash = reader.ReadUInt64();
+
+            // A table of contents interrupted while it was written doesn't match its hash
+            if (stringTableOffset < HeaderSize || stringTableSize < 0 || (long)stringTableOffset + stringTableSize > Math.Min(storedTableSize, stream.Length))
+            {
+                return result;
+            }
+
+            if (XxHash64.Hash(reader.ReadBytes(stringTableOffset + stringTableSize - HeaderSize)) != tableHash)
+            {
+                return result;
+            }
+
+            stream.Position = HeaderSize + bucketCount * sizeof(int);
+
+            var entries = new (ulong PathHash, long Offset, long Size, long Capacity, ulong ContentHash, long LastWriteTime, int PathOffset, int PathLength)[entryCount];
+
+            for (var i = 0; i < entryCount; i++)
+            {
+                entries[i] = (reader.ReadUInt64(), reader.ReadInt64(), reader.ReadInt64(), reader.ReadInt64(), reader.ReadUInt64(), reader.ReadInt64(), reader.ReadInt32(), reader.ReadInt32());
+            }
+
+            stream.Position = stringTableOffset;
+            var stringTable = reader.ReadBytes(stringTableSize);
+
+            foreach (var item in entries)
+            {
+                var entry = new BundleEntry(Encoding.UTF8.GetString(stringTable, item.PathOffset, item.PathLength));
+
+                entry.Offset = item.Offset;
+                entry.Size = item.Size;
+                entry.Capacity = item.Capacity;
+                entry.ContentHash = item.ContentHash;
+                entry.LastWriteTime = item.LastWriteTime;
+
+                result.Add(entry.Path, entry);
+            }
+
+            tableSize = storedTableSize;
+            return result;
+        }
+
+        private static byte[] BuildTableOfContents(List<BundleEntry> entries, int tableSize)
+        {
+            var bucketCount = ComputeBucketCount(entries.Count);
+            var buckets = new int[bucketCount];
+            Array.Fill(buckets, -1);
+
+            for (var i = 0; i < entries.Count; i++)
+            {
+                var bucket = (int)(entries[i].PathHash & (ulong)(bucketCount - 1));
+
+                while (buckets[bucket] != -1)
+                {
+                    bucket = (bucket + 1) & (bucketCount - 1);
+                }
+
+                buckets[bucket] = i;
+            }
+
+            var result = new byte[tableSize];
+            using var writer = new BinaryWriter(new MemoryStream(result));
+
+            var stringTableOffset = HeaderSize + bucketCount * sizeof(int) + entries.Count * EntrySize;
+            var stringTableSize = 0;
+
+            foreach (var entry in entries)
+            {
+                stringTableSize += Encoding.UTF8.GetByteCount(entry.Path);
+            }
+
+            writer.Write(fileSignature);
+            writer.Write(FileVersion);
+            writer.Write(PageSize);
+            writer.Write(tableSize);
+            writer.Write(bucketCount);
+            writer.Write(entries.Count);
+            writer.Write(stringTableOffset);
+            writer.Write(stringTableSize);
+
+            // The hash of the table is written once the rest of the table is known
+            writer.Write(0UL);
+
+            foreach (var bucket in buckets)
+            {
+                writer.Write(bucket);
+            }
+
+            var pathOffset = 0;
+
+            foreach (var entry in entries)
+            {
+                var pathLength = Encoding.UTF8.GetByteCount(entry.Path);
+
+                writer.Write(entry.PathHash);
+                writer.Write(entry.Offset);
+                writer.Write(entry.Size);
+                writer.Write(entry.Capacity);
+                writer.Write(entry.ContentHash);
+                writer.Write(entry.LastWriteTime);
+                writer.Write(pathOffset);
+                writer.Write(pathLength);
+
+                pathOffset += pathLength;
+            }
+
+            foreach (var entry in entries)
+            {
+                writer.Write(Encoding.UTF8.GetBytes(entry.Path));
+            }
+
+            writer.Seek(HeaderSize - sizeof(ulong), SeekOrigin.Begin);
+            writer.Write(XxHash64.Hash(result.AsSpan(HeaderSize, stringTableOffset + stringTableSize - HeaderSize)));
+
+            return result;
+        }
+
+        private static int ComputeTableOfContentsSize(List<BundleEntry> entries)
+        {
+            var result = HeaderSize + ComputeBucketCount(entries.Count) * sizeof(int) + entries.Count * EntrySize;
+
+            foreach (var entry in entries)
+            {
+                result += Encoding.UTF8.GetByteCount(entry.Path);
+            }
+
+            return result;
+        }
+
+        // At most half of the buckets are used so probe sequences stay short
+        private static int ComputeBucketCount(int entryCount)
+        {
+            var result = 2;
+
+            while (result < entryCount * 2)
+            {
+                result *= 2;
+            }
+
+            return result;
+        }
+
+        // First fit in the gaps between the allocated payloads, the file grows when no gap is large enough
+        private static long AllocateRange(List<(long Offset, long Capacity)> allocatedRanges, long startOffset, long capacity)
+        {
+            var offset = startOffset;
+            var index = 0;
+
+            while (index < allocatedRanges.Count && allocatedRanges[index].Offset - offset < capacity)
+            {
+                offset = Math.Max(offset, allocatedRanges[index].Offset + allocatedRanges[index].Capacity);
+                index++;
+            }
+
+            allocatedRanges.Insert(index, (offset, capacity));
+            return offset;
+        }
+
+        private static long AlignToPage(long size)
+        {
+            return Math.Max(PageSize, (size + PageSize - 1) / PageSize * PageSize);
+        }
+    }
+}